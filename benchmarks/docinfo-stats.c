@@ -0,0 +1,224 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * docinfo-stats.c
+ * This file is part of gedit
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Compares the counting of the document statistics with pango, as the
+ * docinfo plugin used to do, with gedit_docinfo_stats_count_text(), on
+ * ASCII text, on latin UTF-8 text and on text needing pango, and checks
+ * that both give the same counts.
+ *
+ * Usage: docinfo-stats [size of each text in MiB]
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pango/pango-break.h>
+
+#include "gedit-docinfo-stats.h"
+
+#define DEFAULT_SIZE_MIB	16
+
+/* The text is counted in pieces ending at a newline, about the size of the
+ * blocks of lines of the plugin.
+ */
+#define PIECE_SIZE		16384
+
+typedef void (* CountFunc) (const gchar        *text,
+			    gssize              length,
+			    GeditDocinfoCounts *counts);
+
+static const gchar *ascii_lines[] = {
+	"static void\n",
+	"count_block (GeditDocinfoStats *stats, Block *block)\n",
+	"{\n",
+	"\tif (block->valid && block->lines > 0) /* 42 */\n",
+	"\t\treturn g_strdup_printf (\"%d words, %d chars\", words, chars);\n",
+	"}\n",
+	"\n",
+};
+
+static const gchar *latin_lines[] = {
+	"Le cœur de l'été, à l'ombre des châteaux, où naïve Zoë rêvait.\n",
+	"Ça coûte 12,50 € ; «\xc2\xa0déjà vu\xc2\xa0» disait-il.\n",
+	"Über größere Straßen fährt man schneller, sagt Jürgen.\n",
+	"plain ascii line with numbers 3.14 and words_with_underscores\n",
+};
+
+static const gchar *complex_lines[] = {
+	"ภาษาไทยไม่มีการเว้นวรรคระหว่างคำ\n",
+	"हिन्दी भाषा देवनागरी लिपि में लिखी जाती है।\n",
+	"mixed ascii and ไทย text\n",
+};
+
+static void
+count_text_pango (const gchar        *text,
+		  gssize              length,
+		  GeditDocinfoCounts *counts)
+{
+	PangoLogAttr *attrs;
+	glong n_chars;
+
+	n_chars = g_utf8_strlen (text, length);
+
+	counts->chars += n_chars;
+	counts->bytes += length;
+
+	if (n_chars == 0)
+		return;
+
+	attrs = g_new0 (PangoLogAttr, n_chars + 1);
+
+	pango_get_log_attrs (text,
+			     length,
+			     0,
+			     pango_language_from_string ("C"),
+			     attrs,
+			     n_chars + 1);
+
+	for (glong i = 0; i < n_chars; i++)
+	{
+		if (attrs[i].is_white)
+			++counts->white_chars;
+
+		if (attrs[i].is_word_start)
+			++counts->words;
+	}
+
+	g_free (attrs);
+}
+
+static gchar *
+make_text (const gchar **lines,
+	   guint         n_lines,
+	   gsize         size)
+{
+	GString *text;
+	guint i = 0;
+
+	text = g_string_sized_new (size + 128);
+
+	while (text->len < size)
+	{
+		g_string_append (text, lines[i++ % n_lines]);
+	}
+
+	return g_string_free (text, FALSE);
+}
+
+static gdouble
+count_pieces (CountFunc           count,
+	      const gchar        *text,
+	      gsize               length,
+	      GeditDocinfoCounts *counts)
+{
+	GTimer *timer;
+	const gchar *start = text;
+	const gchar *text_end = text + length;
+	gdouble elapsed;
+
+	timer = g_timer_new ();
+
+	while (start < text_end)
+	{
+		const gchar *end;
+
+		end = start + MIN ((gsize)(text_end - start) - 1, PIECE_SIZE);
+		end = memchr (end, '\n', text_end - end);
+		end = end != NULL ? end + 1 : text_end;
+
+		count (start, end - start, counts);
+
+		start = end;
+	}
+
+	elapsed = g_timer_elapsed (timer, NULL);
+	g_timer_destroy (timer);
+
+	return elapsed;
+}
+
+static gboolean
+compare (const gchar  *name,
+	 const gchar **lines,
+	 guint         n_lines,
+	 gsize         size)
+{
+	GeditDocinfoCounts slow = { 0, };
+	GeditDocinfoCounts fast = { 0, };
+	gdouble slow_time;
+	gdouble fast_time;
+	gsize length;
+	gchar *text;
+
+	text = make_text (lines, n_lines, size);
+	length = strlen (text);
+
+	slow_time = count_pieces (count_text_pango, text, length, &slow);
+	fast_time = count_pieces (gedit_docinfo_stats_count_text, text, length, &fast);
+
+	g_free (text);
+
+	g_print ("%-8s pango %8.3f s %8.1f MiB/s   docinfo %8.3f s %8.1f MiB/s   x%.1f\n",
+		 name,
+		 slow_time,
+		 length / (1024.0 * 1024.0) / slow_time,
+		 fast_time,
+		 length / (1024.0 * 1024.0) / fast_time,
+		 slow_time / fast_time);
+
+	if (memcmp (&slow, &fast, sizeof (GeditDocinfoCounts)) != 0)
+	{
+		g_printerr ("%s: the counts differ: "
+			    "%" G_GINT64_FORMAT " chars, %" G_GINT64_FORMAT " words, "
+			    "%" G_GINT64_FORMAT " white chars with pango, "
+			    "%" G_GINT64_FORMAT " chars, %" G_GINT64_FORMAT " words, "
+			    "%" G_GINT64_FORMAT " white chars with docinfo\n",
+			    name,
+			    slow.chars, slow.words, slow.white_chars,
+			    fast.chars, fast.words, fast.white_chars);
+
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+	gsize size = DEFAULT_SIZE_MIB;
+	gboolean ok = TRUE;
+
+	if (argc > 1)
+	{
+		size = strtoul (argv[1], NULL, 10);
+	}
+
+	size *= 1024 * 1024;
+
+	ok &= compare ("ascii", ascii_lines, G_N_ELEMENTS (ascii_lines), size);
+	ok &= compare ("latin", latin_lines, G_N_ELEMENTS (latin_lines), size);
+	ok &= compare ("complex", complex_lines, G_N_ELEMENTS (complex_lines), size);
+
+	return ok ? 0 : 1;
+}
+
+/* ex:set ts=8 noet: */
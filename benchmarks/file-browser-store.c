@@ -0,0 +1,257 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * file-browser-store.c
+ * This file is part of gedit
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Measures the file browser store on a synthetic directory: loading it, then
+ * converting each row between path and iter, and refiltering it.
+ *
+ * Usage: file-browser-store [number of entries]
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+#include "gedit-file-browser-store.h"
+#include "gedit-file-browser-enum-types.h"
+
+#define DEFAULT_N_ENTRIES	100000
+
+/* The store types are registered by the plugin module, a module which never
+ * unloads stands in for it.
+ */
+typedef GTypeModule BenchmarkModule;
+typedef GTypeModuleClass BenchmarkModuleClass;
+
+G_DEFINE_TYPE (BenchmarkModule, benchmark_module, G_TYPE_TYPE_MODULE)
+
+static gboolean
+benchmark_module_load (GTypeModule *module)
+{
+	return TRUE;
+}
+
+static void
+benchmark_module_unload (GTypeModule *module)
+{
+}
+
+static void
+benchmark_module_class_init (BenchmarkModuleClass *klass)
+{
+	klass->load = benchmark_module_load;
+	klass->unload = benchmark_module_unload;
+}
+
+static void
+benchmark_module_init (BenchmarkModule *module)
+{
+}
+
+static void
+report (const gchar *name,
+	guint        n_ops,
+	gdouble      elapsed)
+{
+	g_print ("%-20s %8u ops %10.3f ms %12.0f ops/s\n",
+		 name,
+		 n_ops,
+		 elapsed * 1000,
+		 elapsed > 0 ? n_ops / elapsed : 0);
+}
+
+static void
+create_entries (const gchar *dir,
+		guint        n_entries)
+{
+	guint i;
+
+	for (i = 0; i < n_entries; i++)
+	{
+		gchar *filename;
+		gchar *path;
+		gint fd;
+
+		/* Not in the order of the names, so that the store sorts. */
+		filename = g_strdup_printf ("file-%06u.c", (i * 7919) % n_entries);
+		path = g_build_filename (dir, filename, NULL);
+
+		fd = g_creat (path, 0644);
+		g_assert (fd != -1);
+		close (fd);
+
+		g_free (path);
+		g_free (filename);
+	}
+}
+
+static void
+remove_entries (const gchar *dir)
+{
+	GDir *d;
+	const gchar *name;
+
+	d = g_dir_open (dir, 0, NULL);
+
+	while (d != NULL && (name = g_dir_read_name (d)) != NULL)
+	{
+		gchar *path;
+
+		path = g_build_filename (dir, name, NULL);
+		g_unlink (path);
+		g_free (path);
+	}
+
+	if (d != NULL)
+	{
+		g_dir_close (d);
+	}
+
+	g_rmdir (dir);
+}
+
+static void
+on_end_loading (GeditFileBrowserStore *store,
+		GtkTreeIter           *iter,
+		GMainLoop             *loop)
+{
+	g_main_loop_quit (loop);
+}
+
+static void
+convert_rows (GtkTreeModel *model,
+	      guint         n_rows)
+{
+	GTimer *timer;
+	GtkTreeIter *iters;
+	guint i;
+
+	iters = g_new (GtkTreeIter, n_rows);
+	timer = g_timer_new ();
+
+	for (i = 0; i < n_rows; i++)
+	{
+		GtkTreePath *path;
+
+		path = gtk_tree_path_new_from_indices (i, -1);
+
+		if (!gtk_tree_model_get_iter (model, &iters[i], path))
+		{
+			g_error ("No row at %u", i);
+		}
+
+		gtk_tree_path_free (path);
+	}
+
+	report ("get iter", n_rows, g_timer_elapsed (timer, NULL));
+	g_timer_start (timer);
+
+	for (i = 0; i < n_rows; i++)
+	{
+		GtkTreePath *path;
+
+		path = gtk_tree_model_get_path (model, &iters[i]);
+
+		if (gtk_tree_path_get_indices (path)[0] != (gint)i)
+		{
+			g_error ("Wrong path for the row %u", i);
+		}
+
+		gtk_tree_path_free (path);
+	}
+
+	report ("get path", n_rows, g_timer_elapsed (timer, NULL));
+
+	g_timer_destroy (timer);
+	g_free (iters);
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+	guint n_entries = DEFAULT_N_ENTRIES;
+	GTypeModule *module;
+	GeditFileBrowserStore *store;
+	GMainLoop *loop;
+	GFile *root;
+	gchar *dir;
+	GTimer *timer;
+	guint n_rows;
+
+	/* The icons of the rows come from the icon theme. */
+	if (!gtk_init_check (&argc, &argv))
+	{
+		g_printerr ("Could not open a display, skipping the benchmark\n");
+		return 77;
+	}
+
+	if (argc > 1)
+	{
+		n_entries = strtoul (argv[1], NULL, 10);
+	}
+
+	module = g_object_new (benchmark_module_get_type (), NULL);
+	g_type_module_use (module);
+
+	gedit_file_browser_enum_and_flag_register_type (module);
+	_gedit_file_browser_store_register_type (module);
+
+	dir = g_dir_make_tmp ("gedit-file-browser-XXXXXX", NULL);
+	g_assert (dir != NULL);
+
+	create_entries (dir, n_entries);
+	g_print ("%u entries\n", n_entries);
+
+	root = g_file_new_for_path (dir);
+	loop = g_main_loop_new (NULL, FALSE);
+
+	store = gedit_file_browser_store_new (NULL);
+	g_signal_connect (store, "end-loading", G_CALLBACK (on_end_loading), loop);
+
+	timer = g_timer_new ();
+	gedit_file_browser_store_set_root (store, root);
+	g_main_loop_run (loop);
+
+	n_rows = gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL);
+	report ("load", n_rows, g_timer_elapsed (timer, NULL));
+
+	convert_rows (GTK_TREE_MODEL (store), n_rows);
+
+	g_timer_start (timer);
+	gedit_file_browser_store_refilter (store);
+	report ("refilter", n_rows, g_timer_elapsed (timer, NULL));
+
+	/* The positions are computed again after the refilter. */
+	convert_rows (GTK_TREE_MODEL (store), n_rows);
+
+	g_timer_destroy (timer);
+	g_object_unref (store);
+	g_main_loop_unref (loop);
+	g_object_unref (root);
+
+	remove_entries (dir);
+	g_free (dir);
+
+	return 0;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,174 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * metadata-manager.c
+ * This file is part of gedit
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Measures the throughput of the metadata manager: setting and getting the
+ * metadata of many files, evicting the least recently used ones when saving,
+ * and loading the metadata file back.
+ *
+ * Usage: metadata-manager [number of files] [maximum number of items]
+ */
+
+#include <stdlib.h>
+#include <glib/gstdio.h>
+#include <gedit/gedit-metadata-manager.h>
+#include <gedit/gedit-settings.h>
+
+#define DEFAULT_N_FILES		10000
+#define DEFAULT_MAX_ITEMS	1000
+
+static void
+report (const gchar *name,
+	guint        n_ops,
+	gdouble      elapsed)
+{
+	g_print ("%-20s %8u ops %10.3f ms %12.0f ops/s\n",
+		 name,
+		 n_ops,
+		 elapsed * 1000,
+		 elapsed > 0 ? n_ops / elapsed : 0);
+}
+
+static void
+set_all (GFile **locations,
+	 guint   n_files)
+{
+	GTimer *timer;
+	guint i;
+
+	timer = g_timer_new ();
+
+	for (i = 0; i < n_files; i++)
+	{
+		gedit_metadata_manager_set (locations[i], "position", "42");
+	}
+
+	report ("set", n_files, g_timer_elapsed (timer, NULL));
+	g_timer_destroy (timer);
+}
+
+static void
+get_all (GFile **locations,
+	 guint   n_files)
+{
+	GTimer *timer;
+	guint i;
+
+	timer = g_timer_new ();
+
+	for (i = 0; i < n_files; i++)
+	{
+		g_free (gedit_metadata_manager_get (locations[i], "position"));
+	}
+
+	report ("get", n_files, g_timer_elapsed (timer, NULL));
+	g_timer_destroy (timer);
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+	guint n_files = DEFAULT_N_FILES;
+	guint max_items = DEFAULT_MAX_ITEMS;
+	GSettings *settings;
+	GFile **locations;
+	gchar *dir;
+	gchar *filename;
+	GTimer *timer;
+	guint i;
+
+	if (argc > 1)
+	{
+		n_files = strtoul (argv[1], NULL, 10);
+	}
+
+	if (argc > 2)
+	{
+		max_items = strtoul (argv[2], NULL, 10);
+	}
+
+	/* Do not touch the settings of the user. */
+	g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+
+	settings = g_settings_new ("org.gnome.gedit.preferences.editor");
+	g_settings_set_uint (settings, GEDIT_SETTINGS_MAX_METADATA_ITEMS, max_items);
+
+	dir = g_dir_make_tmp ("gedit-metadata-XXXXXX", NULL);
+	g_assert (dir != NULL);
+
+	filename = g_build_filename (dir, "gedit-metadata", NULL);
+
+	locations = g_new (GFile *, n_files);
+
+	for (i = 0; i < n_files; i++)
+	{
+		gchar *path;
+
+		path = g_strdup_printf ("/benchmark/dir-%u/file-%u.c", i % 100, i);
+		locations[i] = g_file_new_for_path (path);
+		g_free (path);
+	}
+
+	g_print ("%u files, at most %u items\n", n_files, max_items);
+
+	gedit_metadata_manager_init (filename);
+
+	set_all (locations, n_files);
+	get_all (locations, n_files);
+
+	/* Saving evicts the items in excess. */
+	timer = g_timer_new ();
+	gedit_metadata_manager_shutdown ();
+	report ("evict and save", n_files - MIN (n_files, max_items), g_timer_elapsed (timer, NULL));
+
+	gedit_metadata_manager_init (filename);
+
+	/* The first access loads the file. */
+	g_timer_start (timer);
+	g_free (gedit_metadata_manager_get (locations[n_files - 1], "position"));
+	report ("load", MIN (n_files, max_items), g_timer_elapsed (timer, NULL));
+
+	get_all (locations, n_files);
+
+	g_timer_start (timer);
+	gedit_metadata_manager_shutdown ();
+	report ("save", 1, g_timer_elapsed (timer, NULL));
+
+	g_timer_destroy (timer);
+
+	for (i = 0; i < n_files; i++)
+	{
+		g_object_unref (locations[i]);
+	}
+
+	g_free (locations);
+
+	g_unlink (filename);
+	g_rmdir (dir);
+	g_free (filename);
+	g_free (dir);
+
+	g_object_unref (settings);
+
+	return 0;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,288 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*- */
+/*
+ * open-files.c
+ * This file is part of gedit
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Measures opening many files in a window: into a window with a single tab,
+ * into a window which already has as many tabs, and opening again files
+ * which are all already open.
+ *
+ * Usage: open-files [number of files]
+ */
+
+#include <stdlib.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+#include <gedit/gedit-app.h>
+#include <gedit/gedit-app-x11.h>
+#include <gedit/gedit-commands.h>
+#include <gedit/gedit-dirs.h>
+#include <gedit/gedit-settings.h>
+#include <gedit/gedit-tab.h>
+#include <gedit/gedit-window.h>
+
+#define DEFAULT_N_FILES		1000
+
+typedef struct
+{
+	guint   n_files;
+	gchar  *dir;
+
+	/* The files opened first, then the ones opened with them open */
+	GSList *first;
+	GSList *second;
+
+	/* Number of tabs still loading */
+	guint   n_loading;
+} Benchmark;
+
+static void
+report (const gchar *name,
+	guint        n_ops,
+	gdouble      elapsed)
+{
+	g_print ("%-24s %8u files %10.3f ms %10.0f files/s\n",
+		 name,
+		 n_ops,
+		 elapsed * 1000,
+		 elapsed > 0 ? n_ops / elapsed : 0);
+}
+
+static GSList *
+create_files (const gchar *dir,
+	      const gchar *prefix,
+	      guint        n_files)
+{
+	GSList *files = NULL;
+	guint i;
+
+	for (i = 0; i < n_files; i++)
+	{
+		gchar *filename;
+		gchar *path;
+		gchar *contents;
+
+		filename = g_strdup_printf ("%s-%04u.c", prefix, i);
+		path = g_build_filename (dir, filename, NULL);
+		contents = g_strdup_printf ("int %s_%u = %u;\n", prefix, i, i);
+
+		if (!g_file_set_contents (path, contents, -1, NULL))
+		{
+			g_error ("Could not write %s", path);
+		}
+
+		files = g_slist_prepend (files, g_file_new_for_path (path));
+
+		g_free (contents);
+		g_free (path);
+		g_free (filename);
+	}
+
+	return g_slist_reverse (files);
+}
+
+/* Removes the files and the data written by gedit. */
+static void
+remove_tree (const gchar *path)
+{
+	GDir *dir;
+	const gchar *name;
+
+	dir = g_dir_open (path, 0, NULL);
+
+	while (dir != NULL && (name = g_dir_read_name (dir)) != NULL)
+	{
+		gchar *child;
+
+		child = g_build_filename (path, name, NULL);
+		remove_tree (child);
+		g_free (child);
+	}
+
+	if (dir != NULL)
+	{
+		g_dir_close (dir);
+		g_rmdir (path);
+	}
+	else
+	{
+		g_unlink (path);
+	}
+}
+
+static void
+tab_state_notify_cb (GeditTab   *tab,
+		     GParamSpec *pspec,
+		     Benchmark  *benchmark)
+{
+	/* Loading ends with a normal tab or with an error. */
+	if (gedit_tab_get_state (tab) != GEDIT_TAB_STATE_LOADING &&
+	    benchmark->n_loading > 0)
+	{
+		benchmark->n_loading--;
+	}
+}
+
+static void
+tab_added_cb (GeditWindow *window,
+	      GeditTab    *tab,
+	      Benchmark   *benchmark)
+{
+	g_signal_connect (tab,
+			  "notify::state",
+			  G_CALLBACK (tab_state_notify_cb),
+			  benchmark);
+}
+
+static void
+open_files (Benchmark   *benchmark,
+	    GeditWindow *window,
+	    const gchar *name,
+	    GSList      *files)
+{
+	GTimer *timer;
+	GSList *loaded;
+	GList *tabs;
+	GList *l;
+
+	timer = g_timer_new ();
+
+	loaded = gedit_commands_load_locations (window, files, NULL, 0, 0);
+	g_slist_free (loaded);
+
+	/* The loading of each tab is started by now. */
+	benchmark->n_loading = 0;
+	tabs = _gedit_window_get_all_tabs (window);
+
+	for (l = tabs; l != NULL; l = l->next)
+	{
+		if (gedit_tab_get_state (l->data) == GEDIT_TAB_STATE_LOADING)
+		{
+			benchmark->n_loading++;
+		}
+	}
+
+	g_list_free (tabs);
+
+	while (benchmark->n_loading > 0)
+	{
+		g_main_context_iteration (NULL, TRUE);
+	}
+
+	report (name, benchmark->n_files, g_timer_elapsed (timer, NULL));
+	g_timer_destroy (timer);
+}
+
+static void
+activate_cb (GApplication *application,
+	     Benchmark    *benchmark)
+{
+	GeditWindow *window;
+	GList *tabs;
+	GList *l;
+
+	/* The default handler opened a window with an empty tab. */
+	window = GEDIT_WINDOW (gtk_application_get_active_window (GTK_APPLICATION (application)));
+
+	g_signal_connect (window, "tab-added", G_CALLBACK (tab_added_cb), benchmark);
+
+	tabs = _gedit_window_get_all_tabs (window);
+
+	for (l = tabs; l != NULL; l = l->next)
+	{
+		tab_added_cb (window, l->data, benchmark);
+	}
+
+	g_list_free (tabs);
+
+	open_files (benchmark, window, "into a single tab", benchmark->first);
+	open_files (benchmark, window, "into as many tabs", benchmark->second);
+	open_files (benchmark, window, "already open", benchmark->first);
+
+	g_application_quit (application);
+}
+
+gint
+main (gint   argc,
+      gchar *argv[])
+{
+	Benchmark benchmark = { 0, };
+	GSettings *settings;
+	GeditApp *app;
+	gint status;
+
+	benchmark.n_files = DEFAULT_N_FILES;
+
+	if (argc > 1)
+	{
+		benchmark.n_files = strtoul (argv[1], NULL, 10);
+	}
+
+	benchmark.dir = g_dir_make_tmp ("gedit-open-files-XXXXXX", NULL);
+	g_assert (benchmark.dir != NULL);
+
+	/* Do not touch the settings, the metadata and the plugins of the
+	 * user.
+	 */
+	g_setenv ("GSETTINGS_BACKEND", "memory", TRUE);
+	g_setenv ("XDG_CONFIG_HOME", benchmark.dir, TRUE);
+	g_setenv ("XDG_DATA_HOME", benchmark.dir, TRUE);
+	g_setenv ("XDG_CACHE_HOME", benchmark.dir, TRUE);
+
+	if (!gtk_init_check (&argc, &argv))
+	{
+		g_printerr ("Could not open a display, skipping the benchmark\n");
+		remove_tree (benchmark.dir);
+		return 77;
+	}
+
+	settings = g_settings_new ("org.gnome.gedit.plugins");
+	g_settings_set_strv (settings, GEDIT_SETTINGS_ACTIVE_PLUGINS, NULL);
+	g_object_unref (settings);
+
+	gedit_dirs_init ();
+
+	benchmark.first = create_files (benchmark.dir, "first", benchmark.n_files);
+	benchmark.second = create_files (benchmark.dir, "second", benchmark.n_files);
+
+	app = g_object_new (GEDIT_TYPE_APP_X11,
+			    "application-id", "org.gnome.gedit.Benchmark",
+			    "flags", G_APPLICATION_NON_UNIQUE,
+			    NULL);
+
+	g_signal_connect_after (app, "activate", G_CALLBACK (activate_cb), &benchmark);
+
+	status = g_application_run (G_APPLICATION (app), 1, argv);
+
+	g_object_run_dispose (G_OBJECT (app));
+	g_object_unref (app);
+
+	g_slist_free_full (benchmark.first, g_object_unref);
+	g_slist_free_full (benchmark.second, g_object_unref);
+
+	remove_tree (benchmark.dir);
+	g_free (benchmark.dir);
+
+	gedit_dirs_shutdown ();
+
+	return status;
+}
+
+/* ex:set ts=8 noet: */
@@ -61,6 +61,13 @@ GMenuModel		*_gedit_app_get_line_col_menu		(GeditApp  *app);
 GeditMenuExtension	*_gedit_app_extend_menu			(GeditApp    *app,
 								 const gchar *extension_point);
 
+void			 _gedit_app_set_document_location	(GeditApp      *app,
+								 GeditDocument *doc,
+								 GFile         *location);
+
+GList			*_gedit_app_get_documents_for_location	(GeditApp  *app,
+								 GFile     *location);
+
 G_END_DECLS
 
 #endif /* GEDIT_APP_PRIVATE_H */
@@ -82,6 +82,17 @@ typedef struct
 	PeasExtensionSet  *extensions;
 	GNetworkMonitor   *monitor;
 
+	/* Set once the first window has been drawn, which ends the
+	 * startup timeline.
+	 */
+	guint              first_frame_drawn : 1;
+
+	/* GFile -> GPtrArray of the GeditDocuments having this location */
+	GHashTable        *documents_by_location;
+
+	/* GeditDocument -> its location in documents_by_location */
+	GHashTable        *document_locations;
+
 	/* command line parsing */
 	gboolean new_window;
 	gboolean new_document;
@@ -196,6 +207,9 @@ gedit_app_dispose (GObject *object)
 	g_clear_object (&priv->tab_width_menu);
 	g_clear_object (&priv->line_col_menu);
 
+	g_clear_pointer (&priv->documents_by_location, g_hash_table_unref);
+	g_clear_pointer (&priv->document_locations, g_hash_table_unref);
+
 	G_OBJECT_CLASS (gedit_app_parent_class)->dispose (object);
 }
 
@@ -420,6 +434,8 @@ open_files (GApplication            *application,
 	GeditTab *tab;
 	gboolean doc_created = FALSE;
 
+	_gedit_debug_startup_mark ("command line");
+
 	if (!new_window)
 	{
 		window = get_active_window (GTK_APPLICATION (application));
@@ -486,6 +502,8 @@ open_files (GApplication            *application,
 		}
 	}
 
+	_gedit_debug_startup_mark ("open files");
+
 	gtk_window_present (GTK_WINDOW (window));
 }
 
@@ -619,6 +637,30 @@ extension_removed (PeasExtensionSet *extensions,
 	gedit_app_activatable_deactivate (GEDIT_APP_ACTIVATABLE (exten));
 }
 
+static gboolean
+first_window_drawn (GtkWidget *window,
+                    cairo_t   *cr,
+                    GeditApp  *app)
+{
+	GeditAppPrivate *priv;
+
+	priv = gedit_app_get_instance_private (app);
+
+	g_signal_handlers_disconnect_by_func (window, first_window_drawn, app);
+
+	if (priv->first_frame_drawn)
+	{
+		return GDK_EVENT_PROPAGATE;
+	}
+
+	priv->first_frame_drawn = TRUE;
+
+	_gedit_debug_startup_mark ("first frame");
+	_gedit_debug_startup_done ();
+
+	return GDK_EVENT_PROPAGATE;
+}
+
 static void
 load_accels (void)
 {
@@ -770,12 +812,14 @@ gedit_app_startup (GApplication *application)
 	gedit_debug_message (DEBUG_APP, "Startup");
 
 	setup_theme_extensions (GEDIT_APP (application));
+	_gedit_debug_startup_mark ("theme extensions");
 
 #ifndef ENABLE_GVFS_METADATA
 	cache_dir = gedit_dirs_get_user_cache_dir ();
-	metadata_filename = g_build_filename (cache_dir, "gedit-metadata.xml", NULL);
+	metadata_filename = g_build_filename (cache_dir, "gedit-metadata", NULL);
 	gedit_metadata_manager_init (metadata_filename);
 	g_free (metadata_filename);
+	_gedit_debug_startup_mark ("metadata manager");
 #endif
 
 	/* Load settings */
@@ -785,6 +829,7 @@ gedit_app_startup (GApplication *application)
 
 	/* initial lockdown state */
 	priv->lockdown = gedit_settings_get_lockdown (priv->settings);
+	_gedit_debug_startup_mark ("settings");
 
 	g_action_map_add_action_entries (G_ACTION_MAP (application),
 	                                 app_entries,
@@ -802,6 +847,7 @@ gedit_app_startup (GApplication *application)
 	priv->notebook_menu = get_menu_model (GEDIT_APP (application), "notebook-menu");
 	priv->tab_width_menu = get_menu_model (GEDIT_APP (application), "tab-width-menu");
 	priv->line_col_menu = get_menu_model (GEDIT_APP (application), "line-col-menu");
+	_gedit_debug_startup_mark ("actions and menus");
 
 	/* Accelerators */
 	add_accelerator (GTK_APPLICATION (application), "app.new-window", "<Primary>N");
@@ -835,11 +881,13 @@ gedit_app_startup (GApplication *application)
 	add_accelerator (GTK_APPLICATION (application), "win.next-document", "<Primary><Alt>Page_Down");
 
 	load_accels ();
+	_gedit_debug_startup_mark ("accels");
 
 	/* Load custom css */
 	g_object_unref (load_css_from_resource ("gedit-style.css", TRUE));
 	css_provider = load_css_from_resource ("gedit-style-os.css", FALSE);
 	g_clear_object (&css_provider);
+	_gedit_debug_startup_mark ("css");
 
 	/*
 	 * We use the default gtksourceview style scheme manager so that plugins
@@ -849,7 +897,11 @@ gedit_app_startup (GApplication *application)
 	manager = gtk_source_style_scheme_manager_get_default ();
 	gtk_source_style_scheme_manager_append_search_path (manager,
 	                                                    gedit_dirs_get_user_styles_dir ());
+	_gedit_debug_startup_mark ("style scheme search path");
 
+	/* The app plugins are set up before any window: the window and view
+	 * plugins may rely on what their app plugin initializes.
+	 */
 	priv->engine = gedit_plugins_engine_get_default ();
 	priv->extensions = peas_extension_set_new (PEAS_ENGINE (priv->engine),
 	                                           GEDIT_TYPE_APP_ACTIVATABLE,
@@ -869,6 +921,7 @@ gedit_app_startup (GApplication *application)
 	peas_extension_set_foreach (priv->extensions,
 	                            (PeasExtensionSetForeachFunc) extension_added,
 	                            application);
+	_gedit_debug_startup_mark ("app plugins");
 }
 
 static void
@@ -1277,12 +1330,25 @@ window_delete_event (GeditWindow *window,
 static GeditWindow *
 gedit_app_create_window_impl (GeditApp *app)
 {
+	GeditAppPrivate *priv;
 	GeditWindow *window;
 
+	priv = gedit_app_get_instance_private (app);
+
 	window = g_object_new (GEDIT_TYPE_WINDOW, "application", app, NULL);
 
 	gedit_debug_message (DEBUG_APP, "Window created");
 
+	if (!priv->first_frame_drawn)
+	{
+		_gedit_debug_startup_mark ("window created");
+
+		g_signal_connect_after (window,
+		                        "draw",
+		                        G_CALLBACK (first_window_drawn),
+		                        app);
+	}
+
 	g_signal_connect (window,
 			  "delete_event",
 			  G_CALLBACK (window_delete_event),
@@ -1440,6 +1506,16 @@ gedit_app_init (GeditApp *app)
 	g_set_application_name ("gedit");
 	gtk_window_set_default_icon_name ("gedit");
 
+	priv->documents_by_location = g_hash_table_new_full (g_file_hash,
+							     (GEqualFunc) g_file_equal,
+							     g_object_unref,
+							     (GDestroyNotify) g_ptr_array_unref);
+
+	priv->document_locations = g_hash_table_new_full (NULL,
+							  NULL,
+							  NULL,
+							  g_object_unref);
+
 	priv->monitor = g_network_monitor_get_default ();
 	g_signal_connect (priv->monitor,
 	                  "network-changed",
@@ -1594,6 +1670,117 @@ gedit_app_get_documents	(GeditApp *app)
 	return res;
 }
 
+static void
+remove_document_location (GeditAppPrivate *priv,
+			  GeditDocument   *doc)
+{
+	GFile *location;
+	GPtrArray *documents;
+
+	location = g_hash_table_lookup (priv->document_locations, doc);
+
+	if (location == NULL)
+	{
+		return;
+	}
+
+	documents = g_hash_table_lookup (priv->documents_by_location, location);
+	g_ptr_array_remove (documents, doc);
+
+	if (documents->len == 0)
+	{
+		g_hash_table_remove (priv->documents_by_location, location);
+	}
+
+	g_hash_table_remove (priv->document_locations, doc);
+}
+
+/* Keeps the index of the documents by location up to date. @location is
+ * %NULL when @doc has no location anymore or is disposed.
+ */
+void
+_gedit_app_set_document_location (GeditApp      *app,
+				  GeditDocument *doc,
+				  GFile         *location)
+{
+	GeditAppPrivate *priv;
+	GPtrArray *documents;
+
+	g_return_if_fail (GEDIT_IS_APP (app));
+	g_return_if_fail (GEDIT_IS_DOCUMENT (doc));
+	g_return_if_fail (location == NULL || G_IS_FILE (location));
+
+	priv = gedit_app_get_instance_private (app);
+
+	/* The app is disposed */
+	if (priv->documents_by_location == NULL)
+	{
+		return;
+	}
+
+	remove_document_location (priv, doc);
+
+	if (location == NULL)
+	{
+		return;
+	}
+
+	documents = g_hash_table_lookup (priv->documents_by_location, location);
+
+	if (documents == NULL)
+	{
+		documents = g_ptr_array_new ();
+		g_hash_table_insert (priv->documents_by_location,
+				     g_object_ref (location),
+				     documents);
+	}
+
+	g_ptr_array_add (documents, doc);
+	g_hash_table_insert (priv->document_locations, doc, g_object_ref (location));
+}
+
+/**
+ * _gedit_app_get_documents_for_location:
+ * @app: the #GeditApp
+ * @location: a #GFile
+ *
+ * Returns: (transfer container): the documents whose location is equal to
+ * @location, without walking all the windows.
+ */
+GList *
+_gedit_app_get_documents_for_location (GeditApp *app,
+				       GFile    *location)
+{
+	GeditAppPrivate *priv;
+	GPtrArray *documents;
+	GList *res = NULL;
+	guint i;
+
+	g_return_val_if_fail (GEDIT_IS_APP (app), NULL);
+	g_return_val_if_fail (G_IS_FILE (location), NULL);
+
+	priv = gedit_app_get_instance_private (app);
+
+	if (priv->documents_by_location == NULL)
+	{
+		return NULL;
+	}
+
+	documents = g_hash_table_lookup (priv->documents_by_location, location);
+
+	if (documents == NULL)
+	{
+		return NULL;
+	}
+
+	for (i = documents->len; i > 0; i--)
+	{
+		res = g_list_prepend (res, g_ptr_array_index (documents, i - 1));
+	}
+
+	return res;
+}
+
 /**
  * gedit_app_get_views:
  * @app: the #GeditApp
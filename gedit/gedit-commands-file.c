@@ -32,6 +32,8 @@
 #include <gio/gio.h>
 #include <gtk/gtk.h>
 
+#include "gedit-app.h"
+#include "gedit-app-private.h"
 #include "gedit-debug.h"
 #include "gedit-document.h"
 #include "gedit-document-private.h"
@@ -67,46 +69,33 @@ _gedit_cmd_file_new (GSimpleAction *action,
 	gedit_window_create_tab (window, TRUE);
 }
 
+/* Returns the tab of @window whose document is at @file, if any */
 static GeditTab *
-get_tab_from_file (GList *docs,
-		   GFile *file)
+get_tab_from_file (GeditWindow *window,
+		   GFile       *file)
 {
+	GList *docs;
 	GList *l;
+	GeditTab *tab = NULL;
+
+	docs = _gedit_app_get_documents_for_location (GEDIT_APP (g_application_get_default ()),
+						      file);
 
 	for (l = docs; l != NULL; l = l->next)
 	{
-		GeditDocument *doc;
-		GtkSourceFile *source_file;
-		GFile *location;
-
-		doc = l->data;
-		source_file = gedit_document_get_file (doc);
-		location = gtk_source_file_get_location (source_file);
+		GeditTab *cur_tab = gedit_tab_get_from_document (l->data);
 
-		if (location != NULL && g_file_equal (location, file))
+		if (cur_tab != NULL &&
+		    gtk_widget_get_toplevel (GTK_WIDGET (cur_tab)) == GTK_WIDGET (window))
 		{
-			return gedit_tab_get_from_document (doc);
+			tab = cur_tab;
+			break;
 		}
 	}
 
-	return NULL;
-}
-
-static gboolean
-is_duplicated_file (GSList *files,
-		    GFile  *file)
-{
-	GSList *l;
-
-	for (l = files; l != NULL; l = l->next)
-	{
-		if (g_file_equal (l->data, file))
-		{
-			return TRUE;
-		}
-	}
+	g_list_free (docs);
 
-	return FALSE;
+	return tab;
 }
 
 /* File loading */
@@ -118,7 +107,7 @@ load_file_list (GeditWindow             *window,
 		gint                     column_pos,
 		gboolean                 create)
 {
-	GList *win_docs;
+	GHashTable *seen_files;
 	GSList *files_to_load = NULL;
 	GSList *loaded_files = NULL;
 	GeditTab *tab;
@@ -128,7 +117,7 @@ load_file_list (GeditWindow             *window,
 
 	gedit_debug (DEBUG_COMMANDS);
 
-	win_docs = gedit_window_get_documents (window);
+	seen_files = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
 
 	/* Remove the files corresponding to documents already opened in
 	 * "window" and remove duplicates from the "files" list.
@@ -137,12 +126,12 @@ load_file_list (GeditWindow             *window,
 	{
 		GFile *file = l->data;
 
-		if (is_duplicated_file (files_to_load, file))
+		if (!g_hash_table_add (seen_files, file))
 		{
 			continue;
 		}
 
-		tab = get_tab_from_file (win_docs, file);
+		tab = get_tab_from_file (window, file);
 
 		if (tab == NULL)
 		{
@@ -181,7 +170,7 @@ load_file_list (GeditWindow             *window,
 		}
 	}
 
-	g_list_free (win_docs);
+	g_hash_table_unref (seen_files);
 
 	if (files_to_load == NULL)
 	{
@@ -224,13 +213,28 @@ load_file_list (GeditWindow             *window,
 	{
 		g_return_val_if_fail (l->data != NULL, NULL);
 
-		tab = gedit_window_create_tab_from_location (window,
-							     l->data,
-							     encoding,
-							     line_pos,
-							     column_pos,
-							     create,
-							     jump_to);
+		/* The tabs opened in the background are loaded when they
+		 * are shown, opening many files is then nearly free.
+		 */
+		if (jump_to)
+		{
+			tab = gedit_window_create_tab_from_location (window,
+								     l->data,
+								     encoding,
+								     line_pos,
+								     column_pos,
+								     create,
+								     jump_to);
+		}
+		else
+		{
+			tab = _gedit_window_create_deferred_tab (window,
+								 l->data,
+								 encoding,
+								 line_pos,
+								 column_pos,
+								 create);
+		}
 
 		if (tab != NULL)
 		{
@@ -1000,6 +1004,18 @@ gedit_commands_save_document_async (GeditDocument       *document,
 	tab = gedit_tab_get_from_document (document);
 	file = gedit_document_get_file (document);
 
+	/* Only a part of a large file is in the buffer */
+	if (_gedit_document_get_large_file (document) != NULL)
+	{
+		gedit_debug_message (DEBUG_COMMANDS, "Large file");
+
+		_gedit_tab_show_large_file_saving_error (tab);
+
+		g_task_return_boolean (task, FALSE);
+		g_object_unref (task);
+		return;
+	}
+
 	if (gedit_document_is_untitled (document) ||
 	    gtk_source_file_is_readonly (file))
 	{
@@ -41,9 +41,16 @@
 #include "gedit-window-private.h"
 #include "gedit-utils.h"
 #include "gedit-replace-dialog.h"
+#include "gedit-search-results-panel.h"
+#include "gedit-document-private.h"
 
 #define GEDIT_REPLACE_DIALOG_KEY	"gedit-replace-dialog-key"
 #define GEDIT_LAST_SEARCH_DATA_KEY	"gedit-last-search-data-key"
+#define GEDIT_REPLACE_ALL_DATA_KEY	"gedit-replace-all-data-key"
+#define GEDIT_REPLACE_ALL_DOCUMENTS_DATA_KEY	"gedit-replace-all-documents-data-key"
+
+/* Time spent replacing, in microseconds, before letting the main loop run */
+#define REPLACE_ALL_CHUNK_TIME		(10 * 1000)
 
 typedef struct _LastSearchData LastSearchData;
 struct _LastSearchData
@@ -442,57 +449,315 @@ do_replace (GeditReplaceDialog *dialog,
 	do_find (dialog, window);
 }
 
-static void
-do_replace_all (GeditReplaceDialog *dialog,
-		GeditWindow        *window)
+/* The Replace All is done in chunks from an idle, so that the UI stays
+ * responsive and shows the progress. All the replacements are done in one
+ * user action, so they are undone at once, and stopping the Replace All undoes
+ * the replacements already done.
+ */
+typedef struct _ReplaceAllData ReplaceAllData;
+typedef struct _ReplaceAllDocumentsData ReplaceAllDocumentsData;
+
+struct _ReplaceAllData
 {
+	GeditReplaceDialog *dialog;
+	GeditWindow *window;
+	GeditDocument *doc;
 	GeditView *view;
 	GtkSourceSearchContext *search_context;
-	GtkTextBuffer *buffer;
-	GtkSourceCompletion *completion;
-	const gchar *replace_entry_text;
-	gchar *unescaped_replace_text;
+	gchar *replace_text;
+
+	/* Where the next search starts */
+	GtkTextMark *mark;
+
 	gint count;
-	GError *error = NULL;
+	guint idle_id;
 
-	view = gedit_window_get_active_view (window);
+	/* Set when the document is one of a Replace All in all the
+	 * documents.
+	 */
+	ReplaceAllDocumentsData *documents_data;
 
-	if (view == NULL)
+	guint view_was_editable : 1;
+};
+
+static void    replace_all_document_finished  (ReplaceAllDocumentsData *documents_data,
+					        GError                  *error);
+static gdouble replace_all_documents_progress (ReplaceAllDocumentsData *documents_data,
+					        gdouble                  fraction);
+
+static ReplaceAllData *
+replace_all_data_new (GeditReplaceDialog     *dialog,
+		      GeditWindow            *window,
+		      GeditView              *view,
+		      GtkSourceSearchContext *search_context,
+		      const gchar            *replace_text)
+{
+	GtkTextBuffer *buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (view));
+	ReplaceAllData *data;
+	GtkTextIter start;
+
+	data = g_slice_new0 (ReplaceAllData);
+	data->dialog = dialog;
+	data->window = window;
+	data->doc = GEDIT_DOCUMENT (g_object_ref (buffer));
+	data->view = g_object_ref (view);
+	data->search_context = g_object_ref (search_context);
+	data->replace_text = g_strdup (replace_text);
+
+	gtk_text_buffer_get_start_iter (buffer, &start);
+	data->mark = gtk_text_buffer_create_mark (buffer, NULL, &start, FALSE);
+
+	/* The user must not edit the document between two chunks */
+	data->view_was_editable = gtk_text_view_get_editable (GTK_TEXT_VIEW (view));
+	gtk_text_view_set_editable (GTK_TEXT_VIEW (view), FALSE);
+
+	/* FIXME: this should really be done automatically in gtksoureview, but
+	 * it is an important performance fix, so let's do it here for now.
+	 */
+	gtk_source_completion_block_interactive (gtk_source_view_get_completion (GTK_SOURCE_VIEW (view)));
+
+	gtk_text_buffer_begin_user_action (buffer);
+
+	return data;
+}
+
+static void
+replace_all_data_free (ReplaceAllData *data)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (data->doc);
+
+	if (data->idle_id != 0)
 	{
-		return;
+		g_source_remove (data->idle_id);
 	}
 
-	buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (view));
+	gtk_text_buffer_end_user_action (buffer);
+	gtk_text_buffer_delete_mark (buffer, data->mark);
 
-	search_context = gedit_document_get_search_context (GEDIT_DOCUMENT (buffer));
+	gtk_text_view_set_editable (GTK_TEXT_VIEW (data->view),
+				    data->view_was_editable);
+	gtk_source_completion_unblock_interactive (gtk_source_view_get_completion (GTK_SOURCE_VIEW (data->view)));
 
-	if (search_context == NULL)
+	g_object_unref (data->search_context);
+	g_object_unref (data->view);
+	g_object_unref (data->doc);
+	g_free (data->replace_text);
+
+	g_slice_free (ReplaceAllData, data);
+}
+
+static void
+replace_all_finished (ReplaceAllData *data,
+		      GError         *error)
+{
+	GeditReplaceDialog *dialog = data->dialog;
+	GeditWindow *window = data->window;
+	gint count = data->count;
+
+	data->idle_id = 0;
+
+	if (data->documents_data != NULL)
 	{
+		replace_all_document_finished (data->documents_data, error);
 		return;
 	}
 
-	/* FIXME: this should really be done automatically in gtksoureview, but
-	 * it is an important performance fix, so let's do it here for now.
-	 */
-	completion = gtk_source_view_get_completion (GTK_SOURCE_VIEW (view));
-	gtk_source_completion_block_interactive (completion);
+	/* Frees data */
+	g_object_set_data (G_OBJECT (dialog), GEDIT_REPLACE_ALL_DATA_KEY, NULL);
 
-	/* replace text may be "", we just delete all occurrences */
-	replace_entry_text = gedit_replace_dialog_get_replace_text (dialog);
-	g_return_if_fail (replace_entry_text != NULL);
+	gedit_replace_dialog_set_replace_all_running (dialog, FALSE);
 
-	unescaped_replace_text = gtk_source_utils_unescape_search_text (replace_entry_text);
+	if (count > 0)
+	{
+		text_found (window, count);
+	}
+	else if (error == NULL)
+	{
+		text_not_found (window, dialog);
+	}
 
-	count = gtk_source_search_context_replace_all (search_context,
-						       unescaped_replace_text,
-						       -1,
-						       &error);
+	if (error != NULL)
+	{
+		gedit_replace_dialog_set_replace_error (dialog, error->message);
+		g_error_free (error);
+	}
+}
 
-	g_free (unescaped_replace_text);
+static gboolean
+replace_all_step (ReplaceAllData *data)
+{
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER (data->doc);
+	GtkTextIter iter;
+	gint64 end_time;
+	gint n_chars;
+	gdouble fraction;
 
-	gtk_source_completion_unblock_interactive (completion);
+	gtk_text_buffer_get_iter_at_mark (buffer, &iter, data->mark);
 
-	if (count > 0)
+	end_time = g_get_monotonic_time () + REPLACE_ALL_CHUNK_TIME;
+
+	do
+	{
+		GtkTextIter match_start;
+		GtkTextIter match_end;
+		gboolean has_wrapped_around;
+		gboolean empty_match;
+		GError *error = NULL;
+
+		if (!gtk_source_search_context_forward (data->search_context,
+							&iter,
+							&match_start,
+							&match_end,
+							&has_wrapped_around) ||
+		    has_wrapped_around)
+		{
+			replace_all_finished (data, NULL);
+			return G_SOURCE_REMOVE;
+		}
+
+		empty_match = gtk_text_iter_equal (&match_start, &match_end);
+
+		if (!gtk_source_search_context_replace (data->search_context,
+							&match_start,
+							&match_end,
+							data->replace_text,
+							-1,
+							&error))
+		{
+			replace_all_finished (data, error);
+			return G_SOURCE_REMOVE;
+		}
+
+		data->count++;
+
+		/* match_end has been revalidated to the end of the replacement.
+		 * Do not match again at the same place after an empty match.
+		 */
+		iter = match_end;
+
+		if (empty_match && !gtk_text_iter_forward_char (&iter))
+		{
+			replace_all_finished (data, NULL);
+			return G_SOURCE_REMOVE;
+		}
+	}
+	while (g_get_monotonic_time () < end_time);
+
+	gtk_text_buffer_move_mark (buffer, data->mark, &iter);
+
+	n_chars = gtk_text_buffer_get_char_count (buffer);
+
+	fraction = n_chars > 0 ? (gdouble) gtk_text_iter_get_offset (&iter) / n_chars : 1.0;
+
+	if (data->documents_data != NULL)
+	{
+		fraction = replace_all_documents_progress (data->documents_data, fraction);
+	}
+
+	gedit_replace_dialog_set_replace_all_progress (data->dialog, fraction);
+
+	return G_SOURCE_CONTINUE;
+}
+
+/* Replace All in all the documents of the window. The documents are done one
+ * after the other with replace_all_step(), each in its own user action. The
+ * documents of the tabs not shown yet are loaded first.
+ */
+struct _ReplaceAllDocumentsData
+{
+	GeditReplaceDialog *dialog;
+	GeditWindow *window;
+	GtkSourceSearchSettings *settings;
+	gchar *replace_text;
+
+	/* The documents still to do */
+	GList *documents;
+	gint n_documents;
+	gint n_done;
+
+	/* The document being done */
+	ReplaceAllData *current;
+
+	/* The tab whose document is loaded before being done */
+	GeditTab *loading_tab;
+	gulong loading_tab_handler_id;
+
+	/* The documents which could not be done */
+	gint n_skipped;
+
+	gint count;
+	guint idle_id;
+};
+
+static gboolean replace_all_documents_step (ReplaceAllDocumentsData *data);
+
+static void
+stop_waiting_for_tab (ReplaceAllDocumentsData *data)
+{
+	if (data->loading_tab != NULL)
+	{
+		g_signal_handler_disconnect (data->loading_tab, data->loading_tab_handler_id);
+		g_clear_object (&data->loading_tab);
+		data->loading_tab_handler_id = 0;
+	}
+}
+
+static void
+replace_all_documents_data_free (ReplaceAllDocumentsData *data)
+{
+	if (data->idle_id != 0)
+	{
+		g_source_remove (data->idle_id);
+	}
+
+	if (data->current != NULL)
+	{
+		replace_all_data_free (data->current);
+	}
+
+	stop_waiting_for_tab (data);
+
+	g_list_free_full (data->documents, g_object_unref);
+	g_object_unref (data->settings);
+	g_free (data->replace_text);
+
+	g_slice_free (ReplaceAllDocumentsData, data);
+}
+
+/* @fraction is the part of the current document already done */
+static gdouble
+replace_all_documents_progress (ReplaceAllDocumentsData *data,
+				gdouble                  fraction)
+{
+	return (data->n_done + fraction) / MAX (data->n_documents, 1);
+}
+
+static void
+replace_all_documents_finished (ReplaceAllDocumentsData *data,
+				GError                  *error)
+{
+	GeditReplaceDialog *dialog = data->dialog;
+	GeditWindow *window = data->window;
+	gint count = data->count;
+	gint n_skipped = data->n_skipped;
+
+	/* Frees data */
+	data->idle_id = 0;
+	g_object_set_data (G_OBJECT (dialog), GEDIT_REPLACE_ALL_DOCUMENTS_DATA_KEY, NULL);
+
+	gedit_replace_dialog_set_replace_all_running (dialog, FALSE);
+
+	if (n_skipped > 0)
+	{
+		gedit_statusbar_flash_message (GEDIT_STATUSBAR (window->priv->statusbar),
+					       window->priv->generic_message_cid,
+					       ngettext ("Found and replaced %d occurrences, %d document could not be searched",
+							 "Found and replaced %d occurrences, %d documents could not be searched",
+							 n_skipped),
+					       count,
+					       n_skipped);
+	}
+	else if (count > 0)
 	{
 		text_found (window, count);
 	}
@@ -508,6 +773,379 @@ do_replace_all (GeditReplaceDialog *dialog,
 	}
 }
 
+static void
+replace_all_document_finished (ReplaceAllDocumentsData *data,
+			       GError                  *error)
+{
+	ReplaceAllData *current = data->current;
+
+	data->count += current->count;
+	data->n_done++;
+
+	/* Ends the user action of the document */
+	data->current = NULL;
+	replace_all_data_free (current);
+
+	if (error != NULL)
+	{
+		replace_all_documents_finished (data, error);
+		return;
+	}
+
+	gedit_replace_dialog_set_replace_all_progress (data->dialog,
+						       replace_all_documents_progress (data, 0.0));
+
+	data->idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+					 (GSourceFunc) replace_all_documents_step,
+					 data,
+					 NULL);
+}
+
+static gboolean
+is_tab_loading (GeditTab *tab)
+{
+	GeditTabState state = gedit_tab_get_state (tab);
+
+	return state == GEDIT_TAB_STATE_LOADING ||
+	       state == GEDIT_TAB_STATE_REVERTING;
+}
+
+static gboolean
+can_replace_in_document (GeditDocument *doc)
+{
+	GeditTab *tab;
+
+	if (_gedit_document_get_loading_deferred (doc) ||
+	    _gedit_document_get_large_file (doc) != NULL)
+	{
+		return FALSE;
+	}
+
+	tab = gedit_tab_get_from_document (doc);
+
+	return tab != NULL && gedit_tab_get_state (tab) == GEDIT_TAB_STATE_NORMAL;
+}
+
+static void
+loading_tab_state_changed (GeditTab                *tab,
+			   GParamSpec              *pspec,
+			   ReplaceAllDocumentsData *data)
+{
+	if (is_tab_loading (tab))
+	{
+		return;
+	}
+
+	stop_waiting_for_tab (data);
+
+	data->idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+					 (GSourceFunc) replace_all_documents_step,
+					 data,
+					 NULL);
+}
+
+static gboolean
+replace_all_documents_step (ReplaceAllDocumentsData *data)
+{
+	GeditDocument *doc = NULL;
+	GeditTab *tab = NULL;
+	GeditView *view;
+	GtkSourceSearchContext *search_context;
+
+	data->idle_id = 0;
+
+	while (data->documents != NULL)
+	{
+		doc = data->documents->data;
+		tab = gedit_tab_get_from_document (doc);
+
+		/* Waits until the document is loaded, it stays the next one */
+		if (tab != NULL && is_tab_loading (tab))
+		{
+			data->loading_tab = g_object_ref (tab);
+			data->loading_tab_handler_id =
+				g_signal_connect (tab,
+						  "notify::state",
+						  G_CALLBACK (loading_tab_state_changed),
+						  data);
+
+			return G_SOURCE_REMOVE;
+		}
+
+		data->documents = g_list_delete_link (data->documents, data->documents);
+
+		if (can_replace_in_document (doc))
+		{
+			break;
+		}
+
+		data->n_skipped++;
+		data->n_done++;
+		g_object_unref (doc);
+		doc = NULL;
+	}
+
+	if (doc == NULL)
+	{
+		replace_all_documents_finished (data, NULL);
+		return G_SOURCE_REMOVE;
+	}
+
+	view = gedit_tab_get_view (tab);
+
+	search_context = gtk_source_search_context_new (GTK_SOURCE_BUFFER (doc),
+							data->settings);
+	gtk_source_search_context_set_highlight (search_context, FALSE);
+
+	data->current = replace_all_data_new (data->dialog,
+					      data->window,
+					      view,
+					      search_context,
+					      data->replace_text);
+	data->current->documents_data = data;
+
+	g_object_unref (search_context);
+	g_object_unref (doc);
+
+	/* Below the redraw priority, so that the progress is drawn */
+	data->current->idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+						  (GSourceFunc) replace_all_step,
+						  data->current,
+						  NULL);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+replace_all_documents (GeditReplaceDialog *dialog,
+		       GeditWindow        *window)
+{
+	GeditDocument *active_doc;
+	GtkSourceSearchContext *search_context;
+	const gchar *replace_entry_text;
+	ReplaceAllDocumentsData *data;
+	GList *l;
+
+	active_doc = gedit_window_get_active_document (window);
+
+	if (active_doc == NULL)
+	{
+		return;
+	}
+
+	/* The search settings of the dialog are set in the search context
+	 * of the active document.
+	 */
+	search_context = gedit_document_get_search_context (active_doc);
+
+	if (search_context == NULL)
+	{
+		return;
+	}
+
+	replace_entry_text = gedit_replace_dialog_get_replace_text (dialog);
+	g_return_if_fail (replace_entry_text != NULL);
+
+	data = g_slice_new0 (ReplaceAllDocumentsData);
+	data->dialog = dialog;
+	data->window = window;
+	data->settings = g_object_ref (gtk_source_search_context_get_settings (search_context));
+	data->replace_text = gtk_source_utils_unescape_search_text (replace_entry_text);
+	data->documents = gedit_window_get_documents (window);
+	g_list_foreach (data->documents, (GFunc) g_object_ref, NULL);
+	data->n_documents = g_list_length (data->documents);
+
+	/* All the documents not loaded yet are loaded at once, while the
+	 * first ones are done.
+	 */
+	for (l = data->documents; l != NULL; l = l->next)
+	{
+		GeditTab *tab = gedit_tab_get_from_document (l->data);
+
+		if (tab != NULL)
+		{
+			_gedit_tab_start_deferred_loading (tab);
+		}
+	}
+
+	g_object_set_data_full (G_OBJECT (dialog),
+				GEDIT_REPLACE_ALL_DOCUMENTS_DATA_KEY,
+				data,
+				(GDestroyNotify) replace_all_documents_data_free);
+
+	gedit_replace_dialog_set_replace_all_running (dialog, TRUE);
+
+	data->idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+					 (GSourceFunc) replace_all_documents_step,
+					 data,
+					 NULL);
+}
+
+static void
+find_in_all_documents (GeditReplaceDialog *dialog,
+		       GeditWindow        *window)
+{
+	GeditDocument *active_doc;
+	GtkSourceSearchContext *search_context;
+	GtkWidget *panel;
+
+	active_doc = gedit_window_get_active_document (window);
+
+	if (active_doc == NULL)
+	{
+		return;
+	}
+
+	search_context = gedit_document_get_search_context (active_doc);
+
+	if (search_context == NULL)
+	{
+		return;
+	}
+
+	panel = _gedit_window_show_search_results_panel (window);
+
+	gedit_search_results_panel_search (GEDIT_SEARCH_RESULTS_PANEL (panel),
+					   gtk_source_search_context_get_settings (search_context));
+}
+
+static void
+stop_replace_all (GeditReplaceDialog *dialog)
+{
+	ReplaceAllData *data;
+	ReplaceAllDocumentsData *documents_data;
+	GtkSourceBuffer *buffer;
+	gboolean undo;
+
+	/* The documents already done are kept, each of them can be undone.
+	 * The replacements already done in the current one are undone.
+	 */
+	documents_data = g_object_get_data (G_OBJECT (dialog), GEDIT_REPLACE_ALL_DOCUMENTS_DATA_KEY);
+
+	if (documents_data != NULL)
+	{
+		data = documents_data->current;
+		buffer = NULL;
+		undo = FALSE;
+
+		if (data != NULL)
+		{
+			buffer = GTK_SOURCE_BUFFER (g_object_ref (data->doc));
+			undo = data->count > 0;
+
+			/* Ends the user action */
+			documents_data->current = NULL;
+			replace_all_data_free (data);
+		}
+
+		g_list_free_full (documents_data->documents, g_object_unref);
+		documents_data->documents = NULL;
+
+		replace_all_documents_finished (documents_data, NULL);
+
+		if (buffer != NULL)
+		{
+			if (undo && gtk_source_buffer_can_undo (buffer))
+			{
+				gtk_source_buffer_undo (buffer);
+			}
+
+			g_object_unref (buffer);
+		}
+
+		return;
+	}
+
+	data = g_object_get_data (G_OBJECT (dialog), GEDIT_REPLACE_ALL_DATA_KEY);
+
+	if (data == NULL)
+	{
+		return;
+	}
+
+	buffer = GTK_SOURCE_BUFFER (g_object_ref (data->doc));
+	undo = data->count > 0;
+
+	/* Ends the user action */
+	g_object_set_data (G_OBJECT (dialog), GEDIT_REPLACE_ALL_DATA_KEY, NULL);
+
+	if (undo && gtk_source_buffer_can_undo (buffer))
+	{
+		gtk_source_buffer_undo (buffer);
+	}
+
+	g_object_unref (buffer);
+
+	gedit_replace_dialog_set_replace_all_running (dialog, FALSE);
+}
+
+static void
+do_replace_all (GeditReplaceDialog *dialog,
+		GeditWindow        *window)
+{
+	GeditView *view;
+	GtkSourceSearchContext *search_context;
+	GtkTextBuffer *buffer;
+	const gchar *replace_entry_text;
+	gchar *replace_text;
+	ReplaceAllData *data;
+
+	if (g_object_get_data (G_OBJECT (dialog), GEDIT_REPLACE_ALL_DATA_KEY) != NULL ||
+	    g_object_get_data (G_OBJECT (dialog), GEDIT_REPLACE_ALL_DOCUMENTS_DATA_KEY) != NULL)
+	{
+		return;
+	}
+
+	if (gedit_replace_dialog_get_all_documents (dialog))
+	{
+		replace_all_documents (dialog, window);
+		return;
+	}
+
+	view = gedit_window_get_active_view (window);
+
+	if (view == NULL)
+	{
+		return;
+	}
+
+	buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (view));
+
+	search_context = gedit_document_get_search_context (GEDIT_DOCUMENT (buffer));
+
+	if (search_context == NULL)
+	{
+		return;
+	}
+
+	/* replace text may be "", we just delete all occurrences */
+	replace_entry_text = gedit_replace_dialog_get_replace_text (dialog);
+	g_return_if_fail (replace_entry_text != NULL);
+
+	replace_text = gtk_source_utils_unescape_search_text (replace_entry_text);
+
+	data = replace_all_data_new (dialog,
+				     window,
+				     view,
+				     search_context,
+				     replace_text);
+
+	g_free (replace_text);
+
+	g_object_set_data_full (G_OBJECT (dialog),
+				GEDIT_REPLACE_ALL_DATA_KEY,
+				data,
+				(GDestroyNotify) replace_all_data_free);
+
+	gedit_replace_dialog_set_replace_all_running (dialog, TRUE);
+
+	/* Below the redraw priority, so that the progress is drawn */
+	data->idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+					 (GSourceFunc) replace_all_step,
+					 data,
+					 NULL);
+}
+
 static void
 replace_dialog_response_cb (GeditReplaceDialog *dialog,
 			    gint                response_id,
@@ -518,7 +1156,14 @@ replace_dialog_response_cb (GeditReplaceDialog *dialog,
 	switch (response_id)
 	{
 		case GEDIT_REPLACE_DIALOG_FIND_RESPONSE:
-			do_find (dialog, window);
+			if (gedit_replace_dialog_get_all_documents (dialog))
+			{
+				find_in_all_documents (dialog, window);
+			}
+			else
+			{
+				do_find (dialog, window);
+			}
 			break;
 
 		case GEDIT_REPLACE_DIALOG_REPLACE_RESPONSE:
@@ -529,6 +1174,10 @@ replace_dialog_response_cb (GeditReplaceDialog *dialog,
 			do_replace_all (dialog, window);
 			break;
 
+		case GEDIT_REPLACE_DIALOG_STOP_RESPONSE:
+			stop_replace_all (dialog);
+			break;
+
 		default:
 			last_search_data_store_position (dialog);
 			gtk_widget_hide (GTK_WIDGET (dialog));
@@ -32,6 +32,10 @@ static gdouble last_time = 0.0;
 
 static GeditDebugSection enabled_sections = GEDIT_NO_DEBUG;
 
+/* Only set when GEDIT_PROFILE_STARTUP is set */
+static GTimer *startup_timer = NULL;
+static gdouble startup_last_time = 0.0;
+
 #define DEBUG_IS_ENABLED(section) (enabled_sections & (section))
 
 /**
@@ -47,12 +51,21 @@ static GeditDebugSection enabled_sections = GEDIT_NO_DEBUG;
  * for all debug sections, set the <code>GEDIT_DEBUG</code> environment
  * variable.
  *
+ * Setting the <code>GEDIT_PROFILE_STARTUP</code> environment variable prints
+ * a timeline of the startup phases, up to the first frame of the first
+ * window.
+ *
  * This function must be called before any of the other debug functions are
  * called. It must only be called once.
  */
 void
 gedit_debug_init (void)
 {
+	if (g_getenv ("GEDIT_PROFILE_STARTUP") != NULL)
+	{
+		startup_timer = g_timer_new ();
+	}
+
 	if (g_getenv ("GEDIT_DEBUG") != NULL)
 	{
 		/* enable all debugging */
@@ -233,4 +246,53 @@ gedit_debug_plugin_message (const gchar       *file,
 	gedit_debug_message (GEDIT_DEBUG_PLUGINS, file, line, function, "%s", message);
 }
 
+/*
+ * _gedit_debug_startup_mark:
+ * @phase: the name of the startup phase which just ended.
+ *
+ * If startup profiling is enabled, logs the time elapsed since
+ * gedit_debug_init() and the time spent in @phase.
+ */
+void
+_gedit_debug_startup_mark (const gchar *phase)
+{
+	gdouble seconds;
+
+	if (G_LIKELY (startup_timer == NULL))
+	{
+		return;
+	}
+
+	seconds = g_timer_elapsed (startup_timer, NULL);
+
+	g_print ("[startup] %9.3f ms (+%8.3f ms) %s\n",
+		 seconds * 1000.0,
+		 (seconds - startup_last_time) * 1000.0,
+		 phase);
+
+	fflush (stdout);
+
+	startup_last_time = seconds;
+}
+
+/*
+ * _gedit_debug_startup_done:
+ *
+ * Ends the startup timeline, later calls to _gedit_debug_startup_mark()
+ * are ignored.
+ */
+void
+_gedit_debug_startup_done (void)
+{
+	if (G_LIKELY (startup_timer == NULL))
+	{
+		return;
+	}
+
+	_gedit_debug_startup_mark ("startup done");
+
+	g_timer_destroy (startup_timer);
+	startup_timer = NULL;
+}
+
 /* ex:set ts=8 noet: */
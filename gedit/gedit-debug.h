@@ -81,5 +81,12 @@ void gedit_debug_plugin_message (const gchar       *file,
 				 const gchar       *function,
 				 const gchar       *message);
 
+/*
+ * Non exported functions
+ */
+void _gedit_debug_startup_mark (const gchar *phase);
+
+void _gedit_debug_startup_done (void);
+
 #endif /* GEDIT_DEBUG_H */
 /* ex:set ts=8 noet: */
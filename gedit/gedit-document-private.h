@@ -25,6 +25,7 @@
 #define GEDIT_DOCUMENT_PRIVATE_H
 
 #include "gedit-document.h"
+#include "gedit-large-file.h"
 
 G_BEGIN_DECLS
 
@@ -49,6 +50,24 @@ void		 _gedit_document_set_create				(GeditDocument       *doc,
 
 gboolean	 _gedit_document_get_create				(GeditDocument       *doc);
 
+GeditLargeFile	*_gedit_document_get_large_file				(GeditDocument       *doc);
+
+void		 _gedit_document_set_large_file				(GeditDocument       *doc,
+									 GeditLargeFile      *large_file);
+
+void		 _gedit_document_set_loading_done			(GeditDocument       *doc);
+
+gboolean	 _gedit_document_get_needs_content_type_sniffing	(GeditDocument       *doc);
+
+void		 _gedit_document_set_content_type_from_data		(GeditDocument       *doc,
+									 const guchar        *data,
+									 gsize                size);
+
+gboolean	 _gedit_document_get_loading_deferred			(GeditDocument       *doc);
+
+void		 _gedit_document_set_loading_deferred			(GeditDocument       *doc,
+									 gboolean             loading_deferred);
+
 G_END_DECLS
 
 #endif /* GEDIT_DOCUMENT_PRIVATE_H */
@@ -31,6 +31,8 @@
 #include <string.h>
 #include <glib/gi18n.h>
 
+#include "gedit-app.h"
+#include "gedit-app-private.h"
 #include "gedit-settings.h"
 #include "gedit-debug.h"
 #include "gedit-utils.h"
@@ -40,6 +42,7 @@
 
 #define NO_LANGUAGE_NAME "_NORMAL_"
 
+static void	gedit_document_load_real	(GeditDocument *doc);
 static void	gedit_document_loaded_real	(GeditDocument *doc);
 
 static void	gedit_document_saved_real	(GeditDocument *doc);
@@ -47,6 +50,9 @@ static void	gedit_document_saved_real	(GeditDocument *doc);
 static void	set_content_type		(GeditDocument *doc,
 						 const gchar   *content_type);
 
+static void	update_app_index		(GeditDocument *doc,
+						 GFile         *location);
+
 typedef struct
 {
 	GtkSourceFile *file;
@@ -67,11 +73,19 @@ typedef struct
 	 */
 	GtkSourceSearchContext *search_context;
 
+	/* Set when the buffer only shows a window of a large file */
+	GeditLargeFile *large_file;
+
 	guint user_action;
 
 	guint language_set_by_user : 1;
 	guint use_gvfs_metadata : 1;
 
+	/* The location is set but the file will only be loaded when its tab
+	 * is shown.
+	 */
+	guint loading_deferred : 1;
+
 	/* The search is empty if there is no search context, or if the
 	 * search text is empty. It is used for the sensitivity of some menu
 	 * actions.
@@ -82,6 +96,19 @@ typedef struct
 	 * when opened from the command line).
 	 */
 	guint create : 1;
+
+	/* Between the "load" and "loaded" signals */
+	guint loading : 1;
+
+	/* The content type of the file being loaded is not cached, it has
+	 * to be sniffed from its first bytes before the loader starts.
+	 */
+	guint needs_content_type_sniffing : 1;
+
+	/* The first bytes of a compressed file could not be uncompressed,
+	 * the content type is guessed from the text once it is loaded.
+	 */
+	guint guess_content_type_when_loaded : 1;
 } GeditDocumentPrivate;
 
 enum
@@ -112,6 +139,29 @@ static guint document_signals[LAST_SIGNAL];
 
 static GHashTable *allocated_untitled_numbers = NULL;
 
+/* The content types found for the locations loaded or saved, so that a
+ * file opened again gets its language before its text is inserted. Only
+ * the most recently used ones are kept.
+ */
+#define MAX_CACHED_CONTENT_TYPES 256
+
+/* Uncompressed bytes looked at to guess the content type of a compressed
+ * file.
+ */
+#define UNCOMPRESSED_SNIFF_SIZE 4096
+
+typedef struct
+{
+	GFile *location;
+	gchar *content_type;
+} CachedContentType;
+
+/* GFile -> its link in content_types_lru */
+static GHashTable *content_types = NULL;
+
+/* The CachedContentTypes, the most recently used first */
+static GQueue content_types_lru = G_QUEUE_INIT;
+
 G_DEFINE_TYPE_WITH_PRIVATE (GeditDocument, gedit_document, GTK_SOURCE_TYPE_BUFFER)
 
 static gint
@@ -164,11 +214,33 @@ save_metadata (GeditDocument *doc)
 	gchar *position;
 
 	priv = gedit_document_get_instance_private (doc);
+
+	/* The buffer is empty, the metadata of the file must be kept */
+	if (priv->loading_deferred)
+	{
+		return;
+	}
+
 	if (priv->language_set_by_user)
 	{
 		language = get_language_string (doc);
 	}
 
+	/* The buffer only has a part of a large file, the position in it
+	 * would be wrong for the whole file.
+	 */
+	if (priv->large_file != NULL)
+	{
+		if (language != NULL)
+		{
+			gedit_document_set_metadata (doc,
+						     GEDIT_METADATA_ATTRIBUTE_LANGUAGE, language,
+						     NULL);
+		}
+
+		return;
+	}
+
 	gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (doc),
 					  &iter,
 					  gtk_text_buffer_get_insert (GTK_TEXT_BUFFER (doc)));
@@ -206,6 +278,7 @@ gedit_document_dispose (GObject *object)
 	if (priv->file != NULL)
 	{
 		save_metadata (doc);
+		update_app_index (doc, NULL);
 
 		g_object_unref (priv->file);
 		priv->file = NULL;
@@ -214,6 +287,7 @@ gedit_document_dispose (GObject *object)
 	g_clear_object (&priv->editor_settings);
 	g_clear_object (&priv->metadata_info);
 	g_clear_object (&priv->search_context);
+	g_clear_object (&priv->large_file);
 
 	G_OBJECT_CLASS (gedit_document_parent_class)->dispose (object);
 }
@@ -406,6 +480,7 @@ gedit_document_class_init (GeditDocumentClass *klass)
 	buf_class->mark_set = gedit_document_mark_set;
 	buf_class->changed = gedit_document_changed;
 
+	klass->load = gedit_document_load_real;
 	klass->loaded = gedit_document_loaded_real;
 	klass->saved = gedit_document_saved_real;
 
@@ -729,9 +804,7 @@ guess_language (GeditDocument *doc)
 }
 
 static void
-on_content_type_changed (GeditDocument *doc,
-			 GParamSpec    *pspec,
-			 gpointer       useless)
+update_language (GeditDocument *doc)
 {
 	GeditDocumentPrivate *priv;
 
@@ -748,12 +821,32 @@ on_content_type_changed (GeditDocument *doc,
 	}
 }
 
+static void
+on_content_type_changed (GeditDocument *doc,
+			 GParamSpec    *pspec,
+			 gpointer       useless)
+{
+	update_language (doc);
+}
+
 static gchar *
 get_default_content_type (void)
 {
 	return g_content_type_from_mime_type ("text/plain");
 }
 
+static void
+update_app_index (GeditDocument *doc,
+		  GFile         *location)
+{
+	GApplication *app = g_application_get_default ();
+
+	if (GEDIT_IS_APP (app))
+	{
+		_gedit_app_set_document_location (GEDIT_APP (app), doc, location);
+	}
+}
+
 static void
 on_location_changed (GtkSourceFile *file,
 		     GParamSpec    *pspec,
@@ -768,6 +861,8 @@ on_location_changed (GtkSourceFile *file,
 
 	location = gtk_source_file_get_location (file);
 
+	update_app_index (doc, location);
+
 	if (location != NULL && priv->untitled_number > 0)
 	{
 		release_untitled_number (priv->untitled_number);
@@ -911,12 +1006,21 @@ gedit_document_new (void)
 static gchar *
 get_content_type_from_content (GeditDocument *doc)
 {
+	GeditDocumentPrivate *priv;
 	gchar *content_type;
 	gchar *data;
 	GtkTextBuffer *buffer;
 	GtkTextIter start;
 	GtkTextIter end;
 
+	priv = gedit_document_get_instance_private (doc);
+
+	/* The text is not there yet */
+	if (priv->loading)
+	{
+		return NULL;
+	}
+
 	buffer = GTK_TEXT_BUFFER (doc);
 
 	gtk_text_buffer_get_start_iter (buffer, &start);
@@ -1222,84 +1326,135 @@ gedit_document_get_readonly (GeditDocument *doc)
 }
 
 static void
-loaded_query_info_cb (GFile         *location,
-		      GAsyncResult  *result,
-		      GeditDocument *doc)
+cached_content_type_free (CachedContentType *cached)
 {
-	GFileInfo *info;
-	GError *error = NULL;
+	g_object_unref (cached->location);
+	g_free (cached->content_type);
+	g_slice_free (CachedContentType, cached);
+}
 
-	info = g_file_query_info_finish (location, result, &error);
+static const gchar *
+lookup_cached_content_type (GFile *location)
+{
+	GList *link;
 
-	if (error != NULL)
+	if (content_types == NULL)
 	{
-		/* Ignore not found error as it can happen when opening a
-		 * non-existent file from the command line.
-		 */
-		if (error->domain != G_IO_ERROR ||
-		    error->code != G_IO_ERROR_NOT_FOUND)
-		{
-			g_warning ("Document loading: query info error: %s", error->message);
-		}
-
-		g_error_free (error);
-		error = NULL;
+		return NULL;
 	}
 
-	if (info != NULL &&
-	    g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE))
-	{
-		const gchar *content_type;
-
-		content_type = g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
+	link = g_hash_table_lookup (content_types, location);
 
-		set_content_type (doc, content_type);
+	if (link == NULL)
+	{
+		return NULL;
 	}
 
-	g_clear_object (&info);
+	g_queue_unlink (&content_types_lru, link);
+	g_queue_push_head_link (&content_types_lru, link);
 
-	/* Async operation finished. */
-	g_object_unref (doc);
+	return ((CachedContentType *) link->data)->content_type;
 }
 
 static void
-gedit_document_loaded_real (GeditDocument *doc)
+cache_content_type (GeditDocument *doc)
 {
 	GeditDocumentPrivate *priv;
 	GFile *location;
+	CachedContentType *cached;
+	GList *link;
 
 	priv = gedit_document_get_instance_private (doc);
 
-	if (!priv->language_set_by_user)
+	location = gtk_source_file_get_location (priv->file);
+
+	if (location == NULL)
 	{
-		GtkSourceLanguage *language = guess_language (doc);
+		return;
+	}
 
-		gedit_debug_message (DEBUG_DOCUMENT, "Language: %s",
-				     language != NULL ? gtk_source_language_get_name (language) : "None");
+	if (content_types == NULL)
+	{
+		content_types = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+	}
 
-		set_language (doc, language, FALSE);
+	link = g_hash_table_lookup (content_types, location);
+
+	if (link != NULL)
+	{
+		cached = link->data;
+		g_free (cached->content_type);
+		cached->content_type = g_strdup (priv->content_type);
+
+		g_queue_unlink (&content_types_lru, link);
+		g_queue_push_head_link (&content_types_lru, link);
+		return;
 	}
 
-	g_get_current_time (&priv->time_of_last_save_or_load);
+	cached = g_slice_new (CachedContentType);
+	cached->location = g_object_ref (location);
+	cached->content_type = g_strdup (priv->content_type);
 
-	set_content_type (doc, NULL);
+	g_queue_push_head (&content_types_lru, cached);
+	g_hash_table_insert (content_types, cached->location, content_types_lru.head);
+
+	if (content_types_lru.length > MAX_CACHED_CONTENT_TYPES)
+	{
+		cached = g_queue_pop_tail (&content_types_lru);
+		g_hash_table_remove (content_types, cached->location);
+		cached_content_type_free (cached);
+	}
+}
+
+/* The content type and the language are chosen at the start of the
+ * loading, so that the text is highlighted as it is inserted and not
+ * once again at the end. The content type comes from the cache, else it
+ * is guessed from the file name until the tab sniffs the first bytes of
+ * the file, before the loader inserts any text.
+ */
+static void
+gedit_document_load_real (GeditDocument *doc)
+{
+	GeditDocumentPrivate *priv;
+	GFile *location;
+	const gchar *content_type = NULL;
+
+	priv = gedit_document_get_instance_private (doc);
+
+	priv->loading = TRUE;
+	priv->guess_content_type_when_loaded = FALSE;
 
 	location = gtk_source_file_get_location (priv->file);
 
 	if (location != NULL)
 	{
-		/* Keep the doc alive during the async operation. */
-		g_object_ref (doc);
+		content_type = lookup_cached_content_type (location);
+	}
+
+	priv->needs_content_type_sniffing = location != NULL && content_type == NULL;
+
+	set_content_type (doc, content_type);
+	update_language (doc);
+}
+
+static void
+gedit_document_loaded_real (GeditDocument *doc)
+{
+	GeditDocumentPrivate *priv;
+
+	priv = gedit_document_get_instance_private (doc);
 
-		g_file_query_info_async (location,
-					 G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
-					 G_FILE_ATTRIBUTE_ACCESS_CAN_WRITE,
-					 G_FILE_QUERY_INFO_NONE,
-					 G_PRIORITY_DEFAULT,
-					 NULL,
-					 (GAsyncReadyCallback) loaded_query_info_cb,
-					 doc);
+	priv->loading = FALSE;
+
+	if (priv->guess_content_type_when_loaded)
+	{
+		priv->guess_content_type_when_loaded = FALSE;
+
+		set_content_type (doc, NULL);
+		cache_content_type (doc);
 	}
+
+	g_get_current_time (&priv->time_of_last_save_or_load);
 }
 
 static void
@@ -1330,6 +1485,7 @@ saved_query_info_cb (GFile         *location,
 	}
 
 	set_content_type (doc, content_type);
+	cache_content_type (doc);
 
 	if (info != NULL)
 	{
@@ -1464,6 +1620,31 @@ _gedit_document_needs_saving (GeditDocument *doc)
 	return (externally_modified || deleted) && !priv->create;
 }
 
+/* For a large file, @line is the line in the file. Returns the line in the
+ * buffer, and whether @line exists.
+ */
+static gint
+get_buffer_line (GeditDocument *doc,
+		 gint           line,
+		 gboolean      *exists)
+{
+	GeditDocumentPrivate *priv;
+
+	priv = gedit_document_get_instance_private (doc);
+
+	if (priv->large_file == NULL || line < 0)
+	{
+		*exists = TRUE;
+		return line;
+	}
+
+	*exists = line < gedit_large_file_get_n_lines (priv->large_file);
+
+	return gedit_large_file_show_line (priv->large_file,
+					   GTK_TEXT_BUFFER (doc),
+					   line);
+}
+
 /* If @line is bigger than the lines of the document, the cursor is moved
  * to the last line and FALSE is returned.
  */
@@ -1472,19 +1653,23 @@ gedit_document_goto_line (GeditDocument *doc,
 			  gint           line)
 {
 	GtkTextIter iter;
+	gint buffer_line;
+	gboolean exists;
 
 	gedit_debug (DEBUG_DOCUMENT);
 
 	g_return_val_if_fail (GEDIT_IS_DOCUMENT (doc), FALSE);
 	g_return_val_if_fail (line >= -1, FALSE);
 
+	buffer_line = get_buffer_line (doc, line, &exists);
+
 	gtk_text_buffer_get_iter_at_line (GTK_TEXT_BUFFER (doc),
 					  &iter,
-					  line);
+					  buffer_line);
 
 	gtk_text_buffer_place_cursor (GTK_TEXT_BUFFER (doc), &iter);
 
-	return gtk_text_iter_get_line (&iter) == line;
+	return exists && gtk_text_iter_get_line (&iter) == buffer_line;
 }
 
 gboolean
@@ -1493,19 +1678,24 @@ gedit_document_goto_line_offset (GeditDocument *doc,
 				 gint           line_offset)
 {
 	GtkTextIter iter;
+	gint buffer_line;
+	gboolean exists;
 
 	g_return_val_if_fail (GEDIT_IS_DOCUMENT (doc), FALSE);
 	g_return_val_if_fail (line >= -1, FALSE);
 	g_return_val_if_fail (line_offset >= -1, FALSE);
 
+	buffer_line = get_buffer_line (doc, line, &exists);
+
 	gtk_text_buffer_get_iter_at_line_offset (GTK_TEXT_BUFFER (doc),
 						 &iter,
-						 line,
+						 buffer_line,
 						 line_offset);
 
 	gtk_text_buffer_place_cursor (GTK_TEXT_BUFFER (doc), &iter);
 
-	return (gtk_text_iter_get_line (&iter) == line &&
+	return (exists &&
+		gtk_text_iter_get_line (&iter) == buffer_line &&
 		gtk_text_iter_get_line_offset (&iter) == line_offset);
 }
 
@@ -1988,4 +2178,186 @@ _gedit_document_get_create (GeditDocument *doc)
 	return priv->create;
 }
 
+/* The large file whose window is in the buffer, if any */
+GeditLargeFile *
+_gedit_document_get_large_file (GeditDocument *doc)
+{
+	GeditDocumentPrivate *priv;
+
+	g_return_val_if_fail (GEDIT_IS_DOCUMENT (doc), NULL);
+
+	priv = gedit_document_get_instance_private (doc);
+
+	return priv->large_file;
+}
+
+void
+_gedit_document_set_large_file (GeditDocument  *doc,
+				GeditLargeFile *large_file)
+{
+	GeditDocumentPrivate *priv;
+
+	g_return_if_fail (GEDIT_IS_DOCUMENT (doc));
+	g_return_if_fail (large_file == NULL || GEDIT_IS_LARGE_FILE (large_file));
+
+	priv = gedit_document_get_instance_private (doc);
+
+	g_set_object (&priv->large_file, large_file);
+}
+
+gboolean
+_gedit_document_get_loading_deferred (GeditDocument *doc)
+{
+	GeditDocumentPrivate *priv;
+
+	g_return_val_if_fail (GEDIT_IS_DOCUMENT (doc), FALSE);
+
+	priv = gedit_document_get_instance_private (doc);
+
+	return priv->loading_deferred;
+}
+
+/* Called when the loading ends, whether the "loaded" signal is emitted or
+ * not: it is only emitted after a successful loading.
+ */
+void
+_gedit_document_set_loading_done (GeditDocument *doc)
+{
+	GeditDocumentPrivate *priv;
+
+	g_return_if_fail (GEDIT_IS_DOCUMENT (doc));
+
+	priv = gedit_document_get_instance_private (doc);
+
+	priv->loading = FALSE;
+	priv->needs_content_type_sniffing = FALSE;
+}
+
+/* Whether the tab has to give the first bytes of the file being loaded to
+ * _gedit_document_set_content_type_from_data() before the loader starts.
+ */
+gboolean
+_gedit_document_get_needs_content_type_sniffing (GeditDocument *doc)
+{
+	GeditDocumentPrivate *priv;
+
+	g_return_val_if_fail (GEDIT_IS_DOCUMENT (doc), FALSE);
+
+	priv = gedit_document_get_instance_private (doc);
+
+	return priv->loading && priv->needs_content_type_sniffing;
+}
+
+/* The text of a compressed file is only in the buffer at the end of the
+ * loading, so its first bytes are uncompressed here to guess from.
+ */
+static gchar *
+guess_compressed_content_type (const gchar  *basename,
+			       const guchar *data,
+			       gsize         size)
+{
+	GConverter *decompressor;
+	GConverterResult result;
+	guchar *uncompressed;
+	gsize bytes_read;
+	gsize bytes_written = 0;
+	gchar *name;
+	const gchar *extension;
+	gchar *content_type = NULL;
+
+	decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+	uncompressed = g_malloc (UNCOMPRESSED_SNIFF_SIZE);
+
+	result = g_converter_convert (decompressor,
+				      data,
+				      size,
+				      uncompressed,
+				      UNCOMPRESSED_SNIFF_SIZE,
+				      G_CONVERTER_NO_FLAGS,
+				      &bytes_read,
+				      &bytes_written,
+				      NULL);
+
+	if (result != G_CONVERTER_ERROR && bytes_written > 0)
+	{
+		/* Without the extension of the compression */
+		extension = strrchr (basename, '.');
+		name = extension != NULL ? g_strndup (basename, extension - basename) : g_strdup (basename);
+
+		content_type = g_content_type_guess (name, uncompressed, bytes_written, NULL);
+
+		g_free (name);
+	}
+
+	g_free (uncompressed);
+	g_object_unref (decompressor);
+
+	return content_type;
+}
+
+/* Sets the content type of the file being loaded from its first bytes,
+ * before any text is inserted, and caches it with its location.
+ */
+void
+_gedit_document_set_content_type_from_data (GeditDocument *doc,
+					    const guchar  *data,
+					    gsize          size)
+{
+	GeditDocumentPrivate *priv;
+	GFile *location;
+	gchar *basename;
+	gchar *content_type;
+
+	g_return_if_fail (GEDIT_IS_DOCUMENT (doc));
+
+	priv = gedit_document_get_instance_private (doc);
+
+	priv->needs_content_type_sniffing = FALSE;
+
+	location = gtk_source_file_get_location (priv->file);
+	g_return_if_fail (location != NULL);
+
+	basename = g_file_get_basename (location);
+	content_type = g_content_type_guess (basename, data, size, NULL);
+
+	if (gedit_utils_get_compression_type_from_content_type (content_type) !=
+	    GTK_SOURCE_COMPRESSION_TYPE_NONE)
+	{
+		gchar *uncompressed_type;
+
+		uncompressed_type = guess_compressed_content_type (basename, data, size);
+
+		if (uncompressed_type == NULL)
+		{
+			priv->guess_content_type_when_loaded = TRUE;
+
+			g_free (content_type);
+			g_free (basename);
+			return;
+		}
+
+		g_free (content_type);
+		content_type = uncompressed_type;
+	}
+
+	set_content_type (doc, content_type);
+	cache_content_type (doc);
+
+	g_free (content_type);
+	g_free (basename);
+}
+
+void
+_gedit_document_set_loading_deferred (GeditDocument *doc,
+				      gboolean       loading_deferred)
+{
+	GeditDocumentPrivate *priv;
+
+	g_return_if_fail (GEDIT_IS_DOCUMENT (doc));
+
+	priv = gedit_document_get_instance_private (doc);
+
+	priv->loading_deferred = loading_deferred != FALSE;
+}
+
 /* ex:set ts=8 noet: */
@@ -1274,4 +1274,90 @@ gedit_invalid_character_info_bar_new (GFile *location)
 	return info_bar;
 }
 
+GtkWidget *
+gedit_large_file_info_bar_new (GFile *location)
+{
+	gchar *full_formatted_uri;
+	gchar *uri_for_display;
+	gchar *temp_uri_for_display;
+	gchar *primary_text;
+	const gchar *secondary_text;
+	GtkWidget *info_bar;
+
+	g_return_val_if_fail (G_IS_FILE (location), NULL);
+
+	full_formatted_uri = g_file_get_parse_name (location);
+
+	temp_uri_for_display = gedit_utils_str_middle_truncate (full_formatted_uri,
+								MAX_URI_IN_DIALOG_LENGTH);
+	g_free (full_formatted_uri);
+
+	uri_for_display = g_markup_escape_text (temp_uri_for_display, -1);
+	g_free (temp_uri_for_display);
+
+	primary_text = g_strdup_printf (_("The file “%s” is too large to be edited."),
+					uri_for_display);
+	g_free (uri_for_display);
+
+	secondary_text = _("It is shown read-only, one part at a time. Scroll, "
+			   "search or go to a line to show the other parts.");
+
+	info_bar = gtk_info_bar_new ();
+
+	gtk_info_bar_set_show_close_button (GTK_INFO_BAR (info_bar), TRUE);
+	gtk_info_bar_set_message_type (GTK_INFO_BAR (info_bar),
+				       GTK_MESSAGE_INFO);
+
+	set_info_bar_text (info_bar,
+			   primary_text,
+			   secondary_text);
+
+	g_free (primary_text);
+
+	return info_bar;
+}
+
+GtkWidget *
+gedit_large_file_saving_error_info_bar_new (GFile *location)
+{
+	gchar *full_formatted_uri;
+	gchar *uri_for_display;
+	gchar *temp_uri_for_display;
+	gchar *primary_text;
+	const gchar *secondary_text;
+	GtkWidget *info_bar;
+
+	g_return_val_if_fail (G_IS_FILE (location), NULL);
+
+	full_formatted_uri = g_file_get_parse_name (location);
+
+	temp_uri_for_display = gedit_utils_str_middle_truncate (full_formatted_uri,
+								MAX_URI_IN_DIALOG_LENGTH);
+	g_free (full_formatted_uri);
+
+	uri_for_display = g_markup_escape_text (temp_uri_for_display, -1);
+	g_free (temp_uri_for_display);
+
+	primary_text = g_strdup_printf (_("Could not save the file “%s”."),
+					uri_for_display);
+	g_free (uri_for_display);
+
+	secondary_text = _("The file is too large to be edited: only the part "
+			   "shown is loaded, saving it would truncate the file.");
+
+	info_bar = gtk_info_bar_new ();
+
+	gtk_info_bar_set_show_close_button (GTK_INFO_BAR (info_bar), TRUE);
+	gtk_info_bar_set_message_type (GTK_INFO_BAR (info_bar),
+				       GTK_MESSAGE_WARNING);
+
+	set_info_bar_text (info_bar,
+			   primary_text,
+			   secondary_text);
+
+	g_free (primary_text);
+
+	return info_bar;
+}
+
 /* ex:set ts=8 noet: */
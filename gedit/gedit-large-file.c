@@ -0,0 +1,719 @@
+/*
+ * gedit-large-file.c
+ * This file is part of gedit
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * gedit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gedit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gedit. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* A #GeditLargeFile gives access to a file too large to be loaded in a
+ * GtkTextBuffer. The file is mapped in memory and the offsets of its lines
+ * are indexed in a thread. Only a window of consecutive lines is then put
+ * in the buffer, and moved when other lines need to be shown.
+ *
+ * The file is expected to be UTF-8, invalid bytes are shown as U+FFFD.
+ */
+
+#include "gedit-large-file.h"
+
+#include <string.h>
+#include <glib/gi18n.h>
+#include <gtksourceview/gtksource.h>
+
+#include "gedit-debug.h"
+
+/* One line offset out of this many is stored in the index, the others
+ * are found by looking for the newlines from the closest indexed line.
+ */
+#define INDEX_STRIDE 1024
+
+/* Maximum size of the window put in the buffer */
+#define WINDOW_LINES 20000
+#define WINDOW_MAX_BYTES (16 * 1024 * 1024)
+
+/* Bytes scanned between two checks of the cancellable */
+#define CANCEL_CHECK_BYTES (16 * 1024 * 1024)
+
+/* The replacement character, for invalid UTF-8 */
+#define REPLACEMENT_CHAR "\357\277\275"
+
+struct _GeditLargeFile
+{
+	GObject parent_instance;
+
+	GFile *location;
+	GMappedFile *mapped_file;
+
+	/* Offset of every INDEX_STRIDE line */
+	GArray *line_index;
+	gint64 n_lines;
+
+	/* The lines currently in the buffer */
+	gint64 first_line;
+	gint n_window_lines;
+};
+
+typedef struct
+{
+	GMappedFile *mapped_file;
+	GArray *line_index;
+	gint64 n_lines;
+} OpenData;
+
+typedef struct
+{
+	GMappedFile *mapped_file;
+	gchar *text;
+	gsize offset;
+	gint64 line;
+	guint case_sensitive : 1;
+} FindData;
+
+G_DEFINE_TYPE (GeditLargeFile, gedit_large_file, G_TYPE_OBJECT)
+
+static void
+open_data_free (OpenData *data)
+{
+	if (data->mapped_file != NULL)
+	{
+		g_mapped_file_unref (data->mapped_file);
+	}
+
+	if (data->line_index != NULL)
+	{
+		g_array_unref (data->line_index);
+	}
+
+	g_slice_free (OpenData, data);
+}
+
+static void
+find_data_free (FindData *data)
+{
+	g_mapped_file_unref (data->mapped_file);
+	g_free (data->text);
+	g_slice_free (FindData, data);
+}
+
+static void
+gedit_large_file_finalize (GObject *object)
+{
+	GeditLargeFile *large_file = GEDIT_LARGE_FILE (object);
+
+	g_object_unref (large_file->location);
+
+	if (large_file->mapped_file != NULL)
+	{
+		g_mapped_file_unref (large_file->mapped_file);
+	}
+
+	if (large_file->line_index != NULL)
+	{
+		g_array_unref (large_file->line_index);
+	}
+
+	G_OBJECT_CLASS (gedit_large_file_parent_class)->finalize (object);
+}
+
+static void
+gedit_large_file_class_init (GeditLargeFileClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->finalize = gedit_large_file_finalize;
+}
+
+static void
+gedit_large_file_init (GeditLargeFile *large_file)
+{
+}
+
+GeditLargeFile *
+gedit_large_file_new (GFile *location)
+{
+	GeditLargeFile *large_file;
+
+	g_return_val_if_fail (G_IS_FILE (location), NULL);
+
+	large_file = g_object_new (GEDIT_TYPE_LARGE_FILE, NULL);
+	large_file->location = g_object_ref (location);
+
+	return large_file;
+}
+
+/**
+ * gedit_large_file_get_location:
+ * @large_file: a #GeditLargeFile.
+ *
+ * Returns: (transfer none): the location of the file.
+ */
+GFile *
+gedit_large_file_get_location (GeditLargeFile *large_file)
+{
+	g_return_val_if_fail (GEDIT_IS_LARGE_FILE (large_file), NULL);
+
+	return large_file->location;
+}
+
+static void
+open_thread (GTask        *task,
+	     gpointer      source_object,
+	     gpointer      task_data G_GNUC_UNUSED,
+	     GCancellable *cancellable G_GNUC_UNUSED)
+{
+	GeditLargeFile *large_file = source_object;
+	OpenData *data;
+	gchar *path;
+	const gchar *contents;
+	const gchar *end;
+	const gchar *p;
+	const gchar *next_check;
+	guint64 first_offset = 0;
+	GError *error = NULL;
+
+	path = g_file_get_path (large_file->location);
+	if (path == NULL)
+	{
+		g_task_return_new_error (task,
+					 G_IO_ERROR,
+					 G_IO_ERROR_NOT_SUPPORTED,
+					 _("Only local files can be opened in large file mode."));
+		return;
+	}
+
+	data = g_slice_new0 (OpenData);
+	data->mapped_file = g_mapped_file_new (path, FALSE, &error);
+	g_free (path);
+
+	if (data->mapped_file == NULL)
+	{
+		open_data_free (data);
+		g_task_return_error (task, error);
+		return;
+	}
+
+	data->line_index = g_array_new (FALSE, FALSE, sizeof (guint64));
+	data->n_lines = 1;
+	g_array_append_val (data->line_index, first_offset);
+
+	contents = g_mapped_file_get_contents (data->mapped_file);
+	end = contents + g_mapped_file_get_length (data->mapped_file);
+	p = contents;
+	next_check = p + CANCEL_CHECK_BYTES;
+
+	while (p < end)
+	{
+		const gchar *newline;
+
+		newline = memchr (p, '\n', end - p);
+		if (newline == NULL)
+		{
+			break;
+		}
+
+		p = newline + 1;
+
+		/* data->n_lines is the number of the line starting at p */
+		if (data->n_lines % INDEX_STRIDE == 0)
+		{
+			guint64 offset = p - contents;
+
+			g_array_append_val (data->line_index, offset);
+		}
+
+		data->n_lines++;
+
+		if (p >= next_check)
+		{
+			if (g_task_return_error_if_cancelled (task))
+			{
+				open_data_free (data);
+				return;
+			}
+
+			next_check = p + CANCEL_CHECK_BYTES;
+		}
+	}
+
+	g_task_return_pointer (task, data, (GDestroyNotify) open_data_free);
+}
+
+void
+gedit_large_file_open_async (GeditLargeFile      *large_file,
+			     GCancellable        *cancellable,
+			     GAsyncReadyCallback  callback,
+			     gpointer             user_data)
+{
+	GTask *task;
+
+	g_return_if_fail (GEDIT_IS_LARGE_FILE (large_file));
+	g_return_if_fail (large_file->mapped_file == NULL);
+
+	task = g_task_new (large_file, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gedit_large_file_open_async);
+	g_task_run_in_thread (task, open_thread);
+	g_object_unref (task);
+}
+
+gboolean
+gedit_large_file_open_finish (GeditLargeFile  *large_file,
+			      GAsyncResult    *result,
+			      GError         **error)
+{
+	OpenData *data;
+
+	g_return_val_if_fail (GEDIT_IS_LARGE_FILE (large_file), FALSE);
+	g_return_val_if_fail (g_task_is_valid (result, large_file), FALSE);
+
+	data = g_task_propagate_pointer (G_TASK (result), error);
+	if (data == NULL)
+	{
+		return FALSE;
+	}
+
+	large_file->mapped_file = g_steal_pointer (&data->mapped_file);
+	large_file->line_index = g_steal_pointer (&data->line_index);
+	large_file->n_lines = data->n_lines;
+	open_data_free (data);
+
+	gedit_debug_message (DEBUG_DOCUMENT,
+			     "Large file indexed: %" G_GINT64_FORMAT " lines",
+			     large_file->n_lines);
+
+	return TRUE;
+}
+
+gint64
+gedit_large_file_get_n_lines (GeditLargeFile *large_file)
+{
+	g_return_val_if_fail (GEDIT_IS_LARGE_FILE (large_file), 0);
+
+	return large_file->n_lines;
+}
+
+/* Returns the number in the file of the first line of the buffer */
+gint64
+gedit_large_file_get_first_line (GeditLargeFile *large_file)
+{
+	g_return_val_if_fail (GEDIT_IS_LARGE_FILE (large_file), 0);
+
+	return large_file->first_line;
+}
+
+gint
+gedit_large_file_get_n_window_lines (GeditLargeFile *large_file)
+{
+	g_return_val_if_fail (GEDIT_IS_LARGE_FILE (large_file), 0);
+
+	return large_file->n_window_lines;
+}
+
+static gsize
+get_line_offset (GeditLargeFile *large_file,
+		 gint64          line)
+{
+	const gchar *contents;
+	gsize length;
+	gsize offset;
+	gint64 n;
+
+	contents = g_mapped_file_get_contents (large_file->mapped_file);
+	length = g_mapped_file_get_length (large_file->mapped_file);
+
+	offset = g_array_index (large_file->line_index, guint64, line / INDEX_STRIDE);
+
+	for (n = line % INDEX_STRIDE; n > 0; n--)
+	{
+		const gchar *newline;
+
+		newline = memchr (contents + offset, '\n', length - offset);
+		g_return_val_if_fail (newline != NULL, length);
+
+		offset = newline - contents + 1;
+	}
+
+	return offset;
+}
+
+static gchar *
+make_valid_utf8 (const gchar *text,
+		 gsize        length)
+{
+	GString *string = NULL;
+	const gchar *remainder = text;
+	gsize remaining = length;
+	const gchar *invalid;
+
+	if (length == 0)
+	{
+		return g_strdup ("");
+	}
+
+	/* Nul bytes are not valid here, so they are replaced too */
+	while (!g_utf8_validate (remainder, remaining, &invalid))
+	{
+		if (string == NULL)
+		{
+			string = g_string_sized_new (length + 16);
+		}
+
+		g_string_append_len (string, remainder, invalid - remainder);
+		g_string_append (string, REPLACEMENT_CHAR);
+
+		remaining -= invalid - remainder + 1;
+		remainder = invalid + 1;
+	}
+
+	if (string == NULL)
+	{
+		return g_strndup (text, length);
+	}
+
+	g_string_append_len (string, remainder, remaining);
+	return g_string_free (string, FALSE);
+}
+
+static gchar *
+get_window_text (GeditLargeFile *large_file,
+		 gint64          first_line,
+		 gint           *n_window_lines)
+{
+	const gchar *contents;
+	gsize length;
+	gsize start;
+	gsize end;
+	gint n = 0;
+
+	contents = g_mapped_file_get_contents (large_file->mapped_file);
+	length = g_mapped_file_get_length (large_file->mapped_file);
+
+	start = get_line_offset (large_file, first_line);
+	end = start;
+
+	while (n < WINDOW_LINES && end < length && end - start < WINDOW_MAX_BYTES)
+	{
+		const gchar *newline;
+
+		newline = memchr (contents + end, '\n', length - end);
+		end = newline != NULL ? (gsize)(newline - contents + 1) : length;
+		n++;
+	}
+
+	if (end == length)
+	{
+		/* The window goes to the end of the file, including the
+		 * empty line after a trailing newline.
+		 */
+		*n_window_lines = large_file->n_lines - first_line;
+	}
+	else
+	{
+		/* A single line longer than the window is cut */
+		end = MIN (end, start + WINDOW_MAX_BYTES);
+
+		if (contents[end - 1] == '\n')
+		{
+			end--;
+		}
+
+		*n_window_lines = n;
+	}
+
+	return make_valid_utf8 (contents + start, end - start);
+}
+
+static void
+load_window (GeditLargeFile *large_file,
+	     GtkTextBuffer  *buffer,
+	     gint64          first_line)
+{
+	gchar *text;
+	gint n_window_lines;
+
+	gedit_debug_message (DEBUG_DOCUMENT,
+			     "Large file window at line %" G_GINT64_FORMAT,
+			     first_line);
+
+	text = get_window_text (large_file, first_line, &n_window_lines);
+
+	/* Set before the text, for the handlers of the cursor moves */
+	large_file->first_line = first_line;
+	large_file->n_window_lines = n_window_lines;
+
+	gtk_source_buffer_begin_not_undoable_action (GTK_SOURCE_BUFFER (buffer));
+	gtk_text_buffer_set_text (buffer, text, -1);
+	gtk_source_buffer_end_not_undoable_action (GTK_SOURCE_BUFFER (buffer));
+
+	gtk_text_buffer_set_modified (buffer, FALSE);
+
+	g_free (text);
+}
+
+/**
+ * gedit_large_file_show_line:
+ * @large_file: an opened #GeditLargeFile.
+ * @buffer: the buffer showing @large_file.
+ * @line: a line number in the file.
+ *
+ * Moves the window if @line is not in it. Lines after the end of the
+ * file are taken as the last line.
+ *
+ * Returns: the line number of @line in @buffer.
+ */
+gint
+gedit_large_file_show_line (GeditLargeFile *large_file,
+			    GtkTextBuffer  *buffer,
+			    gint64          line)
+{
+	g_return_val_if_fail (GEDIT_IS_LARGE_FILE (large_file), 0);
+	g_return_val_if_fail (large_file->mapped_file != NULL, 0);
+	g_return_val_if_fail (GTK_SOURCE_IS_BUFFER (buffer), 0);
+
+	line = CLAMP (line, 0, large_file->n_lines - 1);
+
+	if (large_file->n_window_lines == 0 ||
+	    line < large_file->first_line ||
+	    line >= large_file->first_line + large_file->n_window_lines)
+	{
+		/* Leave some lines before, to scroll up */
+		load_window (large_file, buffer, MAX (0, line - WINDOW_LINES / 4));
+
+		/* In case of very long lines */
+		if (line >= large_file->first_line + large_file->n_window_lines)
+		{
+			load_window (large_file, buffer, line);
+		}
+	}
+
+	return line - large_file->first_line;
+}
+
+/**
+ * gedit_large_file_set_first_line:
+ * @large_file: an opened #GeditLargeFile.
+ * @buffer: the buffer showing @large_file.
+ * @first_line: a line number in the file.
+ *
+ * Moves the window to start at @first_line.
+ */
+void
+gedit_large_file_set_first_line (GeditLargeFile *large_file,
+				 GtkTextBuffer  *buffer,
+				 gint64          first_line)
+{
+	g_return_if_fail (GEDIT_IS_LARGE_FILE (large_file));
+	g_return_if_fail (large_file->mapped_file != NULL);
+	g_return_if_fail (GTK_SOURCE_IS_BUFFER (buffer));
+
+	first_line = CLAMP (first_line, 0, large_file->n_lines - 1);
+
+	if (large_file->n_window_lines == 0 ||
+	    first_line != large_file->first_line)
+	{
+		load_window (large_file, buffer, first_line);
+	}
+}
+
+static const gchar *
+find_text (const gchar *haystack,
+	   gsize        haystack_length,
+	   const gchar *needle,
+	   gsize        needle_length,
+	   gboolean     case_sensitive)
+{
+	const gchar *p = haystack;
+	const gchar *last;
+	gchar first;
+
+	if (needle_length > haystack_length)
+	{
+		return NULL;
+	}
+
+	last = haystack + haystack_length - needle_length;
+
+	if (case_sensitive)
+	{
+		first = needle[0];
+
+		while (p <= last &&
+		       (p = memchr (p, first, last - p + 1)) != NULL)
+		{
+			if (memcmp (p, needle, needle_length) == 0)
+			{
+				return p;
+			}
+
+			p++;
+		}
+
+		return NULL;
+	}
+
+	first = g_ascii_tolower (needle[0]);
+
+	for (; p <= last; p++)
+	{
+		if (g_ascii_tolower (*p) == first &&
+		    g_ascii_strncasecmp (p, needle, needle_length) == 0)
+		{
+			return p;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+find_thread (GTask        *task,
+	     gpointer      source_object G_GNUC_UNUSED,
+	     gpointer      task_data,
+	     GCancellable *cancellable G_GNUC_UNUSED)
+{
+	FindData *data = task_data;
+	const gchar *contents;
+	gsize length;
+	gsize text_length;
+	gsize offset;
+	const gchar *match = NULL;
+	gint64 *line;
+	const gchar *p;
+
+	contents = g_mapped_file_get_contents (data->mapped_file);
+	length = g_mapped_file_get_length (data->mapped_file);
+	text_length = strlen (data->text);
+
+	/* The file is searched in slices, for the cancellation, which
+	 * overlap so that matches across two slices are not missed.
+	 */
+	for (offset = data->offset; offset < length; offset += CANCEL_CHECK_BYTES)
+	{
+		gsize slice_length;
+
+		if (g_task_return_error_if_cancelled (task))
+		{
+			return;
+		}
+
+		slice_length = MIN (length - offset, CANCEL_CHECK_BYTES + text_length - 1);
+
+		match = find_text (contents + offset,
+				   slice_length,
+				   data->text,
+				   text_length,
+				   data->case_sensitive);
+
+		if (match != NULL)
+		{
+			break;
+		}
+	}
+
+	line = g_new (gint64, 1);
+	*line = -1;
+
+	if (match != NULL)
+	{
+		*line = data->line;
+
+		for (p = contents + data->offset;
+		     (p = memchr (p, '\n', match - p)) != NULL;
+		     p++)
+		{
+			(*line)++;
+		}
+	}
+
+	g_task_return_pointer (task, line, g_free);
+}
+
+/**
+ * gedit_large_file_find_async:
+ * @large_file: an opened #GeditLargeFile.
+ * @text: the text to find.
+ * @case_sensitive: whether the case matters, only ASCII letters are
+ *   compared without case.
+ * @from_line: the line number in the file where to start.
+ * @cancellable: (nullable): a #GCancellable.
+ * @callback: the callback.
+ * @user_data: the data for @callback.
+ *
+ * Finds the first line from @from_line containing @text, in a thread.
+ */
+void
+gedit_large_file_find_async (GeditLargeFile      *large_file,
+			     const gchar         *text,
+			     gboolean             case_sensitive,
+			     gint64               from_line,
+			     GCancellable        *cancellable,
+			     GAsyncReadyCallback  callback,
+			     gpointer             user_data)
+{
+	GTask *task;
+	FindData *data;
+
+	g_return_if_fail (GEDIT_IS_LARGE_FILE (large_file));
+	g_return_if_fail (large_file->mapped_file != NULL);
+	g_return_if_fail (text != NULL && text[0] != '\0');
+
+	task = g_task_new (large_file, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gedit_large_file_find_async);
+
+	data = g_slice_new0 (FindData);
+	data->mapped_file = g_mapped_file_ref (large_file->mapped_file);
+	data->text = g_strdup (text);
+	data->case_sensitive = case_sensitive != FALSE;
+
+	if (from_line < large_file->n_lines)
+	{
+		data->line = MAX (from_line, 0);
+		data->offset = get_line_offset (large_file, data->line);
+	}
+	else
+	{
+		data->line = large_file->n_lines;
+		data->offset = g_mapped_file_get_length (large_file->mapped_file);
+	}
+
+	g_task_set_task_data (task, data, (GDestroyNotify) find_data_free);
+	g_task_run_in_thread (task, find_thread);
+	g_object_unref (task);
+}
+
+/* Returns the line number of the match, or -1 if there is none */
+gint64
+gedit_large_file_find_finish (GeditLargeFile  *large_file,
+			      GAsyncResult    *result,
+			      GError         **error)
+{
+	gint64 *line;
+	gint64 ret;
+
+	g_return_val_if_fail (GEDIT_IS_LARGE_FILE (large_file), -1);
+	g_return_val_if_fail (g_task_is_valid (result, large_file), -1);
+
+	line = g_task_propagate_pointer (G_TASK (result), error);
+	if (line == NULL)
+	{
+		return -1;
+	}
+
+	ret = *line;
+	g_free (line);
+
+	return ret;
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,75 @@
+/*
+ * gedit-large-file.h
+ * This file is part of gedit
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * gedit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gedit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gedit. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GEDIT_LARGE_FILE_H
+#define GEDIT_LARGE_FILE_H
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+#define GEDIT_TYPE_LARGE_FILE (gedit_large_file_get_type ())
+
+G_DECLARE_FINAL_TYPE (GeditLargeFile, gedit_large_file, GEDIT, LARGE_FILE, GObject)
+
+GeditLargeFile	*gedit_large_file_new			(GFile                *location);
+
+GFile		*gedit_large_file_get_location		(GeditLargeFile       *large_file);
+
+void		 gedit_large_file_open_async		(GeditLargeFile       *large_file,
+							 GCancellable         *cancellable,
+							 GAsyncReadyCallback   callback,
+							 gpointer              user_data);
+
+gboolean	 gedit_large_file_open_finish		(GeditLargeFile       *large_file,
+							 GAsyncResult         *result,
+							 GError              **error);
+
+gint64		 gedit_large_file_get_n_lines		(GeditLargeFile       *large_file);
+
+gint64		 gedit_large_file_get_first_line	(GeditLargeFile       *large_file);
+
+gint		 gedit_large_file_get_n_window_lines	(GeditLargeFile       *large_file);
+
+gint		 gedit_large_file_show_line		(GeditLargeFile       *large_file,
+							 GtkTextBuffer        *buffer,
+							 gint64                line);
+
+void		 gedit_large_file_set_first_line	(GeditLargeFile       *large_file,
+							 GtkTextBuffer        *buffer,
+							 gint64                first_line);
+
+void		 gedit_large_file_find_async		(GeditLargeFile       *large_file,
+							 const gchar          *text,
+							 gboolean              case_sensitive,
+							 gint64                from_line,
+							 GCancellable         *cancellable,
+							 GAsyncReadyCallback   callback,
+							 gpointer              user_data);
+
+gint64		 gedit_large_file_find_finish		(GeditLargeFile       *large_file,
+							 GAsyncResult         *result,
+							 GError              **error);
+
+G_END_DECLS
+
+#endif /* GEDIT_LARGE_FILE_H */
+
+/* ex:set ts=8 noet: */
@@ -20,25 +20,62 @@
  */
 
 #include "gedit-metadata-manager.h"
+#include <string.h>
 #include <libxml/xmlreader.h>
 #include "gedit-debug.h"
+#include "gedit-settings.h"
 
 /*
 #define GEDIT_METADATA_VERBOSE_DEBUG	1
 */
 
-#define MAX_ITEMS 50
+/* The metadata file is a log of records: a snapshot of all the items, written
+ * when the file is compacted, followed by the changes appended since then.
+ * After an 8 bytes header, each record is a little-endian guint32 length, a
+ * record type byte and the record fields. Strings are stored as a guint32
+ * length followed by the bytes, without the trailing nul.
+ */
+#define METADATA_MAGIC		"GEDITMD"
+#define METADATA_VERSION	1
+#define METADATA_HEADER_SIZE	8
+
+/* The log is compacted when it grows past twice the size of the last
+ * snapshot, but never while it is smaller than this.
+ */
+#define COMPACT_MIN_SIZE	(64 * 1024)
+
+/* The metadata file used by older gedit versions, imported on first use. */
+#define LEGACY_METADATA_FILENAME	"gedit-metadata.xml"
+
+typedef enum
+{
+	RECORD_TOUCH = 'T',
+	RECORD_SET = 'S',
+	RECORD_UNSET = 'U',
+	RECORD_REMOVE = 'R'
+} RecordType;
 
 typedef struct _GeditMetadataManager GeditMetadataManager;
 
 typedef struct _Item Item;
 
+typedef struct _RecordReader RecordReader;
+
 struct _Item
 {
+	/* Also the key of the item in the items hash table. */
+	gchar		*uri;
+
 	/* Time of last access in seconds since January 1, 1970 UTC. */
 	gint64	 	 atime;
 
+	/* The access time changed since it was last written to the log. */
+	guint		 atime_dirty : 1;
+
 	GHashTable	*values;
+
+	/* Link in the LRU queue, its data is the item itself. */
+	GList		 lru_link;
 };
 
 struct _GeditMetadataManager
@@ -50,7 +87,32 @@ struct _GeditMetadataManager
 
 	GHashTable	*items;
 
+	/* The items sorted by access time, the most recent at the head. */
+	GQueue		 lru;
+
+	/* Maximum number of items, the least recently used ones are evicted. */
+	guint		 max_items;
+
+	GSettings	*settings;
+
 	gchar		*metadata_filename;
+
+	/* Records not yet appended to the file. */
+	GString		*pending;
+
+	/* Current size of the file, and its size after the last compaction. */
+	gsize		 log_size;
+	gsize		 compacted_size;
+
+	/* The file must be rewritten from scratch on the next save. */
+	guint		 needs_compaction : 1;
+};
+
+struct _RecordReader
+{
+	const gchar	*data;
+	gsize		 len;
+	gsize		 pos;
 };
 
 static gboolean gedit_metadata_manager_save (gpointer data);
@@ -70,12 +132,306 @@ item_free (gpointer data)
 
 	item = (Item *)data;
 
+	g_queue_unlink (&gedit_metadata_manager->lru, &item->lru_link);
+
 	if (item->values != NULL)
 		g_hash_table_destroy (item->values);
 
+	g_free (item->uri);
 	g_free (item);
 }
 
+static Item *
+item_new (const gchar *uri)
+{
+	Item *item;
+
+	item = g_new0 (Item, 1);
+	item->uri = g_strdup (uri);
+	item->lru_link.data = item;
+
+	g_queue_push_head_link (&gedit_metadata_manager->lru, &item->lru_link);
+	g_hash_table_insert (gedit_metadata_manager->items, item->uri, item);
+
+	return item;
+}
+
+/* Marks the item as the most recently used one. */
+static void
+touch_item (Item   *item,
+	    gint64  atime)
+{
+	item->atime = atime;
+
+	g_queue_unlink (&gedit_metadata_manager->lru, &item->lru_link);
+	g_queue_push_head_link (&gedit_metadata_manager->lru, &item->lru_link);
+}
+
+static Item *
+get_or_create_item (const gchar *uri)
+{
+	Item *item;
+
+	item = g_hash_table_lookup (gedit_metadata_manager->items, uri);
+
+	if (item == NULL)
+	{
+		item = item_new (uri);
+	}
+
+	if (item->values == NULL)
+	{
+		item->values = g_hash_table_new_full (g_str_hash,
+						      g_str_equal,
+						      g_free,
+						      g_free);
+	}
+
+	return item;
+}
+
+static void
+append_uint32 (GString *buffer,
+	       guint32  value)
+{
+	value = GUINT32_TO_LE (value);
+	g_string_append_len (buffer, (const gchar *)&value, sizeof (value));
+}
+
+static void
+append_int64 (GString *buffer,
+	      gint64   value)
+{
+	value = GINT64_TO_LE (value);
+	g_string_append_len (buffer, (const gchar *)&value, sizeof (value));
+}
+
+static void
+append_string (GString     *buffer,
+	       const gchar *str)
+{
+	gsize len = strlen (str);
+
+	append_uint32 (buffer, len);
+	g_string_append_len (buffer, str, len);
+}
+
+/* Returns the offset of the record, to be passed to end_record() once all
+ * the fields have been appended.
+ */
+static gsize
+begin_record (GString    *buffer,
+	      RecordType  type)
+{
+	gsize start = buffer->len;
+
+	append_uint32 (buffer, 0);
+	g_string_append_c (buffer, (gchar)type);
+
+	return start;
+}
+
+static void
+end_record (GString *buffer,
+	    gsize    start)
+{
+	guint32 len;
+
+	len = GUINT32_TO_LE (buffer->len - start - sizeof (guint32));
+	memcpy (buffer->str + start, &len, sizeof (len));
+}
+
+static void
+write_touch_record (GString    *buffer,
+		    const Item *item)
+{
+	gsize start;
+
+	start = begin_record (buffer, RECORD_TOUCH);
+	append_string (buffer, item->uri);
+	append_int64 (buffer, item->atime);
+	end_record (buffer, start);
+}
+
+static void
+write_value_record (GString     *buffer,
+		    const Item  *item,
+		    const gchar *key,
+		    const gchar *value)
+{
+	gsize start;
+
+	start = begin_record (buffer, value != NULL ? RECORD_SET : RECORD_UNSET);
+	append_string (buffer, item->uri);
+	append_int64 (buffer, item->atime);
+	append_string (buffer, key);
+
+	if (value != NULL)
+	{
+		append_string (buffer, value);
+	}
+
+	end_record (buffer, start);
+}
+
+static void
+write_remove_record (GString     *buffer,
+		     const gchar *uri)
+{
+	gsize start;
+
+	start = begin_record (buffer, RECORD_REMOVE);
+	append_string (buffer, uri);
+	end_record (buffer, start);
+}
+
+static void
+write_item (GString    *buffer,
+	    const Item *item)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	write_touch_record (buffer, item);
+
+	g_hash_table_iter_init (&iter, item->values);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		write_value_record (buffer, item, key, value);
+	}
+}
+
+static gboolean
+read_uint32 (RecordReader *reader,
+	     guint32      *value)
+{
+	if (reader->len - reader->pos < sizeof (guint32))
+	{
+		return FALSE;
+	}
+
+	memcpy (value, reader->data + reader->pos, sizeof (guint32));
+	*value = GUINT32_FROM_LE (*value);
+	reader->pos += sizeof (guint32);
+
+	return TRUE;
+}
+
+static gboolean
+read_int64 (RecordReader *reader,
+	    gint64       *value)
+{
+	if (reader->len - reader->pos < sizeof (gint64))
+	{
+		return FALSE;
+	}
+
+	memcpy (value, reader->data + reader->pos, sizeof (gint64));
+	*value = GINT64_FROM_LE (*value);
+	reader->pos += sizeof (gint64);
+
+	return TRUE;
+}
+
+static gchar *
+read_string (RecordReader *reader)
+{
+	guint32 len;
+	gchar *str;
+
+	if (!read_uint32 (reader, &len) ||
+	    reader->len - reader->pos < len)
+	{
+		return NULL;
+	}
+
+	str = g_strndup (reader->data + reader->pos, len);
+	reader->pos += len;
+
+	return str;
+}
+
+/* Returns FALSE if the record is malformed. */
+static gboolean
+replay_record (RecordType    type,
+	       RecordReader *reader)
+{
+	Item *item;
+	gchar *uri;
+	gchar *key;
+	gchar *value;
+	gint64 atime;
+	gboolean ok = FALSE;
+
+	uri = read_string (reader);
+	if (uri == NULL)
+	{
+		return FALSE;
+	}
+
+	switch (type)
+	{
+		case RECORD_REMOVE:
+			g_hash_table_remove (gedit_metadata_manager->items, uri);
+			ok = TRUE;
+			break;
+
+		case RECORD_TOUCH:
+		case RECORD_SET:
+		case RECORD_UNSET:
+			if (!read_int64 (reader, &atime))
+			{
+				break;
+			}
+
+			key = NULL;
+			value = NULL;
+
+			if (type != RECORD_TOUCH)
+			{
+				key = read_string (reader);
+				if (key == NULL)
+				{
+					break;
+				}
+			}
+
+			if (type == RECORD_SET)
+			{
+				value = read_string (reader);
+				if (value == NULL)
+				{
+					g_free (key);
+					break;
+				}
+			}
+
+			item = get_or_create_item (uri);
+			touch_item (item, atime);
+
+			if (value != NULL)
+			{
+				g_hash_table_insert (item->values, key, value);
+			}
+			else if (key != NULL)
+			{
+				g_hash_table_remove (item->values, key);
+				g_free (key);
+			}
+
+			ok = TRUE;
+			break;
+
+		default:
+			break;
+	}
+
+	g_free (uri);
+
+	return ok;
+}
+
 static void
 gedit_metadata_manager_arm_timeout (void)
 {
@@ -90,11 +446,27 @@ gedit_metadata_manager_arm_timeout (void)
 	}
 }
 
+static void
+on_max_items_changed (GSettings   *settings,
+		      const gchar *key,
+		      gpointer     user_data)
+{
+	gedit_metadata_manager->max_items = g_settings_get_uint (settings, key);
+
+	/* The items in excess are evicted on save. */
+	if (gedit_metadata_manager->values_loaded)
+	{
+		gedit_metadata_manager_arm_timeout ();
+	}
+}
+
 /**
  * gedit_metadata_manager_init:
  * @metadata_filename: the filename where the metadata is stored.
  *
- * This function initializes the metadata manager.
+ * This function initializes the metadata manager. If @metadata_filename does
+ * not exist yet, the metadata stored by older gedit versions in
+ * gedit-metadata.xml, in the same directory, is imported.
  * See also gedit_metadata_manager_shutdown().
  */
 void
@@ -114,10 +486,25 @@ gedit_metadata_manager_init (const gchar *metadata_filename)
 	gedit_metadata_manager->items =
 		g_hash_table_new_full (g_str_hash,
 				       g_str_equal,
-				       g_free,
+				       NULL,
 				       item_free);
 
+	g_queue_init (&gedit_metadata_manager->lru);
+
+	gedit_metadata_manager->settings = g_settings_new ("org.gnome.gedit.preferences.editor");
+
+	gedit_metadata_manager->max_items =
+		g_settings_get_uint (gedit_metadata_manager->settings,
+				     GEDIT_SETTINGS_MAX_METADATA_ITEMS);
+
+	g_signal_connect (gedit_metadata_manager->settings,
+			  "changed::" GEDIT_SETTINGS_MAX_METADATA_ITEMS,
+			  G_CALLBACK (on_max_items_changed),
+			  NULL);
+
 	gedit_metadata_manager->metadata_filename = g_strdup (metadata_filename);
+
+	gedit_metadata_manager->pending = g_string_new (NULL);
 }
 
 /**
@@ -144,6 +531,10 @@ gedit_metadata_manager_shutdown (void)
 	if (gedit_metadata_manager->items != NULL)
 		g_hash_table_destroy (gedit_metadata_manager->items);
 
+	g_clear_object (&gedit_metadata_manager->settings);
+
+	g_string_free (gedit_metadata_manager->pending, TRUE);
+
 	g_free (gedit_metadata_manager->metadata_filename);
 
 	g_free (gedit_metadata_manager);
@@ -176,15 +567,10 @@ parseItem (xmlDocPtr doc, xmlNodePtr cur)
 		return;
 	}
 
-	item = g_new0 (Item, 1);
+	item = get_or_create_item ((gchar *)uri);
 
 	item->atime = g_ascii_strtoll ((char *)atime, NULL, 0);
 
-	item->values = g_hash_table_new_full (g_str_hash,
-					      g_str_equal,
-					      g_free,
-					      g_free);
-
 	cur = cur->xmlChildrenNode;
 
 	while (cur != NULL)
@@ -213,78 +599,200 @@ parseItem (xmlDocPtr doc, xmlNodePtr cur)
 		cur = cur->next;
 	}
 
-	g_hash_table_insert (gedit_metadata_manager->items,
-			     g_strdup ((gchar *)uri),
-			     item);
-
 	xmlFree (uri);
 	xmlFree (atime);
 }
 
-/* Returns FALSE in case of error. */
-static gboolean
-load_values (void)
+static gint
+compare_atime (gconstpointer a,
+	       gconstpointer b,
+	       gpointer      user_data)
+{
+	const Item *item_a = a;
+	const Item *item_b = b;
+
+	/* Most recent first. */
+	if (item_a->atime == item_b->atime)
+		return 0;
+
+	return item_a->atime > item_b->atime ? -1 : 1;
+}
+
+/* Imports the metadata file of older gedit versions. The next save writes
+ * all of it in the new format, after which this is never called again.
+ */
+static void
+import_legacy_values (void)
 {
+	gchar *dirname;
+	gchar *legacy_filename;
 	xmlDocPtr doc;
 	xmlNodePtr cur;
 
 	gedit_debug (DEBUG_METADATA);
 
-	g_return_val_if_fail (gedit_metadata_manager != NULL, FALSE);
-	g_return_val_if_fail (gedit_metadata_manager->values_loaded == FALSE, FALSE);
+	dirname = g_path_get_dirname (gedit_metadata_manager->metadata_filename);
+	legacy_filename = g_build_filename (dirname, LEGACY_METADATA_FILENAME, NULL);
+	g_free (dirname);
 
-	gedit_metadata_manager->values_loaded = TRUE;
+	if (!g_file_test (legacy_filename, G_FILE_TEST_EXISTS))
+	{
+		g_free (legacy_filename);
+		return;
+	}
 
 	xmlKeepBlanksDefault (0);
 
-	if (gedit_metadata_manager->metadata_filename == NULL)
+	doc = xmlParseFile (legacy_filename);
+
+	if (doc == NULL)
 	{
-		return FALSE;
+		g_free (legacy_filename);
+		return;
 	}
 
-	/* TODO: avoid races */
-	if (!g_file_test (gedit_metadata_manager->metadata_filename, G_FILE_TEST_EXISTS))
+	cur = xmlDocGetRootElement (doc);
+
+	if (cur != NULL && xmlStrcmp (cur->name, (const xmlChar *) "metadata") == 0)
 	{
-		return TRUE;
+		for (cur = cur->xmlChildrenNode; cur != NULL; cur = cur->next)
+		{
+			parseItem (doc, cur);
+		}
+
+		/* The XML file is not sorted by access time. */
+		g_queue_sort (&gedit_metadata_manager->lru, compare_atime, NULL);
+
+		gedit_metadata_manager->needs_compaction = TRUE;
+		gedit_metadata_manager_arm_timeout ();
 	}
+	else
+	{
+		g_message ("File '%s' is of the wrong type", legacy_filename);
+	}
+
+	xmlFreeDoc (doc);
+	g_free (legacy_filename);
+}
+
+static void
+replay_log (const gchar *data,
+	    gsize        len)
+{
+	RecordReader reader;
 
-	doc = xmlParseFile (gedit_metadata_manager->metadata_filename);
+	reader.data = data;
+	reader.len = len;
+	reader.pos = METADATA_HEADER_SIZE;
 
-	if (doc == NULL)
+	while (reader.pos < reader.len)
 	{
-		return FALSE;
+		RecordReader record;
+		guint32 record_len;
+
+		if (!read_uint32 (&reader, &record_len) ||
+		    record_len == 0 ||
+		    reader.len - reader.pos < record_len)
+		{
+			break;
+		}
+
+		record.data = reader.data + reader.pos;
+		record.len = record_len;
+		record.pos = 1;
+
+		if (!replay_record ((RecordType)record.data[0], &record))
+		{
+			break;
+		}
+
+		reader.pos += record_len;
+		gedit_metadata_manager->log_size = reader.pos;
 	}
 
-	cur = xmlDocGetRootElement (doc);
-	if (cur == NULL)
+	/* The access times read alone are appended to the log after the
+	 * changes made meanwhile, so the records are not in access order.
+	 */
+	g_queue_sort (&gedit_metadata_manager->lru, compare_atime, NULL);
+
+	/* A record was only partially written, e.g. because of a crash. The
+	 * valid records are kept and the file is rewritten on the next save,
+	 * so that nothing gets appended after the garbage.
+	 */
+	if (gedit_metadata_manager->log_size < len)
 	{
-		g_message ("The metadata file '%s' is empty",
-		           g_path_get_basename (gedit_metadata_manager->metadata_filename));
-		xmlFreeDoc (doc);
+		g_message ("The metadata file '%s' is truncated",
+			   gedit_metadata_manager->metadata_filename);
 
-		return TRUE;
+		gedit_metadata_manager->needs_compaction = TRUE;
 	}
+}
 
-	if (xmlStrcmp (cur->name, (const xmlChar *) "metadata"))
+/* Returns FALSE in case of error. */
+static gboolean
+load_values (void)
+{
+	GMappedFile *mapped_file;
+	const gchar *data;
+	gsize len;
+	GError *error = NULL;
+
+	gedit_debug (DEBUG_METADATA);
+
+	g_return_val_if_fail (gedit_metadata_manager != NULL, FALSE);
+	g_return_val_if_fail (gedit_metadata_manager->values_loaded == FALSE, FALSE);
+
+	gedit_metadata_manager->values_loaded = TRUE;
+
+	if (gedit_metadata_manager->metadata_filename == NULL)
 	{
-		g_message ("File '%s' is of the wrong type",
-		           g_path_get_basename (gedit_metadata_manager->metadata_filename));
-		xmlFreeDoc (doc);
+		return FALSE;
+	}
 
+	mapped_file = g_mapped_file_new (gedit_metadata_manager->metadata_filename,
+					 FALSE,
+					 &error);
+
+	if (mapped_file == NULL)
+	{
+		if (g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+		{
+			g_error_free (error);
+			import_legacy_values ();
+			return TRUE;
+		}
+
+		g_message ("Could not read the metadata file '%s': %s",
+			   gedit_metadata_manager->metadata_filename,
+			   error->message);
+
+		g_error_free (error);
 		return FALSE;
 	}
 
-	cur = xmlDocGetRootElement (doc);
-	cur = cur->xmlChildrenNode;
+	data = g_mapped_file_get_contents (mapped_file);
+	len = g_mapped_file_get_length (mapped_file);
 
-	while (cur != NULL)
+	if (len < METADATA_HEADER_SIZE ||
+	    memcmp (data, METADATA_MAGIC, METADATA_HEADER_SIZE - 1) != 0 ||
+	    data[METADATA_HEADER_SIZE - 1] != METADATA_VERSION)
 	{
-		parseItem (doc, cur);
+		if (len > 0)
+		{
+			g_message ("File '%s' is of the wrong type",
+				   gedit_metadata_manager->metadata_filename);
+		}
 
-		cur = cur->next;
+		gedit_metadata_manager->needs_compaction = TRUE;
+	}
+	else
+	{
+		gedit_metadata_manager->log_size = METADATA_HEADER_SIZE;
+		replay_log (data, len);
+		gedit_metadata_manager->compacted_size = gedit_metadata_manager->log_size;
 	}
 
-	xmlFreeDoc (doc);
+	g_mapped_file_unref (mapped_file);
 
 	return TRUE;
 }
@@ -327,12 +835,19 @@ gedit_metadata_manager_get (GFile       *location,
 	item = (Item *)g_hash_table_lookup (gedit_metadata_manager->items,
 					    uri);
 
-	g_free (uri);
-
 	if (item == NULL)
+	{
+		g_free (uri);
 		return NULL;
+	}
 
-	item->atime = g_get_real_time () / 1000;
+	/* Reading is frequent, the access time is only written to the log
+	 * along with the next change or when the log is compacted.
+	 */
+	touch_item (item, g_get_real_time () / 1000);
+	item->atime_dirty = TRUE;
+
+	g_free (uri);
 
 	if (item->values == NULL)
 		return NULL;
@@ -381,25 +896,7 @@ gedit_metadata_manager_set (GFile       *location,
 		}
 	}
 
-	item = (Item *)g_hash_table_lookup (gedit_metadata_manager->items,
-					    uri);
-
-	if (item == NULL)
-	{
-		item = g_new0 (Item, 1);
-
-		g_hash_table_insert (gedit_metadata_manager->items,
-				     g_strdup (uri),
-				     item);
-	}
-
-	if (item->values == NULL)
-	{
-		 item->values = g_hash_table_new_full (g_str_hash,
-				 		       g_str_equal,
-						       g_free,
-						       g_free);
-	}
+	item = get_or_create_item (uri);
 
 	if (value != NULL)
 	{
@@ -413,7 +910,10 @@ gedit_metadata_manager_set (GFile       *location,
 				     key);
 	}
 
-	item->atime = g_get_real_time () / 1000;
+	touch_item (item, g_get_real_time () / 1000);
+
+	write_value_record (gedit_metadata_manager->pending, item, key, value);
+	item->atime_dirty = FALSE;
 
 	g_free (uri);
 
@@ -421,121 +921,146 @@ gedit_metadata_manager_set (GFile       *location,
 }
 
 static void
-save_values (const gchar *key, const gchar *value, xmlNodePtr parent)
+resize_items (void)
 {
-	xmlNodePtr xml_node;
-
-#ifdef GEDIT_METADATA_VERBOSE_DEBUG
-	gedit_debug (DEBUG_METADATA);
-#endif
-
-	g_return_if_fail (key != NULL);
-
-	if (value == NULL)
-		return;
-
-	xml_node = xmlNewChild (parent,
-				NULL,
-				(const xmlChar *)"entry",
-				NULL);
+	while (g_hash_table_size (gedit_metadata_manager->items) > gedit_metadata_manager->max_items)
+	{
+		Item *oldest = gedit_metadata_manager->lru.tail->data;
 
-	xmlSetProp (xml_node,
-		    (const xmlChar *)"key",
-		    (const xmlChar *)key);
-	xmlSetProp (xml_node,
-		    (const xmlChar *)"value",
-		    (const xmlChar *)value);
+		write_remove_record (gedit_metadata_manager->pending,
+				     oldest->uri);
 
-#ifdef GEDIT_METADATA_VERBOSE_DEBUG
-	gedit_debug_message (DEBUG_METADATA, "entry: %s = %s", key, value);
-#endif
+		/* Frees the item, including its uri used as key. */
+		g_hash_table_remove (gedit_metadata_manager->items,
+				     oldest->uri);
+	}
 }
 
+/* Rewrites the whole file with only the current items. */
 static void
-save_item (const gchar *key, const gpointer *data, xmlNodePtr parent)
+write_snapshot (void)
 {
-	xmlNodePtr xml_node;
-	const Item *item = (const Item *)data;
-	gchar *atime;
+	GString *snapshot;
+	GList *l;
+	GError *error = NULL;
 
-#ifdef GEDIT_METADATA_VERBOSE_DEBUG
-	gedit_debug (DEBUG_METADATA);
-#endif
+	snapshot = g_string_new (METADATA_MAGIC);
+	g_string_append_c (snapshot, METADATA_VERSION);
 
-	g_return_if_fail (key != NULL);
-
-	if (item == NULL)
-		return;
+	/* Oldest first, so that replaying the touch records rebuilds the
+	 * LRU queue in the same order.
+	 */
+	for (l = gedit_metadata_manager->lru.tail; l != NULL; l = l->prev)
+	{
+		Item *item = l->data;
 
-	xml_node = xmlNewChild (parent, NULL, (const xmlChar *)"document", NULL);
+		write_item (snapshot, item);
+		item->atime_dirty = FALSE;
+	}
 
-	xmlSetProp (xml_node, (const xmlChar *)"uri", (const xmlChar *)key);
+	if (g_file_set_contents (gedit_metadata_manager->metadata_filename,
+				 snapshot->str,
+				 snapshot->len,
+				 &error))
+	{
+		gedit_metadata_manager->log_size = snapshot->len;
+		gedit_metadata_manager->compacted_size = snapshot->len;
+		gedit_metadata_manager->needs_compaction = FALSE;
+	}
+	else
+	{
+		g_message ("Could not save the metadata file: %s", error->message);
+		g_error_free (error);
+	}
 
-#ifdef GEDIT_METADATA_VERBOSE_DEBUG
-	gedit_debug_message (DEBUG_METADATA, "uri: %s", key);
-#endif
+	/* Either written, or the next snapshot will include them. */
+	g_string_truncate (gedit_metadata_manager->pending, 0);
 
-	atime = g_strdup_printf ("%" G_GINT64_FORMAT, item->atime);
-	xmlSetProp (xml_node, (const xmlChar *)"atime", (const xmlChar *)atime);
+	g_string_free (snapshot, TRUE);
+}
 
-#ifdef GEDIT_METADATA_VERBOSE_DEBUG
-	gedit_debug_message (DEBUG_METADATA, "atime: %s", atime);
-#endif
+/* Adds the access times changed by reads to the pending records. */
+static void
+write_touch_records (void)
+{
+	GList *l;
 
-	g_free (atime);
+	for (l = gedit_metadata_manager->lru.head; l != NULL; l = l->next)
+	{
+		Item *item = l->data;
 
-    	g_hash_table_foreach (item->values,
-			      (GHFunc)save_values,
-			      xml_node);
+		if (item->atime_dirty)
+		{
+			write_touch_record (gedit_metadata_manager->pending, item);
+			item->atime_dirty = FALSE;
+		}
+	}
 }
 
 static void
-get_oldest (const gchar *key, const gpointer value, const gchar ** key_to_remove)
+append_pending_records (void)
 {
-	const Item *item = (const Item *)value;
+	GFile *file;
+	GFileOutputStream *stream;
+	GString *pending = gedit_metadata_manager->pending;
+	GError *error = NULL;
+
+	if (pending->len == 0)
+	{
+		return;
+	}
 
-	if (*key_to_remove == NULL)
+	file = g_file_new_for_path (gedit_metadata_manager->metadata_filename);
+	stream = g_file_append_to (file, G_FILE_CREATE_NONE, NULL, &error);
+
+	if (stream != NULL &&
+	    g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+				       pending->str,
+				       pending->len,
+				       NULL,
+				       NULL,
+				       &error) &&
+	    g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, &error))
 	{
-		*key_to_remove = key;
+		gedit_metadata_manager->log_size += pending->len;
+		g_string_truncate (pending, 0);
 	}
 	else
 	{
-		const Item *item_to_remove =
-			g_hash_table_lookup (gedit_metadata_manager->items,
-					     *key_to_remove);
-
-		g_return_if_fail (item_to_remove != NULL);
+		/* The file may end with a partial record now, it is rewritten
+		 * on the next save.
+		 */
+		g_message ("Could not save the metadata file: %s", error->message);
+		g_error_free (error);
 
-		if (item->atime < item_to_remove->atime)
-		{
-			*key_to_remove = key;
-		}
+		gedit_metadata_manager->needs_compaction = TRUE;
 	}
+
+	g_clear_object (&stream);
+	g_object_unref (file);
 }
 
-static void
-resize_items (void)
+static gboolean
+needs_compaction (void)
 {
-	while (g_hash_table_size (gedit_metadata_manager->items) > MAX_ITEMS)
-	{
-		gpointer key_to_remove = NULL;
+	gsize new_size;
 
-		g_hash_table_foreach (gedit_metadata_manager->items,
-				      (GHFunc)get_oldest,
-				      &key_to_remove);
+	if (gedit_metadata_manager->needs_compaction ||
+	    gedit_metadata_manager->log_size == 0)
+	{
+		return TRUE;
+	}
 
-		g_return_if_fail (key_to_remove != NULL);
+	new_size = gedit_metadata_manager->log_size + gedit_metadata_manager->pending->len;
 
-		g_hash_table_remove (gedit_metadata_manager->items,
-				     key_to_remove);
-	}
+	return new_size > MAX (2 * gedit_metadata_manager->compacted_size, COMPACT_MIN_SIZE);
 }
 
 static gboolean
 gedit_metadata_manager_save (gpointer data)
 {
-	xmlDocPtr  doc;
-	xmlNodePtr root;
+	gchar *cache_dir;
+	int res;
 
 	gedit_debug (DEBUG_METADATA);
 
@@ -543,40 +1068,32 @@ gedit_metadata_manager_save (gpointer data)
 
 	resize_items ();
 
-	xmlIndentTreeOutput = TRUE;
-
-	doc = xmlNewDoc ((const xmlChar *)"1.0");
-	if (doc == NULL)
-		return TRUE;
-
-	/* Create metadata root */
-	root = xmlNewDocNode (doc, NULL, (const xmlChar *)"metadata", NULL);
-	xmlDocSetRootElement (doc, root);
-
-    	g_hash_table_foreach (gedit_metadata_manager->items,
-			      (GHFunc)save_item,
-			      root);
-
 	/* FIXME: lock file - Paolo */
-	if (gedit_metadata_manager->metadata_filename != NULL)
+	if (gedit_metadata_manager->metadata_filename == NULL)
 	{
-		gchar *cache_dir;
-		int res;
+		g_string_truncate (gedit_metadata_manager->pending, 0);
+		return FALSE;
+	}
 
-		/* make sure the cache dir exists */
-		cache_dir = g_path_get_dirname (gedit_metadata_manager->metadata_filename);
-		res = g_mkdir_with_parents (cache_dir, 0755);
-		if (res != -1)
-		{
-			xmlSaveFormatFile (gedit_metadata_manager->metadata_filename,
-			                   doc,
-			                   1);
-		}
+	/* make sure the cache dir exists */
+	cache_dir = g_path_get_dirname (gedit_metadata_manager->metadata_filename);
+	res = g_mkdir_with_parents (cache_dir, 0755);
+	g_free (cache_dir);
 
-		g_free (cache_dir);
+	if (res == -1)
+	{
+		return FALSE;
 	}
 
-	xmlFreeDoc (doc);
+	if (needs_compaction ())
+	{
+		write_snapshot ();
+	}
+	else
+	{
+		write_touch_records ();
+		append_pending_records ();
+	}
 
 	gedit_debug_message (DEBUG_METADATA, "DONE");
 
@@ -62,6 +62,7 @@ gedit_open_document_selector_free_fileitem_item (FileItem *item)
 	g_free (item->uri);
 	g_free (item->name);
 	g_free (item->path);
+	g_free (item->candidate);
 
 	g_slice_free (FileItem, item);
 }
@@ -77,6 +78,8 @@ gedit_open_document_selector_copy_fileitem_item (FileItem *item)
 	new_item->name = g_strdup (item->name);
 	new_item->path = g_strdup (item->path);
 	new_item->access_time = item->access_time;
+	new_item->candidate = g_strdup (item->candidate);
+	new_item->name_offset = item->name_offset;
 
 	return new_item;
 }
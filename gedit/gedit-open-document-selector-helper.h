@@ -33,6 +33,12 @@ typedef struct
 	gchar *name;
 	gchar *path;
 	GTimeVal access_time;
+
+	/* Normalized and casefolded full name the filter is matched
+	 * against, and offset of the basename in it.
+	 */
+	gchar *candidate;
+	gsize name_offset;
 } FileItem;
 
 typedef enum
@@ -46,6 +46,11 @@
  * The original setting is stored in gsettings at :
  * org.gnome.gedit.preferences.ui
  * with the key : max-recents
+ *
+ * The listings of the directories are cached, and only enumerated
+ * again when the modification time of the directory changed or its
+ * monitor reported a change since the last enumeration. Only the
+ * most recently listed directories are kept.
  */
 
 #include "gedit-open-document-selector-store.h"
@@ -74,10 +79,50 @@ struct _GeditOpenDocumentSelectorStore
 	GList                    *recent_items;
 	gint                      recent_config_limit;
 	gboolean                  recent_items_need_update;
+
+	/* uri of a directory -> DirCache */
+	GHashTable               *dir_caches;
+
+	/* DirCache, the most recently used first */
+	GQueue                    dir_caches_lru;
 };
 
+typedef struct
+{
+	gint          ref_count;
+
+	/* The key in the dir_caches table */
+	gchar        *uri;
+
+	/* The link in the dir_caches_lru queue */
+	GList        *lru_link;
+
+	GFileMonitor *monitor;
+
+	/* Bumped for each change reported by the monitor */
+	guint         serial;
+
+	/* The last listing, with the serial and the modification time of
+	 * the directory when it was enumerated.
+	 */
+	GList        *items;
+	guint         items_serial;
+	guint64       items_mtime;
+	guint32       items_mtime_usec;
+	guint         has_items : 1;
+} DirCache;
+
+/* Number of files asked to the enumerator at once */
+#define DIR_ENUMERATE_BATCH_SIZE 100
+
+/* Number of directory listings and monitors kept around */
+#define MAX_DIR_CACHES 32
+
 G_LOCK_DEFINE_STATIC (recent_files_filter_lock);
 
+/* The directory caches are used from the threads computing the lists */
+G_LOCK_DEFINE_STATIC (dir_caches_lock);
+
 G_DEFINE_TYPE (GeditOpenDocumentSelectorStore, gedit_open_document_selector_store, G_TYPE_OBJECT)
 
 G_DEFINE_QUARK (gedit-open-document-selector-store-error-quark,
@@ -85,7 +130,8 @@ G_DEFINE_QUARK (gedit-open-document-selector-store-error-quark,
 
 static GList *
 get_current_docs_list (GeditOpenDocumentSelectorStore *selector_store G_GNUC_UNUSED,
-                       GeditOpenDocumentSelector      *selector)
+                       GeditOpenDocumentSelector      *selector,
+                       GCancellable                   *cancellable)
 {
 	GeditWindow *window;
 	GList *docs;
@@ -110,7 +156,7 @@ get_current_docs_list (GeditOpenDocumentSelectorStore *selector_store G_GNUC_UNU
 		info = g_file_query_info (file,
 		                          "time::access,time::access-usec",
 		                          G_FILE_QUERY_INFO_NONE,
-		                          NULL,
+		                          cancellable,
 		                          NULL);
 		if (info == NULL)
 		{
@@ -173,20 +219,117 @@ check_mime_type (GFileInfo *info)
 	return FALSE;
 }
 
-static GList *
-get_children_from_dir (GeditOpenDocumentSelectorStore *selector_store G_GNUC_UNUSED,
-                       GFile                          *dir)
+/* Must be called with dir_caches_lock held */
+static DirCache *
+dir_cache_ref (DirCache *cache)
+{
+	cache->ref_count++;
+	return cache;
+}
+
+/* Must be called with dir_caches_lock held */
+static void
+dir_cache_unref (DirCache *cache)
+{
+	if (--cache->ref_count > 0)
+	{
+		return;
+	}
+
+	if (cache->monitor != NULL)
+	{
+		g_signal_handlers_disconnect_by_data (cache->monitor, cache);
+		g_file_monitor_cancel (cache->monitor);
+		g_object_unref (cache->monitor);
+	}
+
+	gedit_open_document_selector_free_file_items_list (cache->items);
+	g_free (cache->uri);
+	g_slice_free (DirCache, cache);
+}
+
+static void
+on_dir_changed (GFileMonitor      *monitor G_GNUC_UNUSED,
+                GFile             *file G_GNUC_UNUSED,
+                GFile             *other_file G_GNUC_UNUSED,
+                GFileMonitorEvent  event_type G_GNUC_UNUSED,
+                DirCache          *cache)
+{
+	G_LOCK (dir_caches_lock);
+	cache->serial++;
+	G_UNLOCK (dir_caches_lock);
+}
+
+/* Must be called with dir_caches_lock held */
+static DirCache *
+get_dir_cache (GeditOpenDocumentSelectorStore *selector_store,
+               GFile                          *dir,
+               const gchar                    *uri)
+{
+	DirCache *cache;
+
+	cache = g_hash_table_lookup (selector_store->dir_caches, uri);
+	if (cache != NULL)
+	{
+		g_queue_unlink (&selector_store->dir_caches_lru, cache->lru_link);
+		g_queue_push_head_link (&selector_store->dir_caches_lru, cache->lru_link);
+		return cache;
+	}
+
+	/* The monitor of the evicted directory is cancelled right away,
+	 * a thread still enumerating it only keeps the DirCache alive.
+	 */
+	if (g_queue_get_length (&selector_store->dir_caches_lru) >= MAX_DIR_CACHES)
+	{
+		DirCache *oldest;
+
+		oldest = g_queue_pop_tail (&selector_store->dir_caches_lru);
+		oldest->lru_link = NULL;
+
+		if (oldest->monitor != NULL)
+		{
+			g_signal_handlers_disconnect_by_data (oldest->monitor, oldest);
+			g_file_monitor_cancel (oldest->monitor);
+			g_clear_object (&oldest->monitor);
+		}
+
+		g_hash_table_remove (selector_store->dir_caches, oldest->uri);
+	}
+
+	cache = g_slice_new0 (DirCache);
+	cache->ref_count = 1;
+	cache->uri = g_strdup (uri);
+
+	/* Without a monitor, only the modification time of the directory
+	 * tells when the listing is outdated. Created from a thread without
+	 * a thread-default context, the monitor emits in the main context.
+	 */
+	cache->monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_NONE, NULL, NULL);
+	if (cache->monitor != NULL)
+	{
+		g_signal_connect (cache->monitor,
+		                  "changed",
+		                  G_CALLBACK (on_dir_changed),
+		                  cache);
+	}
+
+	g_hash_table_insert (selector_store->dir_caches, cache->uri, cache);
+	g_queue_push_head (&selector_store->dir_caches_lru, cache);
+	cache->lru_link = selector_store->dir_caches_lru.head;
+
+	return cache;
+}
+
+/* Returns FALSE if the enumeration failed or was cancelled */
+static gboolean
+enumerate_children (GFile         *dir,
+                    GCancellable  *cancellable,
+                    GList        **file_items_list)
 {
-	GList *file_items_list = NULL;
 	GFileEnumerator *file_enum;
-	GFileInfo *info;
-	GFileType filetype;
-	GFile *file;
-	FileItem *item;
-	gboolean is_text;
-	gboolean is_correct_type;
+	GError *error = NULL;
 
-	g_return_val_if_fail (G_IS_FILE (dir), NULL);
+	*file_items_list = NULL;
 
 	file_enum = g_file_enumerate_children (dir,
 	                                       "standard::name,"
@@ -194,47 +337,166 @@ get_children_from_dir (GeditOpenDocumentSelectorStore *selector_store G_GNUC_UNU
 	                                       "standard::fast-content-type,"
 	                                       "time::access,time::access-usec",
 	                                       G_FILE_QUERY_INFO_NONE,
-	                                       NULL,
+	                                       cancellable,
 	                                       NULL);
 	if (file_enum == NULL)
 	{
-		return NULL;
+		return FALSE;
 	}
 
-	while ((info = g_file_enumerator_next_file (file_enum, NULL, NULL)))
+	while (TRUE)
 	{
-		filetype = g_file_info_get_file_type (info);
-		is_text = check_mime_type (info);
-		is_correct_type = (filetype == G_FILE_TYPE_REGULAR ||
-		                   filetype == G_FILE_TYPE_SYMBOLIC_LINK ||
-		                   filetype == G_FILE_TYPE_SHORTCUT);
-
-		if (is_text &&
-		    is_correct_type &&
-		    (file = g_file_enumerator_get_child (file_enum, info)) != NULL)
+		GList *infos;
+		GList *l;
+
+		infos = g_file_enumerator_next_files (file_enum,
+		                                      DIR_ENUMERATE_BATCH_SIZE,
+		                                      cancellable,
+		                                      &error);
+		if (infos == NULL)
 		{
-			item = gedit_open_document_selector_create_fileitem_item ();
-			item->uri = g_file_get_uri (file);
-
-			item->access_time.tv_sec = g_file_info_get_attribute_uint64 (info, "time::access");
-			item->access_time.tv_usec = g_file_info_get_attribute_uint32 (info, "time::access-usec");
+			break;
+		}
 
-			file_items_list = g_list_prepend (file_items_list, item);
-			g_object_unref (file);
+		for (l = infos; l != NULL; l = l->next)
+		{
+			GFileInfo *info = l->data;
+			GFileType filetype;
+			GFile *file;
+			gboolean is_text;
+			gboolean is_correct_type;
+
+			filetype = g_file_info_get_file_type (info);
+			is_text = check_mime_type (info);
+			is_correct_type = (filetype == G_FILE_TYPE_REGULAR ||
+			                   filetype == G_FILE_TYPE_SYMBOLIC_LINK ||
+			                   filetype == G_FILE_TYPE_SHORTCUT);
+
+			if (is_text &&
+			    is_correct_type &&
+			    (file = g_file_enumerator_get_child (file_enum, info)) != NULL)
+			{
+				FileItem *item;
+
+				item = gedit_open_document_selector_create_fileitem_item ();
+				item->uri = g_file_get_uri (file);
+
+				item->access_time.tv_sec = g_file_info_get_attribute_uint64 (info, "time::access");
+				item->access_time.tv_usec = g_file_info_get_attribute_uint32 (info, "time::access-usec");
+
+				*file_items_list = g_list_prepend (*file_items_list, item);
+				g_object_unref (file);
+			}
 		}
 
-		g_object_unref (info);
+		g_list_free_full (infos, g_object_unref);
 	}
 
 	g_file_enumerator_close (file_enum, NULL, NULL);
 	g_object_unref (file_enum);
 
+	if (error != NULL)
+	{
+		g_error_free (error);
+
+		gedit_open_document_selector_free_file_items_list (*file_items_list);
+		*file_items_list = NULL;
+
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static GList *
+get_children_from_dir (GeditOpenDocumentSelectorStore *selector_store,
+                       GFile                          *dir,
+                       GCancellable                   *cancellable)
+{
+	GList *file_items_list = NULL;
+	GFileInfo *dir_info;
+	DirCache *cache;
+	gchar *uri;
+	guint64 mtime;
+	guint32 mtime_usec;
+	guint serial;
+	gboolean enumerated;
+
+	g_return_val_if_fail (G_IS_FILE (dir), NULL);
+
+	dir_info = g_file_query_info (dir,
+	                              G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+	                              G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+	                              G_FILE_QUERY_INFO_NONE,
+	                              cancellable,
+	                              NULL);
+	if (dir_info == NULL)
+	{
+		return NULL;
+	}
+
+	mtime = g_file_info_get_attribute_uint64 (dir_info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	mtime_usec = g_file_info_get_attribute_uint32 (dir_info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+	g_object_unref (dir_info);
+
+	uri = g_file_get_uri (dir);
+
+	G_LOCK (dir_caches_lock);
+
+	cache = get_dir_cache (selector_store, dir, uri);
+	if (cache->has_items &&
+	    cache->items_serial == cache->serial &&
+	    cache->items_mtime == mtime &&
+	    cache->items_mtime_usec == mtime_usec)
+	{
+		file_items_list = gedit_open_document_selector_copy_file_items_list (cache->items);
+		G_UNLOCK (dir_caches_lock);
+
+		DEBUG_SELECTOR (g_print ("\tStore(%p): dir cache hit: %s\n", selector_store, uri););
+
+		g_free (uri);
+		return file_items_list;
+	}
+
+	/* The cache can be evicted during the enumeration */
+	dir_cache_ref (cache);
+	serial = cache->serial;
+
+	G_UNLOCK (dir_caches_lock);
+
+	DEBUG_SELECTOR (g_print ("\tStore(%p): dir cache miss: %s\n", selector_store, uri););
+
+	enumerated = enumerate_children (dir, cancellable, &file_items_list);
+
+	G_LOCK (dir_caches_lock);
+
+	/* A change reported during the enumeration may be missing
+	 * from the listing, so it is kept only if there was none.
+	 */
+	if (enumerated &&
+	    cache->lru_link != NULL &&
+	    cache->serial == serial)
+	{
+		gedit_open_document_selector_free_file_items_list (cache->items);
+		cache->items = gedit_open_document_selector_copy_file_items_list (file_items_list);
+		cache->items_serial = serial;
+		cache->items_mtime = mtime;
+		cache->items_mtime_usec = mtime_usec;
+		cache->has_items = TRUE;
+	}
+
+	dir_cache_unref (cache);
+
+	G_UNLOCK (dir_caches_lock);
+
+	g_free (uri);
 	return file_items_list;
 }
 
 static GList *
 get_active_doc_dir_list (GeditOpenDocumentSelectorStore *selector_store,
-                         GeditOpenDocumentSelector      *selector)
+                         GeditOpenDocumentSelector      *selector,
+                         GCancellable                   *cancellable)
 {
 	GeditWindow *window;
 	GeditDocument *active_doc;
@@ -261,7 +523,7 @@ get_active_doc_dir_list (GeditOpenDocumentSelectorStore *selector_store,
 
 		if (parent_dir != NULL)
 		{
-			file_items_list = get_children_from_dir (selector_store, parent_dir);
+			file_items_list = get_children_from_dir (selector_store, parent_dir, cancellable);
 			g_object_unref (parent_dir);
 		}
 	}
@@ -293,7 +555,8 @@ get_file_browser_root (GeditOpenDocumentSelectorStore *selector_store G_GNUC_UNU
 
 static GList *
 get_file_browser_root_dir_list (GeditOpenDocumentSelectorStore *selector_store,
-                                GeditOpenDocumentSelector      *selector)
+                                GeditOpenDocumentSelector      *selector,
+                                GCancellable                   *cancellable)
 {
 	GFile *root;
 	GList *file_items_list = NULL;
@@ -301,7 +564,7 @@ get_file_browser_root_dir_list (GeditOpenDocumentSelectorStore *selector_store,
 	root = get_file_browser_root (selector_store, selector);
 	if (root != NULL && g_file_is_native (root))
 	{
-		file_items_list = get_children_from_dir (selector_store, root);
+		file_items_list = get_children_from_dir (selector_store, root, cancellable);
 	}
 
 	g_clear_object (&root);
@@ -352,7 +615,8 @@ read_bookmarks_file (GFile *file)
 
 static GList *
 get_local_bookmarks_list (GeditOpenDocumentSelectorStore *selector_store,
-                          GeditOpenDocumentSelector      *selector G_GNUC_UNUSED)
+                          GeditOpenDocumentSelector      *selector G_GNUC_UNUSED,
+                          GCancellable                   *cancellable)
 {
 	GList *bookmarks_uri_list = NULL;
 	GList *file_items_list = NULL;
@@ -374,7 +638,7 @@ get_local_bookmarks_list (GeditOpenDocumentSelectorStore *selector_store,
 		file = g_file_new_for_uri (l->data);
 		if (g_file_is_native (file))
 		{
-			new_file_items_list = get_children_from_dir (selector_store, file);
+			new_file_items_list = get_children_from_dir (selector_store, file, cancellable);
 			file_items_list = g_list_concat (file_items_list, new_file_items_list);
 		}
 
@@ -412,7 +676,8 @@ path_is_home_dir (const gchar *path)
 
 static GList *
 get_desktop_dir_list (GeditOpenDocumentSelectorStore *selector_store,
-                      GeditOpenDocumentSelector      *selector G_GNUC_UNUSED)
+                      GeditOpenDocumentSelector      *selector G_GNUC_UNUSED,
+                      GCancellable                   *cancellable)
 {
 	GList *file_items_list = NULL;
 	const gchar *desktop_dir_name;
@@ -431,7 +696,7 @@ get_desktop_dir_list (GeditOpenDocumentSelectorStore *selector_store,
 
 	desktop_uri = g_strconcat ("file://", desktop_dir_name, NULL);
 	desktop_file = g_file_new_for_uri (desktop_uri);
-	file_items_list = get_children_from_dir (selector_store, desktop_file);
+	file_items_list = get_children_from_dir (selector_store, desktop_file, cancellable);
 
 	g_free (desktop_uri);
 	g_object_unref (desktop_file);
@@ -441,7 +706,8 @@ get_desktop_dir_list (GeditOpenDocumentSelectorStore *selector_store,
 
 static GList *
 get_home_dir_list (GeditOpenDocumentSelectorStore *selector_store,
-                   GeditOpenDocumentSelector      *selector G_GNUC_UNUSED)
+                   GeditOpenDocumentSelector      *selector G_GNUC_UNUSED,
+                   GCancellable                   *cancellable)
 {
 	GList *file_items_list = NULL;
 	const gchar *home_name;
@@ -456,7 +722,7 @@ get_home_dir_list (GeditOpenDocumentSelectorStore *selector_store,
 
 	home_uri = g_strconcat ("file://", home_name, NULL);
 	home_file = g_file_new_for_uri (home_uri);
-	file_items_list = get_children_from_dir (selector_store, home_file);
+	file_items_list = get_children_from_dir (selector_store, home_file, cancellable);
 
 	g_free (home_uri);
 	g_object_unref (home_file);
@@ -492,7 +758,8 @@ convert_recent_item_list_to_fileitem_list (GList *uri_list)
 
 static GList *
 get_recent_files_list (GeditOpenDocumentSelectorStore *selector_store,
-                       GeditOpenDocumentSelector      *selector G_GNUC_UNUSED)
+                       GeditOpenDocumentSelector      *selector G_GNUC_UNUSED,
+                       GCancellable                   *cancellable G_GNUC_UNUSED)
 {
 	GList *recent_items_list;
 	GList *file_items_list;
@@ -513,11 +780,16 @@ update_list_cb (GeditOpenDocumentSelectorStore *selector_store,
                 gpointer                        user_data G_GNUC_UNUSED)
 {
 	GList *list;
-	GError *error;
+	GError *error = NULL;
 	PushMessage *message;
 	ListType type;
 
 	list = gedit_open_document_selector_store_update_list_finish (selector_store, res, &error);
+	if (error != NULL)
+	{
+		g_error_free (error);
+		return;
+	}
 
 	message = g_task_get_task_data (G_TASK (res));
 	type = message->type;
@@ -562,6 +834,16 @@ gedit_open_document_selector_store_dispose (GObject *object)
 	g_clear_pointer (&selector_store->recent_source, g_source_destroy);
 	g_clear_pointer (&selector_store->filter, g_free);
 
+	G_LOCK (dir_caches_lock);
+	while (!g_queue_is_empty (&selector_store->dir_caches_lru))
+	{
+		DirCache *cache = g_queue_pop_head (&selector_store->dir_caches_lru);
+
+		cache->lru_link = NULL;
+	}
+	g_clear_pointer (&selector_store->dir_caches, g_hash_table_destroy);
+	G_UNLOCK (dir_caches_lock);
+
 	if (selector_store->recent_items)
 	{
 		gedit_open_document_selector_free_file_items_list (selector_store->recent_items);
@@ -583,7 +865,8 @@ gedit_open_document_selector_store_class_init (GeditOpenDocumentSelectorStoreCla
  * ListType enum define in ./gedit-open-document-selector-helper.h
  */
 static GList * (*list_func [])(GeditOpenDocumentSelectorStore *selector_store,
-                               GeditOpenDocumentSelector      *selector) =
+                               GeditOpenDocumentSelector      *selector,
+                               GCancellable                   *cancellable) =
 {
 	get_recent_files_list,
 	get_home_dir_list,
@@ -625,7 +908,7 @@ update_recent_list (gpointer user_data)
 	else
 	{
 		selector_store->recent_items_need_update = FALSE;
-		file_items_list = get_recent_files_list (selector_store, selector);
+		file_items_list = get_recent_files_list (selector_store, selector, g_task_get_cancellable (task));
 
 		DEBUG_SELECTOR (g_print ("\tStore(%p): store dispatcher: recent list compute\n", selector););
 
@@ -651,7 +934,7 @@ static void
 update_list_dispatcher (GTask        *task,
                         gpointer      source_object,
                         gpointer      task_data,
-                        GCancellable *cancellable G_GNUC_UNUSED)
+                        GCancellable *cancellable)
 {
 	GeditOpenDocumentSelectorStore *selector_store = source_object;
 	GeditOpenDocumentSelector *selector;
@@ -678,7 +961,7 @@ update_list_dispatcher (GTask        *task,
 	}
 
 	/* Here we call the corresponding list creator function */
-	file_items_list = (*list_func[type]) (selector_store, selector);
+	file_items_list = (*list_func[type]) (selector_store, selector, cancellable);
 
 	DEBUG_SELECTOR (g_print ("\tStore(%p): store dispatcher: Thread:%p, type:%s, time:%lf\n",
 	                         selector, g_thread_self (), list_type_string[type], DEBUG_SELECTOR_TIMER_GET););
@@ -756,6 +1039,12 @@ gedit_open_document_selector_store_init (GeditOpenDocumentSelectorStore *selecto
 	                         0);
 
 	selector_store->recent_items_need_update = TRUE;
+
+	selector_store->dir_caches = g_hash_table_new_full (g_str_hash,
+	                                                    g_str_equal,
+	                                                    NULL,
+	                                                    (GDestroyNotify)dir_cache_unref);
+	g_queue_init (&selector_store->dir_caches_lru);
 }
 
 gint
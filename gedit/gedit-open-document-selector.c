@@ -58,6 +58,7 @@ struct _GeditOpenDocumentSelector
 	gchar *match_markup_color;
 
 	GeditOpenDocumentSelectorStore *selector_store;
+	GCancellable *cancellable;
 	GList *recent_items;
 	GList *home_dir_items;
 	GList *desktop_dir_items;
@@ -65,7 +66,13 @@ struct _GeditOpenDocumentSelector
 	GList *file_browser_root_items;
 	GList *active_doc_dir_items;
 	GList *current_docs_items;
-	GList *all_items;
+
+	/* All the items of the lists, see rebuild_index() */
+	GPtrArray *index;
+
+	/* Items of the index matching matches_filter, the last filter */
+	GPtrArray *matches;
+	gchar *matches_filter;
 
 	guint populate_liststore_is_idle : 1;
 	guint populate_scheduled : 1;
@@ -108,6 +115,9 @@ static guint signals[LAST_SIGNAL];
 #define OPEN_DOCUMENT_SELECTOR_WIDTH 400
 #define OPEN_DOCUMENT_SELECTOR_MAX_VISIBLE_ROWS 10
 
+/* Rows shown for a filter, the best matches first */
+#define OPEN_DOCUMENT_SELECTOR_MAX_MATCHES 100
+
 G_DEFINE_TYPE (GeditOpenDocumentSelector, gedit_open_document_selector, GTK_TYPE_BOX)
 
 static inline const guint8 *
@@ -307,97 +317,108 @@ create_row (GeditOpenDocumentSelector *selector,
 }
 
 static gint
-sort_items_by_mru (FileItem *a,
-                   FileItem *b,
-                   gpointer  unused G_GNUC_UNUSED)
+sort_items_by_mru (gconstpointer a,
+                   gconstpointer b)
 {
-	glong diff;
-
-	g_assert (a != NULL && b != NULL);
-	diff = b->access_time.tv_sec - a->access_time.tv_sec;
+	const FileItem *item_a = *(FileItem **)a;
+	const FileItem *item_b = *(FileItem **)b;
 
-	if (diff == 0)
+	if (item_a->access_time.tv_sec != item_b->access_time.tv_sec)
 	{
-		return (b->access_time.tv_usec - a->access_time.tv_usec);
-	}
-	else
-	{
-		return diff;
+		return item_b->access_time.tv_sec > item_a->access_time.tv_sec ? 1 : -1;
 	}
+
+	return item_b->access_time.tv_usec - item_a->access_time.tv_usec;
 }
 
-static GList *
-compute_all_items_list (GeditOpenDocumentSelector *selector)
+static void
+clear_matches (GeditOpenDocumentSelector *selector)
 {
-	GList *recent_items;
-	GList *home_dir_items;
-	GList *desktop_dir_items;
-	GList *local_bookmarks_dir_items;
-	GList *file_browser_root_items;
-	GList *active_doc_dir_items;
-	GList *current_docs_items;
-	GList *all_items = NULL;
-
-	/* Copy/concat the whole list */
-	recent_items = gedit_open_document_selector_copy_file_items_list ((const GList *)selector->recent_items);
-	home_dir_items = gedit_open_document_selector_copy_file_items_list ((const GList *)selector->home_dir_items);
-	desktop_dir_items = gedit_open_document_selector_copy_file_items_list ((const GList *)selector->desktop_dir_items);
-	local_bookmarks_dir_items = gedit_open_document_selector_copy_file_items_list ((const GList *)selector->local_bookmarks_dir_items);
-	file_browser_root_items = gedit_open_document_selector_copy_file_items_list ((const GList *)selector->file_browser_root_items);
-	active_doc_dir_items = gedit_open_document_selector_copy_file_items_list ((const GList *)selector->active_doc_dir_items);
-	current_docs_items = gedit_open_document_selector_copy_file_items_list ((const GList *)selector->current_docs_items);
-
-	if (selector->all_items)
+	g_clear_pointer (&selector->matches, g_ptr_array_unref);
+	g_clear_pointer (&selector->matches_filter, g_free);
+}
+
+/* Rebuild the index of all the items, without duplicates and sorted
+ * by MRU. The index does not own the items, they belong to the lists.
+ */
+static void
+rebuild_index (GeditOpenDocumentSelector *selector)
+{
+	GList *lists[] = {
+		selector->recent_items,
+		selector->home_dir_items,
+		selector->desktop_dir_items,
+		selector->local_bookmarks_dir_items,
+		selector->file_browser_root_items,
+		selector->active_doc_dir_items,
+		selector->current_docs_items
+	};
+	GHashTable *positions;
+	guint i;
+
+	clear_matches (selector);
+	g_ptr_array_set_size (selector->index, 0);
+
+	/* uri -> position of the item in the index */
+	positions = g_hash_table_new (g_str_hash, g_str_equal);
+
+	for (i = 0; i < G_N_ELEMENTS (lists); i++)
 	{
-		gedit_open_document_selector_free_file_items_list (selector->all_items);
-		selector->all_items = NULL;
-	}
+		GList *l;
 
-	all_items = g_list_concat (all_items, recent_items);
-	all_items = g_list_concat (all_items, home_dir_items);
-	all_items = g_list_concat (all_items, desktop_dir_items);
-	all_items = g_list_concat (all_items, local_bookmarks_dir_items);
-	all_items = g_list_concat (all_items, file_browser_root_items);
-	all_items = g_list_concat (all_items, active_doc_dir_items);
-	all_items = g_list_concat (all_items, current_docs_items);
+		for (l = lists[i]; l != NULL; l = l->next)
+		{
+			FileItem *item = l->data;
+			gpointer position;
 
-	return all_items;
-}
+			if (item->candidate == NULL)
+			{
+				continue;
+			}
 
-static GList *
-clamp_recent_items_list (GList *recent_items,
-                         gint   limit)
-{
-	GList *recent_items_capped = NULL;
-	GList *l;
-	FileItem *item;
+			if (g_hash_table_lookup_extended (positions, item->uri, NULL, &position))
+			{
+				FileItem **indexed;
 
-	l = recent_items;
-	while (limit > 0 && l != NULL)
-	{
-		item = gedit_open_document_selector_copy_fileitem_item (l->data);
-		recent_items_capped = g_list_prepend (recent_items_capped, item);
-		l = l->next;
-		limit -= 1;
+				/* Keep the most recently accessed of the duplicates */
+				indexed = (FileItem **)&g_ptr_array_index (selector->index, GPOINTER_TO_UINT (position));
+				if (sort_items_by_mru (&item, indexed) < 0)
+				{
+					*indexed = item;
+				}
+
+				continue;
+			}
+
+			g_hash_table_insert (positions, item->uri, GUINT_TO_POINTER (selector->index->len));
+			g_ptr_array_add (selector->index, item);
+		}
 	}
 
-	recent_items_capped = g_list_reverse (recent_items_capped);
-	return recent_items_capped;
+	g_hash_table_destroy (positions);
+
+	g_ptr_array_sort (selector->index, sort_items_by_mru);
+
+	DEBUG_SELECTOR (g_print ("Selector(%p): index rebuilt - length:%u\n",
+	                         selector, selector->index->len););
 }
 
-/* Setup the fileitem, depending uri's scheme
- * Return a string to search in.
+/* Setup the fileitem, depending uri's scheme,
+ * with the string to search in as candidate.
  */
-static gchar *
+static void
 fileitem_setup (FileItem *item)
 {
 	gchar *scheme;
 	gchar *filename;
 	gchar *normalized_filename = NULL;
-	gchar *candidate = NULL;
 	gchar *path;
 	gchar *name;
 
+	g_clear_pointer (&item->path, g_free);
+	g_clear_pointer (&item->name, g_free);
+	g_clear_pointer (&item->candidate, g_free);
+
 	scheme = g_uri_parse_scheme (item->uri);
 	if (g_strcmp0 (scheme, "file") == 0)
 	{
@@ -431,104 +452,166 @@ fileitem_setup (FileItem *item)
 		g_free (parse_name);
 	}
 
-        if (normalized_filename)
+	if (normalized_filename)
 	{
-		candidate = g_utf8_casefold (normalized_filename, -1);
+		const gchar *separator;
+
+		item->candidate = g_utf8_casefold (normalized_filename, -1);
 		g_free (normalized_filename);
+
+		separator = strrchr (item->candidate, G_DIR_SEPARATOR);
+		item->name_offset = separator != NULL ? separator - item->candidate + 1 : 0;
 	}
 
 	g_free (scheme);
-
-	return candidate;
 }
 
-static inline gboolean
-is_filter_in_candidate (const gchar *candidate,
-                        const gchar *filter)
+static void
+fileitem_list_setup (GList *items)
 {
-	gchar *candidate_fold;
-	gboolean ret;
-
-	g_assert (candidate != NULL);
-	g_assert (filter != NULL);
-
-	candidate_fold = g_utf8_casefold (candidate, -1);
-	ret = (strstr (candidate_fold, filter) != NULL);
+	GList *l;
 
-	g_free (candidate_fold);
-	return ret;
+	for (l = items; l != NULL; l = l->next)
+	{
+		fileitem_setup (l->data);
+	}
 }
 
-/* If filter == NULL then items are
- * not checked against the filter.
- */
-static GList *
-fileitem_list_filter (GList       *items,
-                      const gchar *filter)
+/* Matches with a better tier come first in the results */
+typedef enum
 {
-	GList *new_items = NULL;
-	GList *l;
-	gchar *filter_fold = NULL;
+	MATCH_TIER_NAME_PREFIX,
+	MATCH_TIER_NAME,
+	MATCH_TIER_PATH,
+	N_MATCH_TIERS,
+	MATCH_TIER_NONE = N_MATCH_TIERS
+} MatchTier;
+
+static MatchTier
+fileitem_match (const FileItem *item,
+                const gchar    *filter_fold)
+{
+	const gchar *name;
 
-	if (filter != NULL)
-		filter_fold = g_utf8_casefold (filter, -1);
+	/* The name is tested first: the filter can also be found earlier
+	 * in the path, e.g. "foo" in "/home/foo/foo.c".
+	 */
+	name = item->candidate + item->name_offset;
+	if (g_str_has_prefix (name, filter_fold))
+	{
+		return MATCH_TIER_NAME_PREFIX;
+	}
 
-	for (l = items; l != NULL; l = l->next)
+	if (strstr (name, filter_fold) != NULL)
 	{
-		FileItem *item;
-		gchar *candidate;
+		return MATCH_TIER_NAME;
+	}
 
-		item = l->data;
-		candidate = fileitem_setup (item);
-		if (candidate != NULL)
-		{
-			if (filter == NULL || is_filter_in_candidate (candidate, filter_fold))
-			{
-				new_items = g_list_prepend (new_items,
-					                    gedit_open_document_selector_copy_fileitem_item (item));
-			}
+	if (strstr (item->candidate, filter_fold) != NULL)
+	{
+		return MATCH_TIER_PATH;
+	}
 
-			g_free (candidate);
-		}
+	return MATCH_TIER_NONE;
+}
+
+static gchar *
+fold_filter (const gchar *filter)
+{
+	gchar *normalized_filter;
+	gchar *filter_fold;
+
+	normalized_filter = g_utf8_normalize (filter, -1, G_NORMALIZE_ALL);
+	if (normalized_filter == NULL)
+	{
+		return g_utf8_casefold (filter, -1);
 	}
 
-	g_free (filter_fold);
-	new_items = g_list_reverse (new_items);
-	return new_items;
+	filter_fold = g_utf8_casefold (normalized_filter, -1);
+	g_free (normalized_filter);
+
+	return filter_fold;
 }
 
-/* Remove duplicated, the HEAD of the list never change,
- * the list passed in is modified.
+/* Return the best matches of the index for the filter, at most
+ * OPEN_DOCUMENT_SELECTOR_MAX_MATCHES of them, sorted by tier then MRU.
  */
-static void
-fileitem_list_remove_duplicates (GList *items)
+static GPtrArray *
+filter_index (GeditOpenDocumentSelector *selector,
+              const gchar               *filter)
 {
-	GList *l;
-	G_GNUC_UNUSED GList *dummy_ptr;
+	GPtrArray *candidates;
+	GPtrArray *matches;
+	GPtrArray *tiers[N_MATCH_TIERS];
+	GPtrArray *results;
+	gchar *filter_fold;
+	guint i;
+
+	filter_fold = fold_filter (filter);
+
+	/* When the filter is extended, only the previous matches can match */
+	if (selector->matches != NULL &&
+	    g_str_has_prefix (filter_fold, selector->matches_filter))
+	{
+		candidates = selector->matches;
+	}
+	else
+	{
+		candidates = selector->index;
+	}
+
+	matches = g_ptr_array_new ();
+
+	for (i = 0; i < N_MATCH_TIERS; i++)
+	{
+		tiers[i] = g_ptr_array_new ();
+	}
 
-	l = items;
-	while (l != NULL)
+	/* The candidates are sorted by MRU, and so are the tiers */
+	for (i = 0; i < candidates->len; i++)
 	{
-		gchar *l_uri, *l1_uri;
-		GList *l1;
+		FileItem *item = g_ptr_array_index (candidates, i);
+		MatchTier tier;
 
-		if ((l1 = l->next) == NULL)
+		tier = fileitem_match (item, filter_fold);
+		if (tier == MATCH_TIER_NONE)
 		{
-			break;
+			continue;
 		}
 
-		l_uri = ((FileItem *)l->data)->uri;
-		l1_uri = ((FileItem *)l1->data)->uri;
-		if (g_strcmp0 (l_uri, l1_uri) == 0)
+		g_ptr_array_add (matches, item);
+
+		if (tiers[tier]->len < OPEN_DOCUMENT_SELECTOR_MAX_MATCHES)
 		{
-			gedit_open_document_selector_free_fileitem_item ((FileItem *)l1->data);
-			dummy_ptr = g_list_delete_link (items, l1);
+			g_ptr_array_add (tiers[tier], item);
 		}
-		else
+	}
+
+	DEBUG_SELECTOR (g_print ("Selector(%p): filter index - %s:%u, matches:%u\n",
+	                         selector,
+	                         candidates == selector->index ? "index" : "previous matches",
+	                         candidates->len,
+	                         matches->len););
+
+	clear_matches (selector);
+	selector->matches = matches;
+	selector->matches_filter = filter_fold;
+
+	results = g_ptr_array_new ();
+
+	for (i = 0; i < N_MATCH_TIERS; i++)
+	{
+		guint j;
+
+		for (j = 0; j < tiers[i]->len && results->len < OPEN_DOCUMENT_SELECTOR_MAX_MATCHES; j++)
 		{
-			l = l->next;
+			g_ptr_array_add (results, g_ptr_array_index (tiers[i], j));
 		}
+
+		g_ptr_array_unref (tiers[i]);
 	}
+
+	return results;
 }
 
 static gboolean
@@ -536,10 +619,10 @@ real_populate_liststore (gpointer data)
 {
 	GeditOpenDocumentSelector *selector = GEDIT_OPEN_DOCUMENT_SELECTOR (data);
 	GeditOpenDocumentSelectorStore *selector_store;
-	GList *l;
-	GList *filter_items = NULL;
+	GPtrArray *filter_items;
 	gchar *filter;
 	GRegex *filter_regex = NULL;
+	guint i;
 	selector->populate_liststore_is_idle = FALSE;
 
 	DEBUG_SELECTOR_TIMER_DECL
@@ -551,50 +634,54 @@ real_populate_liststore (gpointer data)
 	filter = gedit_open_document_selector_store_get_filter (selector_store);
 	if (filter && *filter != '\0')
 	{
+		gchar *filter_escaped;
+
 		DEBUG_SELECTOR (g_print ("Selector(%p): populate liststore: all lists\n", selector););
 
-		filter_items = fileitem_list_filter (selector->all_items, (const gchar *)filter);
-		filter_items = g_list_sort_with_data (filter_items, (GCompareDataFunc)sort_items_by_mru, NULL);
-		fileitem_list_remove_duplicates (filter_items);
+		filter_items = filter_index (selector, (const gchar *)filter);
 
-		filter_regex = g_regex_new (filter, G_REGEX_CASELESS, 0, NULL);
+		filter_escaped = g_regex_escape_string (filter, -1);
+		filter_regex = g_regex_new (filter_escaped, G_REGEX_CASELESS, 0, NULL);
+		g_free (filter_escaped);
 	}
 	else
 	{
 		gint recent_limit;
-		GList *recent_items;
+		GList *l;
 
 		DEBUG_SELECTOR (g_print ("Selector(%p): populate liststore: recent files list\n", selector););
 
 		recent_limit = gedit_open_document_selector_store_get_recent_limit (selector_store);
+		filter_items = g_ptr_array_new ();
 
-		if (recent_limit > 0 )
-		{
-			recent_items = fileitem_list_filter (selector->recent_items, NULL);
-			filter_items = clamp_recent_items_list (recent_items, recent_limit);
-			gedit_open_document_selector_free_file_items_list (recent_items);
-		}
-		else
+		for (l = selector->recent_items; l != NULL; l = l->next)
 		{
-			filter_items = fileitem_list_filter (selector->recent_items, NULL);
+			FileItem *item = l->data;
+
+			if (recent_limit > 0 && filter_items->len >= (guint)recent_limit)
+			{
+				break;
+			}
+
+			if (item->candidate != NULL)
+			{
+				g_ptr_array_add (filter_items, item);
+			}
 		}
 	}
 
 	g_free (filter);
 
-	DEBUG_SELECTOR (g_print ("Selector(%p): populate liststore: length:%i\n",
-	                         selector, g_list_length (filter_items)););
+	DEBUG_SELECTOR (g_print ("Selector(%p): populate liststore: length:%u\n",
+	                         selector, filter_items->len););
 
 	/* Show the placeholder if no results, show the treeview otherwise */
-	gtk_widget_set_visible (selector->scrolled_window, (filter_items != NULL));
-	gtk_widget_set_visible (selector->placeholder_box, (filter_items == NULL));
+	gtk_widget_set_visible (selector->scrolled_window, (filter_items->len > 0));
+	gtk_widget_set_visible (selector->placeholder_box, (filter_items->len == 0));
 
-	for (l = filter_items; l != NULL; l = l->next)
+	for (i = 0; i < filter_items->len; i++)
 	{
-		FileItem *item;
-
-		item = l->data;
-		create_row (selector, (const FileItem *)item, filter_regex);
+		create_row (selector, g_ptr_array_index (filter_items, i), filter_regex);
 	}
 
 	if (filter_regex)
@@ -602,7 +689,7 @@ real_populate_liststore (gpointer data)
 		g_regex_unref (filter_regex);
 	}
 
-	gedit_open_document_selector_free_file_items_list (filter_items);
+	g_ptr_array_unref (filter_items);
 
 	DEBUG_SELECTOR (g_print ("Selector(%p): populate liststore: time:%lf\n\n",
 	                          selector, DEBUG_SELECTOR_TIMER_GET););
@@ -748,6 +835,12 @@ gedit_open_document_selector_dispose (GObject *object)
 		}
 	}
 
+	if (selector->cancellable != NULL)
+	{
+		g_cancellable_cancel (selector->cancellable);
+		g_clear_object (&selector->cancellable);
+	}
+
 	g_clear_pointer (&selector->name_font, pango_font_description_free);
 	g_clear_pointer (&selector->path_font, pango_font_description_free);
 	g_clear_pointer (&selector->match_markup_color, g_free);
@@ -794,11 +887,8 @@ gedit_open_document_selector_dispose (GObject *object)
 		selector->current_docs_items = NULL;
 	}
 
-	if (selector->all_items)
-	{
-		gedit_open_document_selector_free_file_items_list (selector->all_items);
-		selector->all_items = NULL;
-	}
+	clear_matches (selector);
+	g_clear_pointer (&selector->index, g_ptr_array_unref);
 
 	G_OBJECT_CLASS (gedit_open_document_selector_parent_class)->dispose (object);
 }
@@ -832,12 +922,19 @@ update_list_cb (GeditOpenDocumentSelectorStore *selector_store,
                 gpointer                        user_data G_GNUC_UNUSED)
 {
 	GList *list;
-	GError *error;
+	GError *error = NULL;
 	PushMessage *message;
 	ListType type;
 	GeditOpenDocumentSelector *selector;
 
 	list = gedit_open_document_selector_store_update_list_finish (selector_store, res, &error);
+	if (error != NULL)
+	{
+		/* The selector may be gone if the update was cancelled */
+		g_error_free (error);
+		return;
+	}
+
 	message = g_task_get_task_data (G_TASK (res));
 	selector = message->selector;
 	type = message->type;
@@ -886,7 +983,8 @@ update_list_cb (GeditOpenDocumentSelectorStore *selector_store,
 			g_return_if_reached ();
 	}
 
-	selector->all_items = compute_all_items_list (selector);
+	fileitem_list_setup (list);
+	rebuild_index (selector);
 	populate_liststore (selector);
 }
 
@@ -901,7 +999,7 @@ gedit_open_document_selector_constructed (GObject *object)
 
 	gedit_open_document_selector_store_update_list_async (selector->selector_store,
 	                                                      selector,
-	                                                      NULL,
+	                                                      selector->cancellable,
 	                                                      (GAsyncReadyCallback)update_list_cb,
 	                                                      GEDIT_OPEN_DOCUMENT_SELECTOR_RECENT_FILES_LIST,
 	                                                      selector);
@@ -920,7 +1018,7 @@ gedit_open_document_selector_mapped (GtkWidget *widget)
 	{
 		gedit_open_document_selector_store_update_list_async (selector->selector_store,
 		                                                      selector,
-		                                                      NULL,
+		                                                      selector->cancellable,
 		                                                      (GAsyncReadyCallback)update_list_cb,
 		                                                      list_number,
 		                                                      selector);
@@ -1252,6 +1350,9 @@ gedit_open_document_selector_init (GeditOpenDocumentSelector *selector)
 	gtk_widget_init_template (GTK_WIDGET (selector));
 
 	selector->selector_store = gedit_open_document_selector_store_get_default ();
+	selector->cancellable = g_cancellable_new ();
+
+	selector->index = g_ptr_array_new ();
 
 	selector->liststore = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING);
 	setup_treeview (selector);
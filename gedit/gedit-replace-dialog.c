@@ -50,11 +50,17 @@ struct _GeditReplaceDialog
 	GtkWidget *regex_checkbutton;
 	GtkWidget *backwards_checkbutton;
 	GtkWidget *wrap_around_checkbutton;
+	GtkWidget *all_documents_checkbutton;
 	GtkWidget *close_button;
+	GtkWidget *replace_all_button;
+	GtkWidget *stop_button;
+	GtkWidget *replace_all_progressbar;
 
 	GeditDocument *active_document;
 
 	guint idle_update_sensitivity_id;
+
+	guint replace_all_running : 1;
 };
 
 G_DEFINE_TYPE (GeditReplaceDialog, gedit_replace_dialog, GTK_TYPE_DIALOG)
@@ -273,6 +279,12 @@ update_replace_response_sensitivity_cb (GeditReplaceDialog *dialog)
 	GtkTextIter end;
 	gint pos;
 
+	if (dialog->replace_all_running)
+	{
+		dialog->idle_update_sensitivity_id = 0;
+		return G_SOURCE_REMOVE;
+	}
+
 	if (has_replace_error (dialog))
 	{
 		gtk_dialog_set_response_sensitive (GTK_DIALOG (dialog),
@@ -349,6 +361,11 @@ update_responses_sensitivity (GeditReplaceDialog *dialog)
 	const gchar *search_text;
 	gboolean sensitive = TRUE;
 
+	if (dialog->replace_all_running)
+	{
+		return;
+	}
+
 	install_idle_update_sensitivity (dialog);
 
 	search_text = gtk_entry_get_text (GTK_ENTRY (dialog->search_text_entry));
@@ -382,6 +399,60 @@ update_responses_sensitivity (GeditReplaceDialog *dialog)
 					   sensitive);
 }
 
+/* While a Replace All is running, the Replace All button is replaced by a Stop
+ * button, the progress is shown and the search can not be changed.
+ */
+void
+gedit_replace_dialog_set_replace_all_running (GeditReplaceDialog *dialog,
+					      gboolean            running)
+{
+	g_return_if_fail (GEDIT_IS_REPLACE_DIALOG (dialog));
+
+	running = running != FALSE;
+
+	if (dialog->replace_all_running == running)
+	{
+		return;
+	}
+
+	dialog->replace_all_running = running;
+
+	gtk_widget_set_visible (dialog->replace_all_button, !running);
+	gtk_widget_set_visible (dialog->stop_button, running);
+	gtk_widget_set_visible (dialog->replace_all_progressbar, running);
+	gtk_widget_set_sensitive (dialog->grid, !running);
+
+	if (running)
+	{
+		gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (dialog->replace_all_progressbar), 0.0);
+
+		gtk_dialog_set_response_sensitive (GTK_DIALOG (dialog),
+						   GEDIT_REPLACE_DIALOG_FIND_RESPONSE,
+						   FALSE);
+		gtk_dialog_set_response_sensitive (GTK_DIALOG (dialog),
+						   GEDIT_REPLACE_DIALOG_REPLACE_RESPONSE,
+						   FALSE);
+		gtk_dialog_set_default_response (GTK_DIALOG (dialog),
+						 GEDIT_REPLACE_DIALOG_STOP_RESPONSE);
+	}
+	else
+	{
+		gtk_dialog_set_default_response (GTK_DIALOG (dialog),
+						 GEDIT_REPLACE_DIALOG_FIND_RESPONSE);
+		update_responses_sensitivity (dialog);
+	}
+}
+
+void
+gedit_replace_dialog_set_replace_all_progress (GeditReplaceDialog *dialog,
+					       gdouble             fraction)
+{
+	g_return_if_fail (GEDIT_IS_REPLACE_DIALOG (dialog));
+
+	gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (dialog->replace_all_progressbar),
+				       CLAMP (fraction, 0.0, 1.0));
+}
+
 static void
 regex_error_notify_cb (GeditReplaceDialog *dialog)
 {
@@ -546,7 +617,11 @@ gedit_replace_dialog_class_init (GeditReplaceDialogClass *klass)
 	gtk_widget_class_bind_template_child (widget_class, GeditReplaceDialog, regex_checkbutton);
 	gtk_widget_class_bind_template_child (widget_class, GeditReplaceDialog, backwards_checkbutton);
 	gtk_widget_class_bind_template_child (widget_class, GeditReplaceDialog, wrap_around_checkbutton);
+	gtk_widget_class_bind_template_child (widget_class, GeditReplaceDialog, all_documents_checkbutton);
 	gtk_widget_class_bind_template_child (widget_class, GeditReplaceDialog, close_button);
+	gtk_widget_class_bind_template_child (widget_class, GeditReplaceDialog, replace_all_button);
+	gtk_widget_class_bind_template_child (widget_class, GeditReplaceDialog, stop_button);
+	gtk_widget_class_bind_template_child (widget_class, GeditReplaceDialog, replace_all_progressbar);
 }
 
 static void
@@ -806,6 +881,14 @@ gedit_replace_dialog_get_backwards (GeditReplaceDialog *dialog)
 	return gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (dialog->backwards_checkbutton));
 }
 
+gboolean
+gedit_replace_dialog_get_all_documents (GeditReplaceDialog *dialog)
+{
+	g_return_val_if_fail (GEDIT_IS_REPLACE_DIALOG (dialog), FALSE);
+
+	return gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (dialog->all_documents_checkbutton));
+}
+
 /* This function returns the original search text. The search text from the
  * search settings has been unescaped, and the escape function is not
  * reciprocal. So to avoid bugs, we have to deal with the original search text.
@@ -34,7 +34,8 @@ enum
 {
 	GEDIT_REPLACE_DIALOG_FIND_RESPONSE = 100,
 	GEDIT_REPLACE_DIALOG_REPLACE_RESPONSE,
-	GEDIT_REPLACE_DIALOG_REPLACE_ALL_RESPONSE
+	GEDIT_REPLACE_DIALOG_REPLACE_ALL_RESPONSE,
+	GEDIT_REPLACE_DIALOG_STOP_RESPONSE
 };
 
 GtkWidget		*gedit_replace_dialog_new			(GeditWindow        *window);
@@ -48,9 +49,17 @@ const gchar		*gedit_replace_dialog_get_replace_text		(GeditReplaceDialog *dialog
 
 gboolean		 gedit_replace_dialog_get_backwards		(GeditReplaceDialog *dialog);
 
+gboolean		 gedit_replace_dialog_get_all_documents		(GeditReplaceDialog *dialog);
+
 void			 gedit_replace_dialog_set_replace_error		(GeditReplaceDialog *dialog,
 									 const gchar        *error_msg);
 
+void			 gedit_replace_dialog_set_replace_all_running	(GeditReplaceDialog *dialog,
+									 gboolean            running);
+
+void			 gedit_replace_dialog_set_replace_all_progress	(GeditReplaceDialog *dialog,
+									 gdouble             fraction);
+
 G_END_DECLS
 
 #endif  /* GEDIT_REPLACE_DIALOG_H  */
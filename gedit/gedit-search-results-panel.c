@@ -0,0 +1,990 @@
+/*
+ * gedit-search-results-panel.c
+ * This file is part of gedit
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * gedit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gedit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gedit. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The search results panel shows the matches of a search in all the
+ * documents of a window, grouped per document.
+ *
+ * The text of each document is copied, then searched in a thread, so the
+ * documents are searched in parallel. The matches of a document are added
+ * to the panel as soon as its search is finished.
+ */
+
+#include "gedit-search-results-panel.h"
+
+#include <glib/gi18n.h>
+
+#include "gedit-debug.h"
+#include "gedit-document.h"
+#include "gedit-document-private.h"
+#include "gedit-tab.h"
+#include "gedit-tab-private.h"
+#include "gedit-view.h"
+
+/* Beyond this, the matches of a document are not all shown */
+#define MAX_MATCHES_PER_DOCUMENT 1000
+
+/* Context kept around a match in its line */
+#define MAX_PREFIX_CHARS 40
+#define MAX_MATCH_CHARS 80
+#define MAX_SUFFIX_CHARS 80
+
+enum
+{
+	COLUMN_MARKUP,
+	COLUMN_DOCUMENT,
+	COLUMN_LINE,
+	COLUMN_LINE_OFFSET,
+	COLUMN_LENGTH,
+	N_COLUMNS
+};
+
+struct _GeditSearchResultsPanel
+{
+	GtkBox parent_instance;
+
+	GeditWindow *window;
+
+	GtkWidget *status_label;
+	GtkWidget *treeview;
+	GtkTreeStore *store;
+
+	/* The current search */
+	GCancellable *cancellable;
+	GRegex *regex;
+	gint n_pending_documents;
+	gint n_matches;
+
+	/* The tabs of the search still loading their document */
+	GList *loading_tabs;
+
+	/* The documents which could not be searched */
+	gint n_not_searched;
+};
+
+enum
+{
+	PROP_0,
+	PROP_WINDOW,
+	LAST_PROP
+};
+
+static GParamSpec *properties[LAST_PROP];
+
+G_DEFINE_TYPE (GeditSearchResultsPanel, gedit_search_results_panel, GTK_TYPE_BOX)
+
+typedef struct
+{
+	gint line;
+	gint line_offset;
+	gint length;
+	gchar *markup;
+} Match;
+
+typedef struct
+{
+	GRegex *regex;
+	gchar *text;
+	gboolean truncated;
+} SearchData;
+
+static void
+match_free (Match *match)
+{
+	g_free (match->markup);
+	g_slice_free (Match, match);
+}
+
+static void
+search_data_free (SearchData *data)
+{
+	g_regex_unref (data->regex);
+	g_free (data->text);
+	g_slice_free (SearchData, data);
+}
+
+static GRegex *
+create_regex (GtkSourceSearchSettings  *settings,
+	      GError                  **error)
+{
+	const gchar *search_text;
+	GRegexCompileFlags flags = G_REGEX_MULTILINE;
+	gchar *pattern;
+	GRegex *regex;
+
+	search_text = gtk_source_search_settings_get_search_text (settings);
+
+	if (gtk_source_search_settings_get_regex_enabled (settings))
+	{
+		pattern = g_strdup (search_text);
+	}
+	else
+	{
+		/* The text has already been unescaped */
+		pattern = g_regex_escape_string (search_text, -1);
+	}
+
+	if (gtk_source_search_settings_get_at_word_boundaries (settings))
+	{
+		gchar *tmp = pattern;
+
+		pattern = g_strdup_printf ("\\b(?:%s)\\b", tmp);
+		g_free (tmp);
+	}
+
+	if (!gtk_source_search_settings_get_case_sensitive (settings))
+	{
+		flags |= G_REGEX_CASELESS;
+	}
+
+	regex = g_regex_new (pattern, flags, 0, error);
+	g_free (pattern);
+
+	return regex;
+}
+
+/* The line of the match with the match in bold, the text around the match
+ * is truncated.
+ */
+static gchar *
+get_match_markup (const gchar *line_start,
+		  const gchar *line_end,
+		  const gchar *match_start,
+		  const gchar *match_end)
+{
+	const gchar *prefix;
+	const gchar *suffix_end;
+	gchar *escaped_prefix;
+	gchar *escaped_match;
+	gchar *escaped_suffix;
+	gchar *markup;
+
+	match_end = MIN (match_end, line_end);
+
+	prefix = line_start;
+	if (g_utf8_strlen (line_start, match_start - line_start) > MAX_PREFIX_CHARS)
+	{
+		prefix = g_utf8_offset_to_pointer (match_start, -MAX_PREFIX_CHARS);
+	}
+
+	while (prefix < match_start && g_ascii_isspace (*prefix))
+	{
+		prefix++;
+	}
+
+	if (g_utf8_strlen (match_start, match_end - match_start) > MAX_MATCH_CHARS)
+	{
+		match_end = g_utf8_offset_to_pointer (match_start, MAX_MATCH_CHARS);
+	}
+
+	suffix_end = line_end;
+	if (g_utf8_strlen (match_end, line_end - match_end) > MAX_SUFFIX_CHARS)
+	{
+		suffix_end = g_utf8_offset_to_pointer (match_end, MAX_SUFFIX_CHARS);
+	}
+
+	escaped_prefix = g_markup_escape_text (prefix, match_start - prefix);
+	escaped_match = g_markup_escape_text (match_start, match_end - match_start);
+	escaped_suffix = g_markup_escape_text (match_end, suffix_end - match_end);
+
+	markup = g_strdup_printf ("%s%s<b>%s</b>%s%s",
+				  prefix != line_start ? "…" : "",
+				  escaped_prefix,
+				  escaped_match,
+				  escaped_suffix,
+				  suffix_end != line_end ? "…" : "");
+
+	g_free (escaped_prefix);
+	g_free (escaped_match);
+	g_free (escaped_suffix);
+
+	return markup;
+}
+
+static const gchar *
+find_line_end (const gchar *p)
+{
+	while (*p != '\0' && *p != '\n' && *p != '\r')
+	{
+		p++;
+	}
+
+	return p;
+}
+
+/* Runs in a thread */
+static void
+search_thread (GTask        *task,
+	       gpointer      source_object,
+	       gpointer      task_data,
+	       GCancellable *cancellable)
+{
+	SearchData *data = task_data;
+	GPtrArray *matches;
+	GMatchInfo *match_info;
+	const gchar *line_start;
+	const gchar *p;
+	gint line = 0;
+
+	matches = g_ptr_array_new_with_free_func ((GDestroyNotify) match_free);
+
+	line_start = data->text;
+	p = data->text;
+
+	g_regex_match (data->regex, data->text, 0, &match_info);
+
+	while (g_match_info_matches (match_info))
+	{
+		gint start_pos;
+		gint end_pos;
+		const gchar *match_start;
+		Match *match;
+
+		if (g_cancellable_is_cancelled (cancellable))
+		{
+			break;
+		}
+
+		g_match_info_fetch_pos (match_info, 0, &start_pos, &end_pos);
+
+		/* Empty matches are useless in the results */
+		if (start_pos == end_pos)
+		{
+			g_match_info_next (match_info, NULL);
+			continue;
+		}
+
+		if (matches->len == MAX_MATCHES_PER_DOCUMENT)
+		{
+			data->truncated = TRUE;
+			break;
+		}
+
+		match_start = data->text + start_pos;
+
+		/* Count the lines up to the match, like GtkTextBuffer does:
+		 * "\r\n" is one line terminator.
+		 */
+		for (; p < match_start; p++)
+		{
+			if (*p == '\n' ||
+			    (*p == '\r' && p[1] != '\n'))
+			{
+				line++;
+				line_start = p + 1;
+			}
+		}
+
+		match = g_slice_new (Match);
+		match->line = line;
+		match->line_offset = g_utf8_strlen (line_start, match_start - line_start);
+		match->length = g_utf8_strlen (match_start, end_pos - start_pos);
+		match->markup = get_match_markup (line_start,
+						  find_line_end (match_start),
+						  match_start,
+						  data->text + end_pos);
+
+		g_ptr_array_add (matches, match);
+
+		g_match_info_next (match_info, NULL);
+	}
+
+	g_match_info_free (match_info);
+
+	if (g_task_return_error_if_cancelled (task))
+	{
+		g_ptr_array_unref (matches);
+		return;
+	}
+
+	g_task_return_pointer (task, matches, (GDestroyNotify) g_ptr_array_unref);
+}
+
+static gboolean
+is_tab_loading (GeditTab *tab)
+{
+	GeditTabState state = gedit_tab_get_state (tab);
+
+	return state == GEDIT_TAB_STATE_LOADING ||
+	       state == GEDIT_TAB_STATE_REVERTING;
+}
+
+static gboolean
+can_search_document (GeditDocument *doc)
+{
+	GeditTab *tab;
+
+	/* The text of these documents is not, or not completely, in the
+	 * buffer.
+	 */
+	if (_gedit_document_get_loading_deferred (doc) ||
+	    _gedit_document_get_large_file (doc) != NULL)
+	{
+		return FALSE;
+	}
+
+	tab = gedit_tab_get_from_document (doc);
+
+	if (tab == NULL)
+	{
+		return FALSE;
+	}
+
+	switch (gedit_tab_get_state (tab))
+	{
+		case GEDIT_TAB_STATE_LOADING:
+		case GEDIT_TAB_STATE_REVERTING:
+		case GEDIT_TAB_STATE_LOADING_ERROR:
+		case GEDIT_TAB_STATE_REVERTING_ERROR:
+		case GEDIT_TAB_STATE_CLOSING:
+			return FALSE;
+
+		default:
+			return TRUE;
+	}
+}
+
+static void
+update_status (GeditSearchResultsPanel *panel)
+{
+	gchar *matches;
+	gchar *status;
+
+	if (panel->n_pending_documents > 0)
+	{
+		gtk_label_set_text (GTK_LABEL (panel->status_label), _("Searching…"));
+		return;
+	}
+
+	if (panel->n_matches == 0)
+	{
+		matches = g_strdup (_("No matches found"));
+	}
+	else
+	{
+		matches = g_strdup_printf (ngettext ("Found %d match",
+						     "Found %d matches",
+						     panel->n_matches),
+					   panel->n_matches);
+	}
+
+	if (panel->n_not_searched == 0)
+	{
+		gtk_label_set_text (GTK_LABEL (panel->status_label), matches);
+		g_free (matches);
+		return;
+	}
+
+	/* Translators: the first %s is "Found 3 matches" or "No matches
+	 * found", %d is a number of documents.
+	 */
+	status = g_strdup_printf (ngettext ("%s, %d document could not be searched",
+					    "%s, %d documents could not be searched",
+					    panel->n_not_searched),
+				  matches,
+				  panel->n_not_searched);
+
+	gtk_label_set_text (GTK_LABEL (panel->status_label), status);
+
+	g_free (matches);
+	g_free (status);
+}
+
+static void
+add_document_matches (GeditSearchResultsPanel *panel,
+		      GeditDocument           *doc,
+		      GPtrArray               *matches,
+		      gboolean                 truncated)
+{
+	GtkTreeIter doc_iter;
+	GtkTreePath *path;
+	gchar *name;
+	gchar *escaped_name;
+	gchar *markup;
+	guint i;
+
+	gtk_tree_store_append (panel->store, &doc_iter, NULL);
+
+	name = gedit_document_get_short_name_for_display (doc);
+	escaped_name = g_markup_escape_text (name, -1);
+
+	if (truncated)
+	{
+		markup = g_strdup_printf ("<b>%s</b> (%u+)", escaped_name, matches->len);
+	}
+	else
+	{
+		markup = g_strdup_printf ("<b>%s</b> (%u)", escaped_name, matches->len);
+	}
+
+	gtk_tree_store_set (panel->store, &doc_iter,
+			    COLUMN_MARKUP, markup,
+			    COLUMN_DOCUMENT, doc,
+			    COLUMN_LINE, -1,
+			    -1);
+
+	g_free (name);
+	g_free (escaped_name);
+	g_free (markup);
+
+	for (i = 0; i < matches->len; i++)
+	{
+		Match *match = g_ptr_array_index (matches, i);
+		GtkTreeIter iter;
+
+		markup = g_strdup_printf ("%d: %s", match->line + 1, match->markup);
+
+		gtk_tree_store_insert_with_values (panel->store, &iter, &doc_iter, -1,
+						   COLUMN_MARKUP, markup,
+						   COLUMN_DOCUMENT, doc,
+						   COLUMN_LINE, match->line,
+						   COLUMN_LINE_OFFSET, match->line_offset,
+						   COLUMN_LENGTH, match->length,
+						   -1);
+
+		g_free (markup);
+	}
+
+	path = gtk_tree_model_get_path (GTK_TREE_MODEL (panel->store), &doc_iter);
+	gtk_tree_view_expand_row (GTK_TREE_VIEW (panel->treeview), path, FALSE);
+	gtk_tree_path_free (path);
+
+	panel->n_matches += matches->len;
+}
+
+static void
+search_document_cb (GeditDocument           *doc,
+		    GAsyncResult            *result,
+		    GeditSearchResultsPanel *panel)
+{
+	GPtrArray *matches;
+	GError *error = NULL;
+
+	matches = g_task_propagate_pointer (G_TASK (result), &error);
+
+	/* A cancelled search has been replaced by another one, or the
+	 * panel has been destroyed.
+	 */
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+	{
+		g_error_free (error);
+		g_object_unref (panel);
+		return;
+	}
+
+	if (error != NULL)
+	{
+		g_warning ("Search error: %s", error->message);
+		g_error_free (error);
+	}
+	else
+	{
+		SearchData *data = g_task_get_task_data (G_TASK (result));
+
+		if (matches->len > 0)
+		{
+			add_document_matches (panel, doc, matches, data->truncated);
+		}
+
+		g_ptr_array_unref (matches);
+	}
+
+	panel->n_pending_documents--;
+	update_status (panel);
+
+	g_object_unref (panel);
+}
+
+static void
+search_document (GeditSearchResultsPanel *panel,
+		 GeditDocument           *doc,
+		 GRegex                  *regex)
+{
+	GtkTextIter start;
+	GtkTextIter end;
+	SearchData *data;
+	GTask *task;
+
+	/* The buffer can only be used in the main thread, so the search
+	 * is done on a copy of its text.
+	 */
+	data = g_slice_new0 (SearchData);
+	data->regex = g_regex_ref (regex);
+
+	gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (doc), &start, &end);
+	data->text = gtk_text_buffer_get_text (GTK_TEXT_BUFFER (doc), &start, &end, TRUE);
+
+	task = g_task_new (doc,
+			   panel->cancellable,
+			   (GAsyncReadyCallback) search_document_cb,
+			   g_object_ref (panel));
+
+	g_task_set_task_data (task, data, (GDestroyNotify) search_data_free);
+	g_task_run_in_thread (task, search_thread);
+	g_object_unref (task);
+
+	panel->n_pending_documents++;
+}
+
+static void tab_state_changed_cb (GeditTab                *tab,
+				  GParamSpec              *pspec,
+				  GeditSearchResultsPanel *panel);
+
+static void
+stop_waiting_for_tab (GeditSearchResultsPanel *panel,
+		      GList                   *link)
+{
+	GeditTab *tab = link->data;
+
+	g_signal_handlers_disconnect_by_func (tab, tab_state_changed_cb, panel);
+	g_object_unref (tab);
+
+	panel->loading_tabs = g_list_delete_link (panel->loading_tabs, link);
+	panel->n_pending_documents--;
+}
+
+static void
+tab_state_changed_cb (GeditTab                *tab,
+		      GParamSpec              *pspec,
+		      GeditSearchResultsPanel *panel)
+{
+	GeditDocument *doc;
+
+	if (is_tab_loading (tab))
+	{
+		return;
+	}
+
+	stop_waiting_for_tab (panel, g_list_find (panel->loading_tabs, tab));
+
+	doc = gedit_tab_get_document (tab);
+
+	if (can_search_document (doc))
+	{
+		search_document (panel, doc, panel->regex);
+	}
+	else
+	{
+		panel->n_not_searched++;
+	}
+
+	update_status (panel);
+}
+
+/* The documents of the tabs not shown yet are loaded to be searched */
+static void
+wait_for_tab (GeditSearchResultsPanel *panel,
+	      GeditTab                *tab)
+{
+	panel->loading_tabs = g_list_prepend (panel->loading_tabs, g_object_ref (tab));
+	panel->n_pending_documents++;
+
+	g_signal_connect (tab,
+			  "notify::state",
+			  G_CALLBACK (tab_state_changed_cb),
+			  panel);
+
+	_gedit_tab_start_deferred_loading (tab);
+}
+
+static void
+cancel_search (GeditSearchResultsPanel *panel)
+{
+	if (panel->cancellable != NULL)
+	{
+		g_cancellable_cancel (panel->cancellable);
+		g_clear_object (&panel->cancellable);
+	}
+
+	while (panel->loading_tabs != NULL)
+	{
+		stop_waiting_for_tab (panel, panel->loading_tabs);
+	}
+
+	g_clear_pointer (&panel->regex, g_regex_unref);
+
+	panel->n_pending_documents = 0;
+	panel->n_matches = 0;
+	panel->n_not_searched = 0;
+}
+
+/**
+ * gedit_search_results_panel_search:
+ * @panel: a #GeditSearchResultsPanel.
+ * @settings: the search settings.
+ *
+ * Searches all the documents of the window of @panel, replacing the results
+ * of the previous search. The documents of the tabs not shown yet are loaded
+ * first.
+ */
+void
+gedit_search_results_panel_search (GeditSearchResultsPanel *panel,
+				   GtkSourceSearchSettings *settings)
+{
+	GRegex *regex;
+	GList *docs;
+	GList *l;
+	GError *error = NULL;
+
+	g_return_if_fail (GEDIT_IS_SEARCH_RESULTS_PANEL (panel));
+	g_return_if_fail (GTK_SOURCE_IS_SEARCH_SETTINGS (settings));
+
+	gedit_debug (DEBUG_PANEL);
+
+	cancel_search (panel);
+	gtk_tree_store_clear (panel->store);
+
+	regex = create_regex (settings, &error);
+
+	if (regex == NULL)
+	{
+		gtk_label_set_text (GTK_LABEL (panel->status_label), error->message);
+		g_error_free (error);
+		return;
+	}
+
+	panel->cancellable = g_cancellable_new ();
+	panel->regex = regex;
+
+	docs = gedit_window_get_documents (panel->window);
+
+	for (l = docs; l != NULL; l = l->next)
+	{
+		GeditDocument *doc = l->data;
+		GeditTab *tab = gedit_tab_get_from_document (doc);
+
+		if (tab != NULL &&
+		    (_gedit_document_get_loading_deferred (doc) || is_tab_loading (tab)))
+		{
+			wait_for_tab (panel, tab);
+		}
+		else if (can_search_document (doc))
+		{
+			search_document (panel, doc, regex);
+		}
+		else
+		{
+			panel->n_not_searched++;
+		}
+	}
+
+	g_list_free (docs);
+
+	update_status (panel);
+}
+
+static gboolean
+remove_document_row (GeditSearchResultsPanel *panel,
+		     GeditDocument           *doc)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (panel->store);
+	GtkTreeIter iter;
+	gboolean valid;
+
+	valid = gtk_tree_model_get_iter_first (model, &iter);
+
+	while (valid)
+	{
+		GeditDocument *row_doc;
+		gint n_matches;
+
+		gtk_tree_model_get (model, &iter, COLUMN_DOCUMENT, &row_doc, -1);
+
+		if (row_doc == doc)
+		{
+			n_matches = gtk_tree_model_iter_n_children (model, &iter);
+			gtk_tree_store_remove (panel->store, &iter);
+			g_object_unref (row_doc);
+
+			panel->n_matches -= n_matches;
+			return TRUE;
+		}
+
+		g_object_unref (row_doc);
+		valid = gtk_tree_model_iter_next (model, &iter);
+	}
+
+	return FALSE;
+}
+
+static void
+tab_removed_cb (GeditWindow             *window,
+		GeditTab                *tab,
+		GeditSearchResultsPanel *panel)
+{
+	GList *link;
+
+	link = g_list_find (panel->loading_tabs, tab);
+
+	if (link != NULL)
+	{
+		stop_waiting_for_tab (panel, link);
+		update_status (panel);
+	}
+
+	/* The rows keep a reference on the document */
+	if (remove_document_row (panel, gedit_tab_get_document (tab)))
+	{
+		update_status (panel);
+	}
+}
+
+static void
+row_activated_cb (GtkTreeView             *treeview,
+		  GtkTreePath             *path,
+		  GtkTreeViewColumn       *column,
+		  GeditSearchResultsPanel *panel)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (panel->store);
+	GtkTreeIter iter;
+	GeditDocument *doc;
+	GeditTab *tab;
+	GeditView *view;
+	GtkWidget *toplevel;
+	GtkTextIter start;
+	GtkTextIter end;
+	gint line;
+	gint line_offset;
+	gint length;
+
+	if (!gtk_tree_model_get_iter (model, &iter, path))
+	{
+		return;
+	}
+
+	gtk_tree_model_get (model, &iter,
+			    COLUMN_DOCUMENT, &doc,
+			    COLUMN_LINE, &line,
+			    COLUMN_LINE_OFFSET, &line_offset,
+			    COLUMN_LENGTH, &length,
+			    -1);
+
+	if (line < 0)
+	{
+		if (gtk_tree_view_row_expanded (treeview, path))
+		{
+			gtk_tree_view_collapse_row (treeview, path);
+		}
+		else
+		{
+			gtk_tree_view_expand_row (treeview, path, FALSE);
+		}
+
+		g_object_unref (doc);
+		return;
+	}
+
+	tab = gedit_tab_get_from_document (doc);
+
+	/* The document may have been edited since the search */
+	if (tab == NULL ||
+	    line >= gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc)))
+	{
+		g_object_unref (doc);
+		return;
+	}
+
+	/* The tab may have been moved to another window */
+	toplevel = gtk_widget_get_toplevel (GTK_WIDGET (tab));
+	if (GEDIT_IS_WINDOW (toplevel))
+	{
+		gedit_window_set_active_tab (GEDIT_WINDOW (toplevel), tab);
+		gtk_window_present (GTK_WINDOW (toplevel));
+	}
+
+	gtk_text_buffer_get_iter_at_line (GTK_TEXT_BUFFER (doc), &start, line);
+
+	if (line_offset <= gtk_text_iter_get_chars_in_line (&start))
+	{
+		gtk_text_iter_set_line_offset (&start, line_offset);
+	}
+
+	end = start;
+	gtk_text_iter_forward_chars (&end, length);
+
+	gtk_text_buffer_select_range (GTK_TEXT_BUFFER (doc), &start, &end);
+
+	view = gedit_tab_get_view (tab);
+	gedit_view_scroll_to_cursor (view);
+	gtk_widget_grab_focus (GTK_WIDGET (view));
+
+	g_object_unref (doc);
+}
+
+static void
+gedit_search_results_panel_set_property (GObject      *object,
+					 guint         prop_id,
+					 const GValue *value,
+					 GParamSpec   *pspec)
+{
+	GeditSearchResultsPanel *panel = GEDIT_SEARCH_RESULTS_PANEL (object);
+
+	switch (prop_id)
+	{
+		case PROP_WINDOW:
+			panel->window = g_value_get_object (value);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+gedit_search_results_panel_get_property (GObject    *object,
+					 guint       prop_id,
+					 GValue     *value,
+					 GParamSpec *pspec)
+{
+	GeditSearchResultsPanel *panel = GEDIT_SEARCH_RESULTS_PANEL (object);
+
+	switch (prop_id)
+	{
+		case PROP_WINDOW:
+			g_value_set_object (value, panel->window);
+			break;
+
+		default:
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+			break;
+	}
+}
+
+static void
+gedit_search_results_panel_constructed (GObject *object)
+{
+	GeditSearchResultsPanel *panel = GEDIT_SEARCH_RESULTS_PANEL (object);
+
+	G_OBJECT_CLASS (gedit_search_results_panel_parent_class)->constructed (object);
+
+	/* The panel is destroyed with the window */
+	g_signal_connect_object (panel->window,
+				 "tab-removed",
+				 G_CALLBACK (tab_removed_cb),
+				 panel,
+				 0);
+}
+
+static void
+gedit_search_results_panel_dispose (GObject *object)
+{
+	GeditSearchResultsPanel *panel = GEDIT_SEARCH_RESULTS_PANEL (object);
+
+	cancel_search (panel);
+
+	if (panel->store != NULL)
+	{
+		gtk_tree_store_clear (panel->store);
+		g_clear_object (&panel->store);
+	}
+
+	G_OBJECT_CLASS (gedit_search_results_panel_parent_class)->dispose (object);
+}
+
+static void
+gedit_search_results_panel_class_init (GeditSearchResultsPanelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->constructed = gedit_search_results_panel_constructed;
+	object_class->dispose = gedit_search_results_panel_dispose;
+	object_class->get_property = gedit_search_results_panel_get_property;
+	object_class->set_property = gedit_search_results_panel_set_property;
+
+	properties[PROP_WINDOW] =
+		g_param_spec_object ("window",
+		                     "Window",
+		                     "The GeditWindow this GeditSearchResultsPanel is associated with",
+		                     GEDIT_TYPE_WINDOW,
+		                     G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties (object_class, LAST_PROP, properties);
+}
+
+static void
+gedit_search_results_panel_init (GeditSearchResultsPanel *panel)
+{
+	GtkWidget *sw;
+	GtkCellRenderer *renderer;
+	GtkTreeViewColumn *column;
+
+	gedit_debug (DEBUG_PANEL);
+
+	gtk_orientable_set_orientation (GTK_ORIENTABLE (panel),
+	                                GTK_ORIENTATION_VERTICAL);
+
+	panel->status_label = gtk_label_new (NULL);
+	gtk_label_set_xalign (GTK_LABEL (panel->status_label), 0.0);
+	gtk_label_set_ellipsize (GTK_LABEL (panel->status_label), PANGO_ELLIPSIZE_END);
+	gtk_widget_set_margin_start (panel->status_label, 6);
+	gtk_widget_set_margin_end (panel->status_label, 6);
+	gtk_widget_set_margin_top (panel->status_label, 3);
+	gtk_widget_set_margin_bottom (panel->status_label, 3);
+	gtk_widget_show (panel->status_label);
+	gtk_box_pack_start (GTK_BOX (panel), panel->status_label, FALSE, FALSE, 0);
+
+	sw = gtk_scrolled_window_new (NULL, NULL);
+
+	gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw),
+	                                GTK_POLICY_AUTOMATIC,
+	                                GTK_POLICY_AUTOMATIC);
+	gtk_widget_show (sw);
+	gtk_box_pack_start (GTK_BOX (panel), sw, TRUE, TRUE, 0);
+
+	panel->store = gtk_tree_store_new (N_COLUMNS,
+					   G_TYPE_STRING,
+					   GEDIT_TYPE_DOCUMENT,
+					   G_TYPE_INT,
+					   G_TYPE_INT,
+					   G_TYPE_INT);
+
+	panel->treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (panel->store));
+	gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (panel->treeview), FALSE);
+	gtk_tree_view_set_enable_search (GTK_TREE_VIEW (panel->treeview), FALSE);
+	gtk_tree_view_set_activate_on_single_click (GTK_TREE_VIEW (panel->treeview), TRUE);
+
+	renderer = gtk_cell_renderer_text_new ();
+	g_object_set (renderer, "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+	column = gtk_tree_view_column_new_with_attributes (NULL,
+							   renderer,
+							   "markup", COLUMN_MARKUP,
+							   NULL);
+	gtk_tree_view_append_column (GTK_TREE_VIEW (panel->treeview), column);
+
+	g_signal_connect (panel->treeview,
+			  "row-activated",
+			  G_CALLBACK (row_activated_cb),
+			  panel);
+
+	gtk_widget_show (panel->treeview);
+	gtk_container_add (GTK_CONTAINER (sw), panel->treeview);
+}
+
+GtkWidget *
+gedit_search_results_panel_new (GeditWindow *window)
+{
+	g_return_val_if_fail (GEDIT_IS_WINDOW (window), NULL);
+
+	return g_object_new (GEDIT_TYPE_SEARCH_RESULTS_PANEL,
+	                     "window", window,
+	                     NULL);
+}
+
+/* ex:set ts=8 noet: */
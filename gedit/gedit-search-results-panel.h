@@ -0,0 +1,44 @@
+/*
+ * gedit-search-results-panel.h
+ * This file is part of gedit
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * gedit is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * gedit is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gedit. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GEDIT_SEARCH_RESULTS_PANEL_H
+#define GEDIT_SEARCH_RESULTS_PANEL_H
+
+#include <gtk/gtk.h>
+#include <gtksourceview/gtksource.h>
+
+#include <gedit/gedit-window.h>
+
+G_BEGIN_DECLS
+
+#define GEDIT_TYPE_SEARCH_RESULTS_PANEL (gedit_search_results_panel_get_type ())
+
+G_DECLARE_FINAL_TYPE (GeditSearchResultsPanel, gedit_search_results_panel, GEDIT, SEARCH_RESULTS_PANEL, GtkBox)
+
+GtkWidget	*gedit_search_results_panel_new		(GeditWindow             *window);
+
+void		 gedit_search_results_panel_search	(GeditSearchResultsPanel *panel,
+							 GtkSourceSearchSettings *settings);
+
+G_END_DECLS
+
+#endif  /* GEDIT_SEARCH_RESULTS_PANEL_H  */
+
+/* ex:set ts=8 noet: */
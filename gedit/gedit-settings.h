@@ -70,6 +70,8 @@ void			 gedit_settings_set_list			(GSettings     *settings,
 #define GEDIT_SETTINGS_RIGHT_MARGIN_POSITION		"right-margin-position"
 #define GEDIT_SETTINGS_SMART_HOME_END			"smart-home-end"
 #define GEDIT_SETTINGS_RESTORE_CURSOR_POSITION		"restore-cursor-position"
+#define GEDIT_SETTINGS_MAX_METADATA_ITEMS		"max-metadata-items"
+#define GEDIT_SETTINGS_LARGE_FILE_THRESHOLD		"large-file-threshold"
 #define GEDIT_SETTINGS_SYNTAX_HIGHLIGHTING		"syntax-highlighting"
 #define GEDIT_SETTINGS_SEARCH_HIGHLIGHTING		"search-highlighting"
 #define GEDIT_SETTINGS_TOOLBAR_VISIBLE			"toolbar-visible"
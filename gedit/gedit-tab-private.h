@@ -41,6 +41,15 @@ void		 _gedit_tab_load			(GeditTab                *tab,
 							 gint                     column_pos,
 							 gboolean                 create);
 
+void		 _gedit_tab_load_deferred		(GeditTab                *tab,
+							 GFile                   *location,
+							 const GtkSourceEncoding *encoding,
+							 gint                     line_pos,
+							 gint                     column_pos,
+							 gboolean                 create);
+
+void		 _gedit_tab_start_deferred_loading	(GeditTab                *tab);
+
 void		 _gedit_tab_load_stream			(GeditTab                *tab,
 							 GInputStream            *location,
 							 const GtkSourceEncoding *encoding,
@@ -77,6 +86,8 @@ GeditViewFrame	*_gedit_tab_get_view_frame		(GeditTab                 *tab);
 void		 _gedit_tab_set_network_available	(GeditTab	     *tab,
 							 gboolean	     enable);
 
+void		 _gedit_tab_show_large_file_saving_error (GeditTab	     *tab);
+
 G_END_DECLS
 
 #endif  /* GEDIT_TAB_PRIVATE_H */
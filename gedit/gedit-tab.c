@@ -42,6 +42,19 @@
 
 #define GEDIT_TAB_KEY "GEDIT_TAB_KEY"
 
+/* The number of files loaded at the same time. The other loadings wait in
+ * loading_queue, so that opening many files at once doesn't thrash the
+ * disk and the main loop.
+ */
+#define MAX_CONCURRENT_LOADINGS 4
+
+/* Bytes read to sniff the content type of a file before loading it, as
+ * much as GIO reads to query it.
+ */
+#define CONTENT_TYPE_SNIFF_SIZE 4096
+
+typedef struct _DeferredLoading DeferredLoading;
+
 struct _GeditTab
 {
 	GtkBox parent_instance;
@@ -60,7 +73,11 @@ struct _GeditTab
 
 	GtkSourceFileSaverFlags save_flags;
 
+	/* The loading to start when the tab is first shown */
+	DeferredLoading *deferred_loading;
+
 	guint idle_scroll;
+	guint idle_large_file_page;
 
 	gint auto_save_interval;
 	guint auto_save_timeout;
@@ -101,13 +118,26 @@ struct _SaverData
 	guint force_no_backup : 1;
 };
 
+struct _DeferredLoading
+{
+	GFile *location;
+	const GtkSourceEncoding *encoding;
+	gint line_pos;
+	gint column_pos;
+	guint create : 1;
+};
+
 struct _LoaderData
 {
 	GtkSourceFileLoader *loader;
 	GTimer *timer;
+	const GtkSourceEncoding *encoding;
 	gint line_pos;
 	gint column_pos;
 	guint user_requested_encoding : 1;
+
+	/* Whether the loading counts in n_running_loadings */
+	guint running : 1;
 };
 
 G_DEFINE_TYPE (GeditTab, gedit_tab, GTK_TYPE_BOX)
@@ -133,6 +163,10 @@ enum
 
 static guint signals[LAST_SIGNAL];
 
+/* The loading tasks waiting for a free slot */
+static GQueue loading_queue = G_QUEUE_INIT;
+static guint n_running_loadings = 0;
+
 static gboolean gedit_tab_auto_save (GeditTab *tab);
 
 static void launch_loader (GTask                   *loading_task,
@@ -140,6 +174,8 @@ static void launch_loader (GTask                   *loading_task,
 
 static void launch_saver (GTask *saving_task);
 
+static void start_queued_loading (GeditTab *tab);
+
 static SaverData *
 saver_data_new (void)
 {
@@ -190,6 +226,16 @@ loader_data_free (LoaderData *data)
 	}
 }
 
+static void
+deferred_loading_free (DeferredLoading *deferred_loading)
+{
+	if (deferred_loading != NULL)
+	{
+		g_object_unref (deferred_loading->location);
+		g_slice_free (DeferredLoading, deferred_loading);
+	}
+}
+
 static void
 set_editable (GeditTab *tab,
 	      gboolean  editable)
@@ -325,6 +371,8 @@ gedit_tab_dispose (GObject *object)
 	g_clear_object (&tab->print_job);
 	g_clear_object (&tab->print_preview);
 
+	g_clear_pointer (&tab->deferred_loading, deferred_loading_free);
+
 	remove_auto_save_timeout (tab);
 
 	if (tab->idle_scroll != 0)
@@ -333,9 +381,28 @@ gedit_tab_dispose (GObject *object)
 		tab->idle_scroll = 0;
 	}
 
+	if (tab->idle_large_file_page != 0)
+	{
+		g_source_remove (tab->idle_large_file_page);
+		tab->idle_large_file_page = 0;
+	}
+
 	G_OBJECT_CLASS (gedit_tab_parent_class)->dispose (object);
 }
 
+static void
+gedit_tab_map (GtkWidget *widget)
+{
+	GeditTab *tab = GEDIT_TAB (widget);
+
+	GTK_WIDGET_CLASS (gedit_tab_parent_class)->map (widget);
+
+	_gedit_tab_start_deferred_loading (tab);
+
+	/* The tab is shown, don't make the user wait for the other files */
+	start_queued_loading (tab);
+}
+
 static void
 gedit_tab_grab_focus (GtkWidget *widget)
 {
@@ -371,6 +438,7 @@ gedit_tab_class_init (GeditTabClass *klass)
 	object_class->get_property = gedit_tab_get_property;
 	object_class->set_property = gedit_tab_set_property;
 
+	gtkwidget_class->map = gedit_tab_map;
 	gtkwidget_class->grab_focus = gedit_tab_grab_focus;
 
 	properties[PROP_NAME] =
@@ -527,6 +595,15 @@ gedit_tab_set_state (GeditTab      *tab,
 		return;
 	}
 
+	/* The loading ended, successfully or not */
+	if ((tab->state == GEDIT_TAB_STATE_LOADING ||
+	     tab->state == GEDIT_TAB_STATE_REVERTING) &&
+	    state != GEDIT_TAB_STATE_LOADING &&
+	    state != GEDIT_TAB_STATE_REVERTING)
+	{
+		_gedit_document_set_loading_done (gedit_tab_get_document (tab));
+	}
+
 	tab->state = state;
 
 	set_view_properties_according_to_state (tab, state);
@@ -1337,6 +1414,128 @@ _gedit_tab_set_network_available (GeditTab *tab,
 	}
 }
 
+/* Moves the window of a large file when the view is scrolled close to
+ * one of its ends, keeping the same lines on screen.
+ */
+static gboolean
+large_file_page_idle (GeditTab *tab)
+{
+	GeditDocument *doc;
+	GeditLargeFile *large_file;
+	GtkTextView *view;
+	GtkTextBuffer *buffer;
+	GdkRectangle visible_rect;
+	GtkTextIter iter;
+	GtkTextMark *mark;
+	gint64 first_line;
+	gint64 new_first_line;
+	gint64 top_line;
+	gint64 cursor_line;
+	gint cursor_offset;
+	gint n_window_lines;
+	gint top;
+	gint bottom;
+	gint page_lines;
+
+	tab->idle_large_file_page = 0;
+
+	doc = gedit_tab_get_document (tab);
+	large_file = _gedit_document_get_large_file (doc);
+
+	if (large_file == NULL || tab->state != GEDIT_TAB_STATE_NORMAL)
+	{
+		return G_SOURCE_REMOVE;
+	}
+
+	view = GTK_TEXT_VIEW (gedit_tab_get_view (tab));
+	buffer = GTK_TEXT_BUFFER (doc);
+
+	gtk_text_view_get_visible_rect (view, &visible_rect);
+
+	gtk_text_view_get_line_at_y (view, &iter, visible_rect.y, NULL);
+	top = gtk_text_iter_get_line (&iter);
+
+	gtk_text_view_get_line_at_y (view, &iter, visible_rect.y + visible_rect.height, NULL);
+	bottom = gtk_text_iter_get_line (&iter);
+
+	page_lines = bottom - top + 1;
+	first_line = gedit_large_file_get_first_line (large_file);
+	n_window_lines = gedit_large_file_get_n_window_lines (large_file);
+
+	/* With a window of a few very long lines, moving it would bring
+	 * the view close to the other end.
+	 */
+	if (n_window_lines <= 4 * page_lines)
+	{
+		return G_SOURCE_REMOVE;
+	}
+
+	top_line = first_line + top;
+
+	if (bottom >= n_window_lines - page_lines &&
+	    first_line + n_window_lines < gedit_large_file_get_n_lines (large_file))
+	{
+		new_first_line = top_line - n_window_lines / 4;
+	}
+	else if (top < page_lines && first_line > 0)
+	{
+		new_first_line = MAX (0, top_line - n_window_lines / 2);
+	}
+	else
+	{
+		return G_SOURCE_REMOVE;
+	}
+
+	gtk_text_buffer_get_iter_at_mark (buffer,
+					  &iter,
+					  gtk_text_buffer_get_insert (buffer));
+	cursor_line = first_line + gtk_text_iter_get_line (&iter);
+	cursor_offset = gtk_text_iter_get_line_offset (&iter);
+
+	gedit_large_file_set_first_line (large_file, buffer, new_first_line);
+
+	/* Keep the cursor on its line if it is still in the window */
+	if (cursor_line >= new_first_line &&
+	    cursor_line < new_first_line + gedit_large_file_get_n_window_lines (large_file))
+	{
+		gtk_text_buffer_get_iter_at_line (buffer, &iter, cursor_line - new_first_line);
+
+		if (cursor_offset < gtk_text_iter_get_chars_in_line (&iter))
+		{
+			gtk_text_iter_set_line_offset (&iter, cursor_offset);
+		}
+	}
+	else
+	{
+		gtk_text_buffer_get_iter_at_line (buffer, &iter, top_line - new_first_line);
+	}
+
+	gtk_text_buffer_place_cursor (buffer, &iter);
+
+	gtk_text_buffer_get_iter_at_line (buffer, &iter, top_line - new_first_line);
+	mark = gtk_text_buffer_create_mark (buffer, NULL, &iter, TRUE);
+	gtk_text_view_scroll_to_mark (view, mark, 0.0, TRUE, 0.0, 0.0);
+	gtk_text_buffer_delete_mark (buffer, mark);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+view_vadjustment_value_changed (GtkAdjustment *adjustment,
+				GeditTab      *tab)
+{
+	GeditDocument *doc = gedit_tab_get_document (tab);
+
+	if (_gedit_document_get_large_file (doc) != NULL &&
+	    tab->idle_large_file_page == 0)
+	{
+		tab->idle_large_file_page = g_idle_add_full (G_PRIORITY_LOW,
+							     (GSourceFunc) large_file_page_idle,
+							     tab,
+							     NULL);
+	}
+}
+
 static void
 gedit_tab_init (GeditTab *tab)
 {
@@ -1416,6 +1615,12 @@ gedit_tab_init (GeditTab *tab)
 			  "drop-uris",
 			  G_CALLBACK (on_drop_uris),
 			  tab);
+
+	g_signal_connect_object (gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (view)),
+				 "value-changed",
+				 G_CALLBACK (view_vadjustment_value_changed),
+				 tab,
+				 0);
 }
 
 GeditTab *
@@ -1721,7 +1926,7 @@ static gboolean
 file_already_opened (GeditDocument *doc,
 		     GFile         *location)
 {
-	GList *all_documents;
+	GList *documents;
 	GList *l;
 	gboolean already_opened = FALSE;
 
@@ -1730,31 +1935,23 @@ file_already_opened (GeditDocument *doc,
 		return FALSE;
 	}
 
-	all_documents = gedit_app_get_documents (GEDIT_APP (g_application_get_default ()));
+	documents = _gedit_app_get_documents_for_location (GEDIT_APP (g_application_get_default ()),
+							   location);
 
-	for (l = all_documents; l != NULL; l = l->next)
+	for (l = documents; l != NULL; l = l->next)
 	{
 		GeditDocument *cur_doc = l->data;
-		GtkSourceFile *cur_file;
-		GFile *cur_location;
 
-		if (cur_doc == doc)
-		{
-			continue;
-		}
-
-		cur_file = gedit_document_get_file (cur_doc);
-		cur_location = gtk_source_file_get_location (cur_file);
-
-		if (cur_location != NULL &&
-		    g_file_equal (location, cur_location))
+		/* Only the documents opened in a tab count */
+		if (cur_doc != doc &&
+		    gedit_tab_get_from_document (cur_doc) != NULL)
 		{
 			already_opened = TRUE;
 			break;
 		}
 	}
 
-	g_list_free (all_documents);
+	g_list_free (documents);
 
 	return already_opened;
 }
@@ -1824,6 +2021,89 @@ successful_load (GTask *loading_task)
 	g_signal_emit_by_name (doc, "loaded");
 }
 
+static void start_loading (GTask *loading_task);
+
+static void
+run_loading (GTask *loading_task)
+{
+	LoaderData *data = g_task_get_task_data (loading_task);
+
+	data->running = TRUE;
+	n_running_loadings++;
+
+	start_loading (loading_task);
+}
+
+static void
+run_queued_loadings (void)
+{
+	while (n_running_loadings < MAX_CONCURRENT_LOADINGS &&
+	       !g_queue_is_empty (&loading_queue))
+	{
+		GTask *loading_task = g_queue_pop_head (&loading_queue);
+		GeditTab *tab = g_task_get_source_object (loading_task);
+
+		/* The tab has been closed while waiting */
+		if (gtk_widget_get_parent (GTK_WIDGET (tab)) == NULL)
+		{
+			g_task_return_boolean (loading_task, FALSE);
+			g_object_unref (loading_task);
+			continue;
+		}
+
+		run_loading (loading_task);
+	}
+}
+
+static void
+queue_loading (GTask *loading_task)
+{
+	if (n_running_loadings < MAX_CONCURRENT_LOADINGS)
+	{
+		run_loading (loading_task);
+	}
+	else
+	{
+		gedit_debug_message (DEBUG_TAB, "Loading queued");
+
+		g_queue_push_tail (&loading_queue, loading_task);
+	}
+}
+
+/* Starts the loading of @tab now if it is waiting for a free slot */
+static void
+start_queued_loading (GeditTab *tab)
+{
+	GList *l;
+
+	for (l = loading_queue.head; l != NULL; l = l->next)
+	{
+		GTask *loading_task = l->data;
+
+		if (g_task_get_source_object (loading_task) == tab)
+		{
+			g_queue_delete_link (&loading_queue, l);
+			run_loading (loading_task);
+			return;
+		}
+	}
+}
+
+/* Frees the slot of @loading_task once the file has been read */
+static void
+loading_finished (GTask *loading_task)
+{
+	LoaderData *data = g_task_get_task_data (loading_task);
+
+	if (data->running)
+	{
+		data->running = FALSE;
+		n_running_loadings--;
+
+		run_queued_loadings ();
+	}
+}
+
 static void
 load_cb (GtkSourceFileLoader *loader,
 	 GAsyncResult        *result,
@@ -1841,6 +2121,8 @@ load_cb (GtkSourceFileLoader *loader,
 
 	gtk_source_file_loader_load_finish (loader, result, &error);
 
+	loading_finished (loading_task);
+
 	if (error != NULL)
 	{
 		gedit_debug_message (DEBUG_TAB, "File loading error: %s", error->message);
@@ -2027,6 +2309,96 @@ get_candidate_encodings (GeditTab *tab)
 	return candidates;
 }
 
+static void
+start_file_loader (GTask *loading_task)
+{
+	LoaderData *data = g_task_get_task_data (loading_task);
+
+	if (data->timer != NULL)
+	{
+		g_timer_destroy (data->timer);
+	}
+
+	data->timer = g_timer_new ();
+
+	gtk_source_file_loader_load_async (data->loader,
+					   G_PRIORITY_DEFAULT,
+					   g_task_get_cancellable (loading_task),
+					   (GFileProgressCallback) loader_progress_cb,
+					   loading_task,
+					   NULL,
+					   (GAsyncReadyCallback) load_cb,
+					   loading_task);
+}
+
+static void
+sniff_read_cb (GInputStream *stream,
+	       GAsyncResult *result,
+	       GTask        *loading_task)
+{
+	GeditTab *tab = g_task_get_source_object (loading_task);
+	GBytes *bytes;
+
+	bytes = g_input_stream_read_bytes_finish (stream, result, NULL);
+
+	if (bytes != NULL)
+	{
+		gsize size;
+		const guchar *data = g_bytes_get_data (bytes, &size);
+
+		_gedit_document_set_content_type_from_data (gedit_tab_get_document (tab),
+							    data,
+							    size);
+		g_bytes_unref (bytes);
+	}
+
+	g_input_stream_close_async (stream, G_PRIORITY_DEFAULT, NULL, NULL, NULL);
+
+	start_file_loader (loading_task);
+}
+
+static void
+sniff_open_cb (GFile        *location,
+	       GAsyncResult *result,
+	       GTask        *loading_task)
+{
+	GFileInputStream *stream;
+
+	stream = g_file_read_finish (location, result, NULL);
+
+	/* The loader reports the error */
+	if (stream == NULL)
+	{
+		start_file_loader (loading_task);
+		return;
+	}
+
+	g_input_stream_read_bytes_async (G_INPUT_STREAM (stream),
+					 CONTENT_TYPE_SNIFF_SIZE,
+					 G_PRIORITY_DEFAULT,
+					 g_task_get_cancellable (loading_task),
+					 (GAsyncReadyCallback) sniff_read_cb,
+					 loading_task);
+
+	g_object_unref (stream);
+}
+
+/* The content type of a file which is not in the cache of the document is
+ * sniffed from its first bytes before the loader starts, so that the
+ * language is known before the first text is inserted.
+ */
+static void
+sniff_content_type (GTask *loading_task)
+{
+	LoaderData *data = g_task_get_task_data (loading_task);
+
+	g_file_read_async (gtk_source_file_loader_get_location (data->loader),
+			   G_PRIORITY_DEFAULT,
+			   g_task_get_cancellable (loading_task),
+			   (GAsyncReadyCallback) sniff_open_cb,
+			   loading_task);
+}
+
 static void
 launch_loader (GTask                   *loading_task,
 	       const GtkSourceEncoding *encoding)
@@ -2053,21 +2425,208 @@ launch_loader (GTask                   *loading_task,
 	doc = gedit_tab_get_document (tab);
 	g_signal_emit_by_name (doc, "load");
 
-	if (data->timer != NULL)
+	if (_gedit_document_get_needs_content_type_sniffing (doc) &&
+	    gtk_source_file_loader_get_location (data->loader) != NULL)
 	{
-		g_timer_destroy (data->timer);
+		sniff_content_type (loading_task);
 	}
+	else
+	{
+		start_file_loader (loading_task);
+	}
+}
 
-	data->timer = g_timer_new ();
+/* Whether @location is big enough to be opened in the large file mode */
+static gboolean
+should_load_large_file (GeditTab                *tab,
+			GFile                   *location,
+			const GtkSourceEncoding *encoding)
+{
+	GFileInfo *info;
+	guint threshold;
+	goffset size;
 
-	gtk_source_file_loader_load_async (data->loader,
-					   G_PRIORITY_DEFAULT,
-					   g_task_get_cancellable (loading_task),
-					   (GFileProgressCallback) loader_progress_cb,
-					   loading_task,
-					   NULL,
-					   (GAsyncReadyCallback) load_cb,
-					   loading_task);
+	g_settings_get (tab->editor_settings,
+			GEDIT_SETTINGS_LARGE_FILE_THRESHOLD,
+			"u", &threshold);
+
+	/* The large file mode only reads UTF-8 */
+	if (threshold == 0 ||
+	    !g_file_is_native (location) ||
+	    (encoding != NULL && encoding != gtk_source_encoding_get_utf8 ()))
+	{
+		return FALSE;
+	}
+
+	info = g_file_query_info (location,
+				  G_FILE_ATTRIBUTE_STANDARD_SIZE,
+				  G_FILE_QUERY_INFO_NONE,
+				  NULL,
+				  NULL);
+
+	if (info == NULL)
+	{
+		return FALSE;
+	}
+
+	size = g_file_info_get_size (info);
+	g_object_unref (info);
+
+	return size >= (goffset) threshold * 1024 * 1024;
+}
+
+static void
+large_file_info_bar_response (GtkWidget *info_bar,
+			      gint       response_id,
+			      GeditTab  *tab)
+{
+	set_info_bar (tab, NULL, GTK_RESPONSE_NONE);
+
+	gtk_widget_grab_focus (GTK_WIDGET (gedit_tab_get_view (tab)));
+}
+
+static void
+large_file_open_cb (GeditLargeFile *large_file,
+		    GAsyncResult   *result,
+		    GTask          *loading_task)
+{
+	GeditTab *tab = g_task_get_source_object (loading_task);
+	LoaderData *data = g_task_get_task_data (loading_task);
+	GeditDocument *doc = gedit_tab_get_document (tab);
+	GtkWidget *info_bar;
+	GError *error = NULL;
+
+	g_return_if_fail (tab->state == GEDIT_TAB_STATE_LOADING ||
+	                  tab->state == GEDIT_TAB_STATE_REVERTING);
+
+	gedit_large_file_open_finish (large_file, result, &error);
+
+	loading_finished (loading_task);
+
+	set_info_bar (tab, NULL, GTK_RESPONSE_NONE);
+
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+	{
+		g_task_return_boolean (loading_task, FALSE);
+		g_object_unref (loading_task);
+
+		remove_tab (tab);
+
+		g_error_free (error);
+		return;
+	}
+
+	/* The file loader reports the error, or loads the file anyway if
+	 * it can't be mapped.
+	 */
+	if (error != NULL)
+	{
+		gedit_debug_message (DEBUG_TAB, "Large file opening error: %s", error->message);
+		g_error_free (error);
+
+		_gedit_document_set_large_file (doc, NULL);
+		launch_loader (loading_task, NULL);
+		return;
+	}
+
+	_gedit_document_set_large_file (doc, large_file);
+
+	if (data->line_pos > 0)
+	{
+		gedit_document_goto_line_offset (doc,
+						 data->line_pos - 1,
+						 MAX (0, data->column_pos - 1));
+	}
+	else
+	{
+		gedit_document_goto_line (doc, 0);
+	}
+
+	if (tab->idle_scroll == 0)
+	{
+		tab->idle_scroll = g_idle_add ((GSourceFunc)scroll_to_cursor, tab);
+	}
+
+	set_editable (tab, FALSE);
+	gedit_tab_set_state (tab, GEDIT_TAB_STATE_NORMAL);
+
+	info_bar = gedit_large_file_info_bar_new (gedit_large_file_get_location (large_file));
+
+	g_signal_connect (info_bar,
+			  "response",
+			  G_CALLBACK (large_file_info_bar_response),
+			  tab);
+
+	set_info_bar (tab, info_bar, GTK_RESPONSE_CLOSE);
+
+	g_signal_emit_by_name (doc, "loaded");
+	gedit_recent_add_document (doc);
+
+	g_task_return_boolean (loading_task, TRUE);
+	g_object_unref (loading_task);
+}
+
+/* Tells why the document of a large file is not saved */
+void
+_gedit_tab_show_large_file_saving_error (GeditTab *tab)
+{
+	GeditLargeFile *large_file;
+	GtkWidget *info_bar;
+
+	g_return_if_fail (GEDIT_IS_TAB (tab));
+
+	large_file = _gedit_document_get_large_file (gedit_tab_get_document (tab));
+	g_return_if_fail (large_file != NULL);
+
+	info_bar = gedit_large_file_saving_error_info_bar_new (gedit_large_file_get_location (large_file));
+
+	g_signal_connect (info_bar,
+			  "response",
+			  G_CALLBACK (large_file_info_bar_response),
+			  tab);
+
+	set_info_bar (tab, info_bar, GTK_RESPONSE_CLOSE);
+}
+
+static void
+launch_large_file_loader (GTask *loading_task)
+{
+	GeditTab *tab = g_task_get_source_object (loading_task);
+	LoaderData *data = g_task_get_task_data (loading_task);
+	GeditDocument *doc;
+	GeditLargeFile *large_file;
+
+	doc = gedit_tab_get_document (tab);
+	g_signal_emit_by_name (doc, "load");
+
+	/* Indexing the lines takes a moment, show that it can be cancelled */
+	show_loading_info_bar (loading_task);
+
+	large_file = gedit_large_file_new (gtk_source_file_loader_get_location (data->loader));
+
+	gedit_large_file_open_async (large_file,
+				     g_task_get_cancellable (loading_task),
+				     (GAsyncReadyCallback) large_file_open_cb,
+				     loading_task);
+
+	g_object_unref (large_file);
+}
+
+static void
+start_loading (GTask *loading_task)
+{
+	GeditTab *tab = g_task_get_source_object (loading_task);
+	LoaderData *data = g_task_get_task_data (loading_task);
+	GFile *location = gtk_source_file_loader_get_location (data->loader);
+
+	if (should_load_large_file (tab, location, data->encoding))
+	{
+		launch_large_file_loader (loading_task);
+	}
+	else
+	{
+		launch_loader (loading_task, data->encoding);
+	}
 }
 
 static void
@@ -2103,12 +2662,13 @@ load_async (GeditTab                *tab,
 	g_task_set_task_data (loading_task, data, (GDestroyNotify) loader_data_free);
 
 	data->loader = gtk_source_file_loader_new (GTK_SOURCE_BUFFER (doc), file);
+	data->encoding = encoding;
 	data->line_pos = line_pos;
 	data->column_pos = column_pos;
 
 	_gedit_document_set_create (doc, create);
 
-	launch_loader (loading_task, encoding);
+	queue_loading (loading_task);
 }
 
 static gboolean
@@ -2145,6 +2705,72 @@ _gedit_tab_load (GeditTab                *tab,
 	g_object_unref (cancellable);
 }
 
+/* Only sets the location of the document, the file is loaded when the tab
+ * is shown for the first time.
+ */
+void
+_gedit_tab_load_deferred (GeditTab                *tab,
+			  GFile                   *location,
+			  const GtkSourceEncoding *encoding,
+			  gint                     line_pos,
+			  gint                     column_pos,
+			  gboolean                 create)
+{
+	GeditDocument *doc;
+	GtkSourceFile *file;
+	DeferredLoading *deferred_loading;
+
+	g_return_if_fail (GEDIT_IS_TAB (tab));
+	g_return_if_fail (G_IS_FILE (location));
+	g_return_if_fail (tab->state == GEDIT_TAB_STATE_NORMAL);
+	g_return_if_fail (tab->deferred_loading == NULL);
+
+	doc = gedit_tab_get_document (tab);
+	file = gedit_document_get_file (doc);
+	gtk_source_file_set_location (file, location);
+
+	_gedit_document_set_loading_deferred (doc, TRUE);
+
+	deferred_loading = g_slice_new0 (DeferredLoading);
+	deferred_loading->location = g_object_ref (location);
+	deferred_loading->encoding = encoding;
+	deferred_loading->line_pos = line_pos;
+	deferred_loading->column_pos = column_pos;
+	deferred_loading->create = create != FALSE;
+
+	tab->deferred_loading = deferred_loading;
+}
+
+/* Starts the loading set by _gedit_tab_load_deferred(), if the tab has not
+ * been shown yet.
+ */
+void
+_gedit_tab_start_deferred_loading (GeditTab *tab)
+{
+	DeferredLoading *deferred_loading;
+
+	g_return_if_fail (GEDIT_IS_TAB (tab));
+
+	if (tab->deferred_loading == NULL)
+	{
+		return;
+	}
+
+	deferred_loading = tab->deferred_loading;
+	tab->deferred_loading = NULL;
+
+	_gedit_document_set_loading_deferred (gedit_tab_get_document (tab), FALSE);
+
+	_gedit_tab_load (tab,
+			 deferred_loading->location,
+			 deferred_loading->encoding,
+			 deferred_loading->line_pos,
+			 deferred_loading->column_pos,
+			 deferred_loading->create);
+
+	deferred_loading_free (deferred_loading);
+}
+
 static void
 load_stream_async (GeditTab                *tab,
 		   GInputStream            *stream,
@@ -2222,6 +2848,7 @@ revert_async (GeditTab            *tab,
 	GFile *location;
 	GTask *loading_task;
 	LoaderData *data;
+	GeditLargeFile *large_file;
 
 	g_return_if_fail (GEDIT_IS_TAB (tab));
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
@@ -2249,7 +2876,26 @@ revert_async (GeditTab            *tab,
 	data->line_pos = 0;
 	data->column_pos = 0;
 
-	launch_loader (loading_task, NULL);
+	large_file = _gedit_document_get_large_file (doc);
+
+	if (large_file != NULL)
+	{
+		GtkTextIter iter;
+
+		/* Stay on the same line of the file */
+		gtk_text_buffer_get_iter_at_mark (GTK_TEXT_BUFFER (doc),
+						  &iter,
+						  gtk_text_buffer_get_insert (GTK_TEXT_BUFFER (doc)));
+
+		data->line_pos = gedit_large_file_get_first_line (large_file) +
+				 gtk_text_iter_get_line (&iter) + 1;
+
+		launch_large_file_loader (loading_task);
+	}
+	else
+	{
+		launch_loader (loading_task, NULL);
+	}
 }
 
 void
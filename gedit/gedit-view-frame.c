@@ -29,6 +29,7 @@
 #include <stdlib.h>
 
 #include "gedit-view-centering.h"
+#include "gedit-document-private.h"
 #include "gedit-debug.h"
 #include "gedit-utils.h"
 #include "gedit-settings.h"
@@ -94,6 +95,13 @@ struct _GeditViewFrame
 	 */
 	gchar *search_text;
 	gchar *old_search_text;
+
+	/* For the search in the parts of a large file which are not in the
+	 * buffer.
+	 */
+	GCancellable *large_file_cancellable;
+	gint64 large_file_line;
+	guint large_file_wrapped : 1;
 };
 
 G_DEFINE_TYPE (GeditViewFrame, gedit_view_frame, GTK_TYPE_OVERLAY)
@@ -164,6 +172,12 @@ gedit_view_frame_dispose (GObject *object)
 		gtk_source_file_set_mount_operation_factory (file, NULL, NULL, NULL);
 	}
 
+	if (frame->large_file_cancellable != NULL)
+	{
+		g_cancellable_cancel (frame->large_file_cancellable);
+		g_clear_object (&frame->large_file_cancellable);
+	}
+
 	g_clear_object (&frame->editor_settings);
 	g_clear_object (&frame->entry_tag);
 	g_clear_object (&frame->search_settings);
@@ -378,6 +392,127 @@ start_search (GeditViewFrame *frame)
 						 frame);
 }
 
+static void large_file_find (GeditViewFrame *frame,
+			     gint64          from_line);
+
+static void
+large_file_forward_search_finished (GtkSourceSearchContext *search_context,
+				    GAsyncResult           *result,
+				    GeditViewFrame         *frame)
+{
+	GtkTextIter match_start;
+	GtkTextIter match_end;
+	gboolean found;
+	gboolean has_wrapped_around;
+
+	found = gtk_source_search_context_forward_finish (search_context,
+							  result,
+							  &match_start,
+							  &match_end,
+							  &has_wrapped_around,
+							  NULL);
+
+	/* The line found in the file doesn't match with all the search
+	 * settings, look further.
+	 */
+	if (!found || has_wrapped_around)
+	{
+		large_file_find (frame, frame->large_file_line + 1);
+		return;
+	}
+
+	gtk_text_buffer_select_range (GTK_TEXT_BUFFER (get_document (frame)),
+				      &match_start,
+				      &match_end);
+
+	finish_search (frame, TRUE);
+}
+
+static void
+large_file_find_finished (GeditLargeFile *large_file,
+			  GAsyncResult   *result,
+			  GeditViewFrame *frame)
+{
+	GtkSourceSearchContext *search_context;
+	GtkTextBuffer *buffer;
+	GtkTextIter iter;
+	gint64 line;
+	gint buffer_line;
+	GError *error = NULL;
+
+	line = gedit_large_file_find_finish (large_file, result, &error);
+
+	/* The frame may be disposed */
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+	{
+		g_error_free (error);
+		return;
+	}
+
+	g_clear_error (&error);
+
+	search_context = get_search_context (frame);
+
+	if (search_context == NULL ||
+	    large_file != _gedit_document_get_large_file (get_document (frame)))
+	{
+		return;
+	}
+
+	if (line == -1 &&
+	    !frame->large_file_wrapped &&
+	    gtk_source_search_settings_get_wrap_around (frame->search_settings))
+	{
+		frame->large_file_wrapped = TRUE;
+		large_file_find (frame, 0);
+		return;
+	}
+
+	if (line == -1)
+	{
+		finish_search (frame, FALSE);
+		return;
+	}
+
+	buffer = GTK_TEXT_BUFFER (get_document (frame));
+	buffer_line = gedit_large_file_show_line (large_file, buffer, line);
+	gtk_text_buffer_get_iter_at_line (buffer, &iter, buffer_line);
+
+	frame->large_file_line = line;
+
+	gtk_source_search_context_forward_async (search_context,
+						 &iter,
+						 NULL,
+						 (GAsyncReadyCallback)large_file_forward_search_finished,
+						 frame);
+}
+
+static void
+large_file_find (GeditViewFrame *frame,
+		 gint64          from_line)
+{
+	GeditLargeFile *large_file;
+
+	large_file = _gedit_document_get_large_file (get_document (frame));
+	g_return_if_fail (large_file != NULL);
+
+	if (frame->large_file_cancellable != NULL)
+	{
+		g_cancellable_cancel (frame->large_file_cancellable);
+		g_object_unref (frame->large_file_cancellable);
+	}
+
+	frame->large_file_cancellable = g_cancellable_new ();
+
+	gedit_large_file_find_async (large_file,
+				     gtk_source_search_settings_get_search_text (frame->search_settings),
+				     gtk_source_search_settings_get_case_sensitive (frame->search_settings),
+				     from_line,
+				     frame->large_file_cancellable,
+				     (GAsyncReadyCallback)large_file_find_finished,
+				     frame);
+}
+
 static void
 forward_search_finished (GtkSourceSearchContext *search_context,
 			 GAsyncResult           *result,
@@ -386,14 +521,33 @@ forward_search_finished (GtkSourceSearchContext *search_context,
 	GtkTextIter match_start;
 	GtkTextIter match_end;
 	gboolean found;
+	gboolean has_wrapped_around;
+	GeditLargeFile *large_file;
 
 	found = gtk_source_search_context_forward_finish (search_context,
 							  result,
 							  &match_start,
 							  &match_end,
-							  NULL,
+							  &has_wrapped_around,
 							  NULL);
 
+	large_file = _gedit_document_get_large_file (get_document (frame));
+
+	/* Only a part of a large file is in the buffer, the next match may
+	 * be after it. The regex search is limited to the buffer.
+	 */
+	if (large_file != NULL &&
+	    (!found || has_wrapped_around) &&
+	    !gtk_source_search_settings_get_regex_enabled (frame->search_settings) &&
+	    gtk_source_search_settings_get_search_text (frame->search_settings) != NULL)
+	{
+		frame->large_file_wrapped = FALSE;
+		large_file_find (frame,
+				 gedit_large_file_get_first_line (large_file) +
+				 gedit_large_file_get_n_window_lines (large_file));
+		return;
+	}
+
 	if (found)
 	{
 		GtkTextBuffer *buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (frame->view));
@@ -1068,6 +1222,8 @@ update_goto_line (GeditViewFrame *frame)
 	const gchar *text;
 	GtkTextIter iter;
 	GeditDocument *doc;
+	GeditLargeFile *large_file;
+	gint first_line = 0;
 
 	entry_text = gtk_entry_get_text (GTK_ENTRY (frame->search_entry));
 
@@ -1089,9 +1245,17 @@ update_goto_line (GeditViewFrame *frame)
 		text = entry_text;
 	}
 
+	doc = get_document (frame);
+	large_file = _gedit_document_get_large_file (doc);
+
+	if (large_file != NULL)
+	{
+		first_line = gedit_large_file_get_first_line (large_file);
+	}
+
 	if (text[0] == '-')
 	{
-		gint cur_line = gtk_text_iter_get_line (&iter);
+		gint cur_line = first_line + gtk_text_iter_get_line (&iter);
 
 		if (text[1] != '\0')
 		{
@@ -1102,7 +1266,7 @@ update_goto_line (GeditViewFrame *frame)
 	}
 	else if (entry_text[0] == '+')
 	{
-		gint cur_line = gtk_text_iter_get_line (&iter);
+		gint cur_line = first_line + gtk_text_iter_get_line (&iter);
 
 		if (text[1] != '\0')
 		{
@@ -1123,7 +1287,6 @@ update_goto_line (GeditViewFrame *frame)
 
 	g_strfreev (split_text);
 
-	doc = get_document (frame);
 	moved = gedit_document_goto_line (doc, line);
 	moved_offset = gedit_document_goto_line_offset (doc, line, line_offset);
 
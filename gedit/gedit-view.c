@@ -146,12 +146,6 @@ gedit_view_init (GeditView *view)
 		gtk_target_list_add_uri_targets (target_list, TARGET_URI_LIST);
 	}
 
-	view->priv->extensions =
-		peas_extension_set_new (PEAS_ENGINE (gedit_plugins_engine_get_default ()),
-		                        GEDIT_TYPE_VIEW_ACTIVATABLE,
-		                        "view", view,
-		                        NULL);
-
 	/* Act on buffer change */
 	g_signal_connect (view,
 			  "notify::buffer",
@@ -541,6 +535,18 @@ gedit_view_realize (GtkWidget *widget)
 
 	GTK_WIDGET_CLASS (gedit_view_parent_class)->realize (widget);
 
+	/* The extensions are created only for the views which are shown,
+	 * the views of the tabs in the background don't need them.
+	 */
+	if (view->priv->extensions == NULL)
+	{
+		view->priv->extensions =
+			peas_extension_set_new (PEAS_ENGINE (gedit_plugins_engine_get_default ()),
+			                        GEDIT_TYPE_VIEW_ACTIVATABLE,
+			                        "view", view,
+			                        NULL);
+	}
+
 	g_signal_connect (view->priv->extensions,
 	                  "extension-added",
 	                  G_CALLBACK (extension_added),
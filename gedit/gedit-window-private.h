@@ -47,6 +47,7 @@ struct _GeditWindowPrivate
 	GtkWidget      *side_panel_inline_stack_switcher;
 	GtkWidget      *bottom_panel_box;
 	GtkWidget      *bottom_panel;
+	GtkWidget      *search_results_panel;
 
 	GtkWidget      *hpaned;
 	GtkWidget      *vpaned;
@@ -93,6 +94,12 @@ struct _GeditWindowPrivate
 
 	gint            num_tabs_with_error;
 
+	/* See update_window_state() and update_can_close() */
+	guint           n_tabs_by_state[GEDIT_TAB_NUM_OF_STATES];
+	guint           n_tabs_cannot_close;
+
+	guint           update_actions_sensitivity_id;
+
 	gint            width;
 	gint            height;
 	GdkWindowState  window_state;
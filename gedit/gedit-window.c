@@ -50,6 +50,7 @@
 #include "gedit-document.h"
 #include "gedit-document-private.h"
 #include "gedit-documents-panel.h"
+#include "gedit-search-results-panel.h"
 #include "gedit-plugins-engine.h"
 #include "gedit-window-activatable.h"
 #include "gedit-enum-types.h"
@@ -194,6 +195,12 @@ gedit_window_dispose (GObject *object)
 		window->priv->bottom_panel_item_removed_handler_id = 0;
 	}
 
+	if (window->priv->update_actions_sensitivity_id != 0)
+	{
+		g_source_remove (window->priv->update_actions_sensitivity_id);
+		window->priv->update_actions_sensitivity_id = 0;
+	}
+
 	/* First of all, force collection so that plugins
 	 * really drop some of the references.
 	 */
@@ -596,6 +603,7 @@ update_actions_sensitivity (GeditWindow *window)
 	GAction *action;
 	gboolean editable = FALSE;
 	gboolean empty_search = FALSE;
+	gboolean large_file = FALSE;
 	GtkClipboard *clipboard;
 	GeditLockdownMask lockdown;
 	gboolean enable_syntax_highlighting;
@@ -616,6 +624,7 @@ update_actions_sensitivity (GeditWindow *window)
 		tab_number = gtk_notebook_page_num (GTK_NOTEBOOK (notebook), GTK_WIDGET (tab));
 		editable = gtk_text_view_get_editable (GTK_TEXT_VIEW (view));
 		empty_search = _gedit_document_get_empty_search (doc);
+		large_file = _gedit_document_get_large_file (doc) != NULL;
 	}
 
 	lockdown = gedit_app_get_lockdown (GEDIT_APP (g_application_get_default ()));
@@ -627,6 +636,7 @@ update_actions_sensitivity (GeditWindow *window)
 	                             ((state == GEDIT_TAB_STATE_NORMAL) ||
 	                              (state == GEDIT_TAB_STATE_EXTERNALLY_MODIFIED_NOTIFICATION)) &&
 	                             (file != NULL) && !gtk_source_file_is_readonly (file) &&
+	                             !large_file &&
 	                             !(lockdown & GEDIT_LOCKDOWN_SAVE_TO_DISK));
 
 	action = g_action_map_lookup_action (G_ACTION_MAP (window), "save-as");
@@ -634,7 +644,7 @@ update_actions_sensitivity (GeditWindow *window)
 	                             ((state == GEDIT_TAB_STATE_NORMAL) ||
 	                              (state == GEDIT_TAB_STATE_SAVING_ERROR) ||
 	                              (state == GEDIT_TAB_STATE_EXTERNALLY_MODIFIED_NOTIFICATION)) &&
-	                             (doc != NULL) &&
+	                             (doc != NULL) && !large_file &&
 	                             !(lockdown & GEDIT_LOCKDOWN_SAVE_TO_DISK));
 
 	action = g_action_map_lookup_action (G_ACTION_MAP (window), "revert");
@@ -804,6 +814,33 @@ update_actions_sensitivity (GeditWindow *window)
 	                            window);
 }
 
+static gboolean
+update_actions_sensitivity_idle (GeditWindow *window)
+{
+	window->priv->update_actions_sensitivity_id = 0;
+
+	update_actions_sensitivity (window);
+
+	return G_SOURCE_REMOVE;
+}
+
+/* The sensitivity of the actions is updated once before the next frame,
+ * for all the changes since the last update.
+ */
+static void
+queue_update_actions_sensitivity (GeditWindow *window)
+{
+	if (window->priv->update_actions_sensitivity_id == 0 &&
+	    !window->priv->dispose_has_run)
+	{
+		window->priv->update_actions_sensitivity_id =
+			g_idle_add_full (GDK_PRIORITY_REDRAW - 1,
+					 (GSourceFunc) update_actions_sensitivity_idle,
+					 window,
+					 NULL);
+	}
+}
+
 static void
 on_recent_chooser_item_activated (GeditOpenDocumentSelector *open_document_selector,
                                   gchar                     *uri,
@@ -1020,6 +1057,7 @@ update_cursor_position_statusbar (GtkTextBuffer *buffer,
 	gint line, col;
 	GtkTextIter iter;
 	GeditView *view;
+	GeditLargeFile *large_file;
 	gchar *msg = NULL;
 
 	gedit_debug (DEBUG_WINDOW);
@@ -1036,6 +1074,13 @@ update_cursor_position_statusbar (GtkTextBuffer *buffer,
 	line = 1 + gtk_text_iter_get_line (&iter);
 	col = 1 + gtk_source_view_get_visual_column (GTK_SOURCE_VIEW (view), &iter);
 
+	/* Show the line in the whole file */
+	large_file = _gedit_document_get_large_file (GEDIT_DOCUMENT (buffer));
+	if (large_file != NULL)
+	{
+		line += gedit_large_file_get_first_line (large_file);
+	}
+
 	if ((line >= 0) || (col >= 0))
 	{
 		/* Translators: "Ln" is an abbreviation for "Line", Col is an abbreviation for "Column". Please,
@@ -1454,7 +1499,7 @@ tab_switched (GeditMultiNotebook *mnb,
 		return;
 
 	set_title (window);
-	update_actions_sensitivity (window);
+	queue_update_actions_sensitivity (window);
 
 	g_signal_emit (G_OBJECT (window),
 		       signals[ACTIVE_TAB_CHANGED],
@@ -1483,41 +1528,42 @@ _gedit_window_set_lockdown (GeditWindow       *window,
 					  (GtkCallback)set_auto_save_enabled,
 					  &autosave);
 
-	update_actions_sensitivity (window);
+	queue_update_actions_sensitivity (window);
 }
 
+/* The state of each tab is counted in n_tabs_by_state, so that the window
+ * state is known without looking at all the tabs. The counted state is
+ * kept on the tab, since the new state is already set when the tab
+ * notifies it.
+ */
+#define COUNTED_STATE_KEY "gedit-window-counted-state"
+
 static void
-analyze_tab_state (GeditTab    *tab,
-		   GeditWindow *window)
+count_tab_state (GeditWindow *window,
+		 GeditTab    *tab)
 {
-	GeditTabState ts;
+	GeditTabState state = gedit_tab_get_state (tab);
 
-	ts = gedit_tab_get_state (tab);
+	window->priv->n_tabs_by_state[state]++;
 
-	switch (ts)
-	{
-		case GEDIT_TAB_STATE_LOADING:
-		case GEDIT_TAB_STATE_REVERTING:
-			window->priv->state |= GEDIT_WINDOW_STATE_LOADING;
-			break;
+	g_object_set_data (G_OBJECT (tab),
+			   COUNTED_STATE_KEY,
+			   GINT_TO_POINTER (state + 1));
+}
 
-		case GEDIT_TAB_STATE_SAVING:
-			window->priv->state |= GEDIT_WINDOW_STATE_SAVING;
-			break;
+static void
+uncount_tab_state (GeditWindow *window,
+		   GeditTab    *tab)
+{
+	gint counted_state;
 
-		case GEDIT_TAB_STATE_PRINTING:
-			window->priv->state |= GEDIT_WINDOW_STATE_PRINTING;
-			break;
+	counted_state = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (tab), COUNTED_STATE_KEY));
 
-		case GEDIT_TAB_STATE_LOADING_ERROR:
-		case GEDIT_TAB_STATE_REVERTING_ERROR:
-		case GEDIT_TAB_STATE_SAVING_ERROR:
-		case GEDIT_TAB_STATE_GENERIC_ERROR:
-			window->priv->state |= GEDIT_WINDOW_STATE_ERROR;
-			++window->priv->num_tabs_with_error;
-		default:
-			/* NOP */
-			break;
+	if (counted_state > 0)
+	{
+		window->priv->n_tabs_by_state[counted_state - 1]--;
+
+		g_object_set_data (G_OBJECT (tab), COUNTED_STATE_KEY, NULL);
 	}
 }
 
@@ -1526,6 +1572,7 @@ update_window_state (GeditWindow *window)
 {
 	GeditWindowState old_ws;
 	gint old_num_of_errors;
+	guint *n_tabs = window->priv->n_tabs_by_state;
 
 	gedit_debug_message (DEBUG_WINDOW, "Old state: %x", window->priv->state);
 
@@ -1533,17 +1580,36 @@ update_window_state (GeditWindow *window)
 	old_num_of_errors = window->priv->num_tabs_with_error;
 
 	window->priv->state = 0;
-	window->priv->num_tabs_with_error = 0;
+	window->priv->num_tabs_with_error = n_tabs[GEDIT_TAB_STATE_LOADING_ERROR] +
+					    n_tabs[GEDIT_TAB_STATE_REVERTING_ERROR] +
+					    n_tabs[GEDIT_TAB_STATE_SAVING_ERROR] +
+					    n_tabs[GEDIT_TAB_STATE_GENERIC_ERROR];
 
-	gedit_multi_notebook_foreach_tab (window->priv->multi_notebook,
-					  (GtkCallback)analyze_tab_state,
-					  window);
+	if (n_tabs[GEDIT_TAB_STATE_LOADING] + n_tabs[GEDIT_TAB_STATE_REVERTING] > 0)
+	{
+		window->priv->state |= GEDIT_WINDOW_STATE_LOADING;
+	}
+
+	if (n_tabs[GEDIT_TAB_STATE_SAVING] > 0)
+	{
+		window->priv->state |= GEDIT_WINDOW_STATE_SAVING;
+	}
+
+	if (n_tabs[GEDIT_TAB_STATE_PRINTING] > 0)
+	{
+		window->priv->state |= GEDIT_WINDOW_STATE_PRINTING;
+	}
+
+	if (window->priv->num_tabs_with_error > 0)
+	{
+		window->priv->state |= GEDIT_WINDOW_STATE_ERROR;
+	}
 
 	gedit_debug_message (DEBUG_WINDOW, "New state: %x", window->priv->state);
 
 	if (old_ws != window->priv->state)
 	{
-		update_actions_sensitivity (window);
+		queue_update_actions_sensitivity (window);
 
 		gedit_statusbar_set_window_state (GEDIT_STATUSBAR (window->priv->statusbar),
 						  window->priv->state,
@@ -1559,28 +1625,44 @@ update_window_state (GeditWindow *window)
 	}
 }
 
+/* Likewise, the tabs which can't be closed are counted */
+#define COUNTED_CANNOT_CLOSE_KEY "gedit-window-counted-cannot-close"
+
 static void
-update_can_close (GeditWindow *window)
+count_tab_can_close (GeditWindow *window,
+		     GeditTab    *tab)
 {
-	GeditWindowPrivate *priv = window->priv;
-	GList *tabs;
-	GList *l;
-	gboolean can_close = TRUE;
-
-	gedit_debug (DEBUG_WINDOW);
+	if (!_gedit_tab_get_can_close (tab))
+	{
+		window->priv->n_tabs_cannot_close++;
 
-	tabs = gedit_multi_notebook_get_all_tabs (priv->multi_notebook);
+		g_object_set_data (G_OBJECT (tab),
+				   COUNTED_CANNOT_CLOSE_KEY,
+				   GINT_TO_POINTER (TRUE));
+	}
+}
 
-	for (l = tabs; l != NULL; l = g_list_next (l))
+static void
+uncount_tab_can_close (GeditWindow *window,
+		       GeditTab    *tab)
+{
+	if (g_object_get_data (G_OBJECT (tab), COUNTED_CANNOT_CLOSE_KEY) != NULL)
 	{
-		GeditTab *tab = l->data;
+		window->priv->n_tabs_cannot_close--;
 
-		if (!_gedit_tab_get_can_close (tab))
-		{
-			can_close = FALSE;
-			break;
-		}
+		g_object_set_data (G_OBJECT (tab), COUNTED_CANNOT_CLOSE_KEY, NULL);
 	}
+}
+
+static void
+update_can_close (GeditWindow *window)
+{
+	GeditWindowPrivate *priv = window->priv;
+	gboolean can_close;
+
+	gedit_debug (DEBUG_WINDOW);
+
+	can_close = priv->n_tabs_cannot_close == 0;
 
 	if (can_close && (priv->inhibition_cookie != 0))
 	{
@@ -1595,8 +1677,6 @@ update_can_close (GeditWindow *window)
 		                                                   GTK_APPLICATION_INHIBIT_LOGOUT,
 		                                                   _("There are unsaved documents"));
 	}
-
-	g_list_free (tabs);
 }
 
 static void
@@ -1606,11 +1686,14 @@ sync_state (GeditTab    *tab,
 {
 	gedit_debug (DEBUG_WINDOW);
 
+	uncount_tab_state (window, tab);
+	count_tab_state (window, tab);
+
 	update_window_state (window);
 
 	if (tab == gedit_window_get_active_tab (window))
 	{
-		update_actions_sensitivity (window);
+		queue_update_actions_sensitivity (window);
 
 		g_signal_emit (G_OBJECT (window), signals[ACTIVE_TAB_STATE_CHANGED], 0);
 	}
@@ -1624,7 +1707,7 @@ sync_name (GeditTab    *tab,
 	if (tab == gedit_window_get_active_tab (window))
 	{
 		set_title (window);
-		update_actions_sensitivity (window);
+		queue_update_actions_sensitivity (window);
 	}
 }
 
@@ -1633,6 +1716,9 @@ sync_can_close (GeditTab    *tab,
 		GParamSpec  *pspec,
 		GeditWindow *window)
 {
+	uncount_tab_can_close (window, tab);
+	count_tab_can_close (window, tab);
+
 	update_can_close (window);
 }
 
@@ -1878,7 +1964,7 @@ empty_search_notify_cb (GeditDocument *doc,
 {
 	if (doc == gedit_window_get_active_document (window))
 	{
-		update_actions_sensitivity (window);
+		queue_update_actions_sensitivity (window);
 	}
 }
 
@@ -1889,7 +1975,7 @@ can_undo (GeditDocument *doc,
 {
 	if (doc == gedit_window_get_active_document (window))
 	{
-		update_actions_sensitivity (window);
+		queue_update_actions_sensitivity (window);
 	}
 }
 
@@ -1900,7 +1986,7 @@ can_redo (GeditDocument *doc,
 {
 	if (doc == gedit_window_get_active_document (window))
 	{
-		update_actions_sensitivity (window);
+		queue_update_actions_sensitivity (window);
 	}
 }
 
@@ -1911,7 +1997,7 @@ selection_changed (GeditDocument *doc,
 {
 	if (doc == gedit_window_get_active_document (window))
 	{
-		update_actions_sensitivity (window);
+		queue_update_actions_sensitivity (window);
 	}
 }
 
@@ -1920,7 +2006,7 @@ readonly_changed (GtkSourceFile *file,
 		  GParamSpec    *pspec,
 		  GeditWindow   *window)
 {
-	update_actions_sensitivity (window);
+	queue_update_actions_sensitivity (window);
 
 	sync_name (gedit_window_get_active_tab (window), NULL, window);
 
@@ -1951,7 +2037,7 @@ on_tab_added (GeditMultiNotebook *multi,
 
 	gedit_debug (DEBUG_WINDOW);
 
-	update_actions_sensitivity (window);
+	queue_update_actions_sensitivity (window);
 
 	view = gedit_tab_get_view (tab);
 	doc = gedit_tab_get_document (tab);
@@ -2013,6 +2099,9 @@ on_tab_added (GeditMultiNotebook *multi,
 			  G_CALLBACK (readonly_changed),
 			  window);
 
+	count_tab_state (window, tab);
+	count_tab_can_close (window, tab);
+
 	update_window_state (window);
 	update_can_close (window);
 
@@ -2145,10 +2234,13 @@ on_tab_removed (GeditMultiNotebook *multi,
 		    gtk_notebook_get_n_pages (GTK_NOTEBOOK (notebook)) > 0) ||
 		    num_tabs == 0)
 		{
-			update_actions_sensitivity (window);
+			queue_update_actions_sensitivity (window);
 		}
 	}
 
+	uncount_tab_state (window, tab);
+	uncount_tab_can_close (window, tab);
+
 	update_window_state (window);
 	update_can_close (window);
 
@@ -2162,7 +2254,7 @@ on_page_reordered (GeditMultiNotebook *multi,
                    gint                page_num,
                    GeditWindow        *window)
 {
-	update_actions_sensitivity (window);
+	queue_update_actions_sensitivity (window);
 
 	g_signal_emit (G_OBJECT (window), signals[TABS_REORDERED], 0);
 }
@@ -2228,7 +2320,7 @@ on_notebook_changed (GeditMultiNotebook *mnb,
 		     GParamSpec         *pspec,
 		     GeditWindow        *window)
 {
-	update_actions_sensitivity (window);
+	queue_update_actions_sensitivity (window);
 }
 
 static void
@@ -2236,7 +2328,7 @@ on_notebook_removed (GeditMultiNotebook *mnb,
 		     GeditNotebook      *notebook,
 		     GeditWindow        *window)
 {
-	update_actions_sensitivity (window);
+	queue_update_actions_sensitivity (window);
 }
 
 static void
@@ -2499,7 +2591,7 @@ bottom_panel_item_removed (GtkStack    *panel,
 	gtk_widget_set_visible (window->priv->bottom_panel,
 				gtk_stack_get_visible_child (panel) != NULL);
 
-	update_actions_sensitivity (window);
+	queue_update_actions_sensitivity (window);
 }
 
 static void
@@ -2527,7 +2619,7 @@ bottom_panel_item_added (GtkStack    *panel,
 			gtk_widget_show (window->priv->bottom_panel);
 		}
 
-		update_actions_sensitivity (window);
+		queue_update_actions_sensitivity (window);
 	}
 }
 
@@ -3135,6 +3227,39 @@ gedit_window_create_tab_from_location (GeditWindow             *window,
 	return process_create_tab (window, notebook, tab, jump_to);
 }
 
+/* Like gedit_window_create_tab_from_location() without jumping to the tab,
+ * but the document is only loaded when the tab is shown.
+ */
+GeditTab *
+_gedit_window_create_deferred_tab (GeditWindow             *window,
+				   GFile                   *location,
+				   const GtkSourceEncoding *encoding,
+				   gint                     line_pos,
+				   gint                     column_pos,
+				   gboolean                 create)
+{
+	GtkWidget *notebook;
+	GeditTab *tab;
+
+	g_return_val_if_fail (GEDIT_IS_WINDOW (window), NULL);
+	g_return_val_if_fail (G_IS_FILE (location), NULL);
+
+	gedit_debug (DEBUG_WINDOW);
+
+	tab = _gedit_tab_new ();
+
+	_gedit_tab_load_deferred (tab,
+				  location,
+				  encoding,
+				  line_pos,
+				  column_pos,
+				  create);
+
+	notebook = _gedit_window_get_notebook (window);
+
+	return process_create_tab (window, notebook, tab, FALSE);
+}
+
 /**
  * gedit_window_create_tab_from_stream:
  * @window: a #GeditWindow
@@ -3633,6 +3758,39 @@ gedit_window_get_tab_from_location (GeditWindow *window,
 	return ret;
 }
 
+/*
+ * Shows the search results panel in the bottom panel, it is created the
+ * first time it is needed.
+ */
+GtkWidget *
+_gedit_window_show_search_results_panel (GeditWindow *window)
+{
+	GeditWindowPrivate *priv;
+
+	g_return_val_if_fail (GEDIT_IS_WINDOW (window), NULL);
+
+	priv = window->priv;
+
+	if (priv->search_results_panel == NULL)
+	{
+		priv->search_results_panel = gedit_search_results_panel_new (window);
+		g_object_add_weak_pointer (G_OBJECT (priv->search_results_panel),
+					   (gpointer *) &priv->search_results_panel);
+
+		gtk_widget_show (priv->search_results_panel);
+		gtk_stack_add_titled (GTK_STACK (priv->bottom_panel),
+				      priv->search_results_panel,
+				      "GeditWindowSearchResultsPanel",
+				      _("Search Results"));
+	}
+
+	gtk_stack_set_visible_child (GTK_STACK (priv->bottom_panel),
+				     priv->search_results_panel);
+	gtk_widget_show (priv->bottom_panel);
+
+	return priv->search_results_panel;
+}
+
 /**
  * gedit_window_get_message_bus:
  * @window: a #GeditWindow
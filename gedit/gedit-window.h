@@ -167,6 +167,15 @@ GList		*_gedit_window_get_all_tabs		(GeditWindow         *window);
 
 GFile		*_gedit_window_pop_last_closed_doc	(GeditWindow         *window);
 
+GeditTab	*_gedit_window_create_deferred_tab	(GeditWindow             *window,
+							 GFile                   *location,
+							 const GtkSourceEncoding *encoding,
+							 gint                     line_pos,
+							 gint                     column_pos,
+							 gboolean                 create);
+
+GtkWidget	*_gedit_window_show_search_results_panel (GeditWindow        *window);
+
 G_END_DECLS
 
 #endif  /* GEDIT_WINDOW_H  */
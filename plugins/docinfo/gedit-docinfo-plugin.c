@@ -23,11 +23,9 @@
 #endif
 
 #include "gedit-docinfo-plugin.h"
-
-#include <string.h> /* For strlen (...) */
+#include "gedit-docinfo-stats.h"
 
 #include <glib/gi18n.h>
-#include <pango/pango-break.h>
 #include <gmodule.h>
 
 #include <gedit/gedit-app.h>
@@ -64,6 +62,9 @@ struct _GeditDocinfoPluginPrivate
 	GtkWidget *selected_chars_ns_label;
 	GtkWidget *selected_bytes_label;
 
+	GtkWidget *word_count_label;
+	GeditDocinfoStats *stats;
+
 	GeditApp  *app;
 	GeditMenuExtension *menu_ext;
 };
@@ -88,72 +89,13 @@ G_DEFINE_DYNAMIC_TYPE_EXTENDED (GeditDocinfoPlugin,
 							       gedit_window_activatable_iface_init)
 				G_ADD_PRIVATE_DYNAMIC (GeditDocinfoPlugin))
 
-static void
-calculate_info (GeditDocument *doc,
-		GtkTextIter   *start,
-		GtkTextIter   *end,
-		gint          *chars,
-		gint          *words,
-		gint          *white_chars,
-		gint          *bytes)
-{
-	gchar *text;
-
-	gedit_debug (DEBUG_PLUGINS);
-
-	text = gtk_text_buffer_get_slice (GTK_TEXT_BUFFER (doc),
-					  start,
-					  end,
-					  TRUE);
-
-	*chars = g_utf8_strlen (text, -1);
-	*bytes = strlen (text);
-
-	if (*chars > 0)
-	{
-		PangoLogAttr *attrs;
-		gint i;
-
-		attrs = g_new0 (PangoLogAttr, *chars + 1);
-
-		pango_get_log_attrs (text,
-				     -1,
-				     0,
-				     pango_language_from_string ("C"),
-				     attrs,
-				     *chars + 1);
-
-		for (i = 0; i < (*chars); i++)
-		{
-			if (attrs[i].is_white)
-				++(*white_chars);
-
-			if (attrs[i].is_word_start)
-				++(*words);
-		}
-
-		g_free (attrs);
-	}
-	else
-	{
-		*white_chars = 0;
-		*words = 0;
-	}
-
-	g_free (text);
-}
-
 static void
 update_document_info (GeditDocinfoPlugin *plugin,
 		      GeditDocument      *doc)
 {
 	GeditDocinfoPluginPrivate *priv;
-	GtkTextIter start, end;
-	gint words = 0;
-	gint chars = 0;
-	gint white_chars = 0;
+	GeditDocinfoCounts counts;
 	gint lines = 0;
-	gint bytes = 0;
 	gchar *doc_name;
 	gchar *tmp_str;
 
@@ -161,48 +103,47 @@ update_document_info (GeditDocinfoPlugin *plugin,
 
 	priv = plugin->priv;
 
-	gtk_text_buffer_get_bounds (GTK_TEXT_BUFFER (doc),
-				    &start,
-				    &end);
+	doc_name = gedit_document_get_short_name_for_display (doc);
+	gtk_header_bar_set_subtitle (GTK_HEADER_BAR (priv->header_bar), doc_name);
+	g_free (doc_name);
 
-	lines = gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc));
+	/* The labels are updated once the counts are up to date */
+	if (!gedit_docinfo_stats_get_counts (gedit_docinfo_stats_get_for_document (doc), &counts))
+	{
+		gedit_debug_message (DEBUG_PLUGINS, "Counts are being updated");
+		return;
+	}
 
-	calculate_info (doc,
-			&start, &end,
-			&chars, &words, &white_chars, &bytes);
+	lines = gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc));
 
-	if (chars == 0)
+	if (counts.chars == 0)
 	{
 		lines = 0;
 	}
 
-	gedit_debug_message (DEBUG_PLUGINS, "Chars: %d", chars);
+	gedit_debug_message (DEBUG_PLUGINS, "Chars: %" G_GINT64_FORMAT, counts.chars);
 	gedit_debug_message (DEBUG_PLUGINS, "Lines: %d", lines);
-	gedit_debug_message (DEBUG_PLUGINS, "Words: %d", words);
-	gedit_debug_message (DEBUG_PLUGINS, "Chars non-space: %d", chars - white_chars);
-	gedit_debug_message (DEBUG_PLUGINS, "Bytes: %d", bytes);
-
-	doc_name = gedit_document_get_short_name_for_display (doc);
-	gtk_header_bar_set_subtitle (GTK_HEADER_BAR (priv->header_bar), doc_name);
-	g_free (doc_name);
+	gedit_debug_message (DEBUG_PLUGINS, "Words: %" G_GINT64_FORMAT, counts.words);
+	gedit_debug_message (DEBUG_PLUGINS, "Chars non-space: %" G_GINT64_FORMAT, counts.chars - counts.white_chars);
+	gedit_debug_message (DEBUG_PLUGINS, "Bytes: %" G_GINT64_FORMAT, counts.bytes);
 
 	tmp_str = g_strdup_printf("%d", lines);
 	gtk_label_set_text (GTK_LABEL (priv->document_lines_label), tmp_str);
 	g_free (tmp_str);
 
-	tmp_str = g_strdup_printf("%d", words);
+	tmp_str = g_strdup_printf("%" G_GINT64_FORMAT, counts.words);
 	gtk_label_set_text (GTK_LABEL (priv->document_words_label), tmp_str);
 	g_free (tmp_str);
 
-	tmp_str = g_strdup_printf("%d", chars);
+	tmp_str = g_strdup_printf("%" G_GINT64_FORMAT, counts.chars);
 	gtk_label_set_text (GTK_LABEL (priv->document_chars_label), tmp_str);
 	g_free (tmp_str);
 
-	tmp_str = g_strdup_printf("%d", chars - white_chars);
+	tmp_str = g_strdup_printf("%" G_GINT64_FORMAT, counts.chars - counts.white_chars);
 	gtk_label_set_text (GTK_LABEL (priv->document_chars_ns_label), tmp_str);
 	g_free (tmp_str);
 
-	tmp_str = g_strdup_printf("%d", bytes);
+	tmp_str = g_strdup_printf("%" G_GINT64_FORMAT, counts.bytes);
 	gtk_label_set_text (GTK_LABEL (priv->document_bytes_label), tmp_str);
 	g_free (tmp_str);
 }
@@ -214,11 +155,8 @@ update_selection_info (GeditDocinfoPlugin *plugin,
 	GeditDocinfoPluginPrivate *priv;
 	gboolean sel;
 	GtkTextIter start, end;
-	gint words = 0;
-	gint chars = 0;
-	gint white_chars = 0;
+	GeditDocinfoCounts counts = { 0, };
 	gint lines = 0;
-	gint bytes = 0;
 	gchar *tmp_str;
 
 	gedit_debug (DEBUG_PLUGINS);
@@ -233,15 +171,15 @@ update_selection_info (GeditDocinfoPlugin *plugin,
 	{
 		lines = gtk_text_iter_get_line (&end) - gtk_text_iter_get_line (&start) + 1;
 
-		calculate_info (doc,
-				&start, &end,
-				&chars, &words, &white_chars, &bytes);
+		gedit_docinfo_stats_count_range (gedit_docinfo_stats_get_for_document (doc),
+						 &start, &end,
+						 &counts);
 
-		gedit_debug_message (DEBUG_PLUGINS, "Selected chars: %d", chars);
+		gedit_debug_message (DEBUG_PLUGINS, "Selected chars: %" G_GINT64_FORMAT, counts.chars);
 		gedit_debug_message (DEBUG_PLUGINS, "Selected lines: %d", lines);
-		gedit_debug_message (DEBUG_PLUGINS, "Selected words: %d", words);
-		gedit_debug_message (DEBUG_PLUGINS, "Selected chars non-space: %d", chars - white_chars);
-		gedit_debug_message (DEBUG_PLUGINS, "Selected bytes: %d", bytes);
+		gedit_debug_message (DEBUG_PLUGINS, "Selected words: %" G_GINT64_FORMAT, counts.words);
+		gedit_debug_message (DEBUG_PLUGINS, "Selected chars non-space: %" G_GINT64_FORMAT, counts.chars - counts.white_chars);
+		gedit_debug_message (DEBUG_PLUGINS, "Selected bytes: %" G_GINT64_FORMAT, counts.bytes);
 
 		gtk_widget_set_sensitive (priv->selection_label, TRUE);
 		gtk_widget_set_sensitive (priv->selected_words_label, TRUE);
@@ -262,30 +200,105 @@ update_selection_info (GeditDocinfoPlugin *plugin,
 		gtk_widget_set_sensitive (priv->selected_chars_ns_label, FALSE);
 	}
 
-	if (chars == 0)
+	if (counts.chars == 0)
 		lines = 0;
 
 	tmp_str = g_strdup_printf("%d", lines);
 	gtk_label_set_text (GTK_LABEL (priv->selected_lines_label), tmp_str);
 	g_free (tmp_str);
 
-	tmp_str = g_strdup_printf("%d", words);
+	tmp_str = g_strdup_printf("%" G_GINT64_FORMAT, counts.words);
 	gtk_label_set_text (GTK_LABEL (priv->selected_words_label), tmp_str);
 	g_free (tmp_str);
 
-	tmp_str = g_strdup_printf("%d", chars);
+	tmp_str = g_strdup_printf("%" G_GINT64_FORMAT, counts.chars);
 	gtk_label_set_text (GTK_LABEL (priv->selected_chars_label), tmp_str);
 	g_free (tmp_str);
 
-	tmp_str = g_strdup_printf("%d", chars - white_chars);
+	tmp_str = g_strdup_printf("%" G_GINT64_FORMAT, counts.chars - counts.white_chars);
 	gtk_label_set_text (GTK_LABEL (priv->selected_chars_ns_label), tmp_str);
 	g_free (tmp_str);
 
-	tmp_str = g_strdup_printf("%d", bytes);
+	tmp_str = g_strdup_printf("%" G_GINT64_FORMAT, counts.bytes);
 	gtk_label_set_text (GTK_LABEL (priv->selected_bytes_label), tmp_str);
 	g_free (tmp_str);
 }
 
+static void
+update_word_count (GeditDocinfoPlugin *plugin)
+{
+	GeditDocinfoPluginPrivate *priv = plugin->priv;
+	GeditDocinfoCounts counts;
+	gchar *number;
+	gchar *tmp_str;
+
+	if (priv->stats == NULL)
+	{
+		gtk_label_set_text (GTK_LABEL (priv->word_count_label), "");
+		return;
+	}
+
+	/* Keep showing the previous count while updating */
+	if (!gedit_docinfo_stats_get_counts (priv->stats, &counts))
+		return;
+
+	number = g_strdup_printf ("%" G_GINT64_FORMAT, counts.words);
+	/* Translators: %s is the number of words of the document */
+	tmp_str = g_strdup_printf (ngettext ("%s word", "%s words", counts.words), number);
+	gtk_label_set_text (GTK_LABEL (priv->word_count_label), tmp_str);
+	g_free (tmp_str);
+	g_free (number);
+}
+
+static void
+stats_changed_cb (GeditDocinfoStats  *stats,
+		  GeditDocinfoPlugin *plugin)
+{
+	GeditDocinfoPluginPrivate *priv = plugin->priv;
+
+	gedit_debug (DEBUG_PLUGINS);
+
+	update_word_count (plugin);
+
+	if (priv->dialog != NULL)
+	{
+		update_document_info (plugin, gedit_window_get_active_document (priv->window));
+	}
+}
+
+static void
+set_active_document (GeditDocinfoPlugin *plugin,
+		     GeditDocument      *doc)
+{
+	GeditDocinfoPluginPrivate *priv = plugin->priv;
+
+	if (priv->stats != NULL)
+	{
+		g_signal_handlers_disconnect_by_func (priv->stats, stats_changed_cb, plugin);
+		g_clear_object (&priv->stats);
+	}
+
+	if (doc != NULL)
+	{
+		priv->stats = g_object_ref (gedit_docinfo_stats_get_for_document (doc));
+
+		g_signal_connect (priv->stats,
+				  "changed",
+				  G_CALLBACK (stats_changed_cb),
+				  plugin);
+	}
+
+	update_word_count (plugin);
+}
+
+static void
+active_tab_changed_cb (GeditWindow        *window,
+		       GeditTab           *tab,
+		       GeditDocinfoPlugin *plugin)
+{
+	set_active_document (plugin, tab != NULL ? gedit_tab_get_document (tab) : NULL);
+}
+
 static void
 docinfo_dialog_response_cb (GtkDialog          *widget,
 			    gint                res_id,
@@ -441,6 +454,7 @@ gedit_docinfo_plugin_dispose (GObject *object)
 	gedit_debug_message (DEBUG_PLUGINS, "GeditDocinfoPlugin dispose");
 
 	g_clear_object (&plugin->priv->action);
+	g_clear_object (&plugin->priv->stats);
 	g_clear_object (&plugin->priv->window);
 	g_clear_object (&plugin->priv->menu_ext);
 	g_clear_object (&plugin->priv->app);
@@ -566,6 +580,21 @@ gedit_docinfo_plugin_window_activate (GeditWindowActivatable *activatable)
 	g_action_map_add_action (G_ACTION_MAP (priv->window),
 	                         G_ACTION (priv->action));
 
+	/* Live word count of the active document in the statusbar */
+	priv->word_count_label = gtk_label_new (NULL);
+	gtk_widget_show (priv->word_count_label);
+	gtk_box_pack_end (GTK_BOX (gedit_window_get_statusbar (priv->window)),
+			  priv->word_count_label,
+			  FALSE, FALSE, 0);
+
+	g_signal_connect (priv->window,
+			  "active-tab-changed",
+			  G_CALLBACK (active_tab_changed_cb),
+			  activatable);
+
+	set_active_document (GEDIT_DOCINFO_PLUGIN (activatable),
+			     gedit_window_get_active_document (priv->window));
+
 	update_ui (GEDIT_DOCINFO_PLUGIN (activatable));
 }
 
@@ -573,11 +602,28 @@ static void
 gedit_docinfo_plugin_window_deactivate (GeditWindowActivatable *activatable)
 {
 	GeditDocinfoPluginPrivate *priv;
+	GList *docs;
 
 	gedit_debug (DEBUG_PLUGINS);
 
 	priv = GEDIT_DOCINFO_PLUGIN (activatable)->priv;
 
+	g_signal_handlers_disconnect_by_func (priv->window,
+					      active_tab_changed_cb,
+					      activatable);
+
+	set_active_document (GEDIT_DOCINFO_PLUGIN (activatable), NULL);
+
+	/* The statistics must not be kept up to date by a plugin which is not
+	 * active anymore, nor outlive its module.
+	 */
+	docs = gedit_window_get_documents (priv->window);
+	g_list_foreach (docs, (GFunc) gedit_docinfo_stats_remove_from_document, NULL);
+	g_list_free (docs);
+
+	gtk_widget_destroy (priv->word_count_label);
+	priv->word_count_label = NULL;
+
 	g_action_map_remove_action (G_ACTION_MAP (priv->window), "docinfo");
 }
 
@@ -628,6 +674,7 @@ G_MODULE_EXPORT void
 peas_register_types (PeasObjectModule *module)
 {
 	gedit_docinfo_plugin_register_type (G_TYPE_MODULE (module));
+	_gedit_docinfo_stats_register_type (G_TYPE_MODULE (module));
 
 	peas_object_module_register_extension_type (module,
 						    GEDIT_TYPE_APP_ACTIVATABLE,
@@ -0,0 +1,1048 @@
+/*
+ * gedit-docinfo-stats.c
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gedit-docinfo-stats.h"
+
+#include <string.h>
+
+#include <glib/gi18n.h>
+#include <pango/pango-break.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <gedit/gedit-debug.h>
+
+/* The counts of a document are cached per block of this many lines, so
+ * that an edit only requires counting the block it touches again.
+ */
+#define BLOCK_LINES 256
+
+/* Text is handed to pango in chunks of about this many characters, so
+ * that a very long line does not need a PangoLogAttr for each of its
+ * characters at once.
+ */
+#define CHUNK_CHARS 65536
+
+/* Size of the reads done when counting a stream */
+#define STREAM_READ_SIZE 65536
+
+/* Time spent counting per idle callback, in microseconds */
+#define UPDATE_BUDGET 5000
+
+#define STATS_KEY "GeditDocinfoStatsKey"
+
+typedef struct
+{
+	gint               lines;
+	gboolean           valid;
+	GeditDocinfoCounts counts;
+} Block;
+
+struct _GeditDocinfoStatsPrivate
+{
+	GtkTextBuffer      *buffer;
+
+	/* Consecutive blocks of lines covering the whole buffer */
+	GArray             *blocks;
+
+	/* Line of the insertion in progress */
+	gint                insert_line;
+
+	/* Counts of the whole buffer, valid when up_to_date is set */
+	GeditDocinfoCounts  counts;
+	guint               up_to_date : 1;
+
+	guint               update_id;
+};
+
+enum
+{
+	CHANGED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL];
+
+G_DEFINE_DYNAMIC_TYPE_EXTENDED (GeditDocinfoStats,
+				gedit_docinfo_stats,
+				G_TYPE_OBJECT,
+				0,
+				G_ADD_PRIVATE_DYNAMIC (GeditDocinfoStats))
+
+static void
+counts_add (GeditDocinfoCounts       *counts,
+	    const GeditDocinfoCounts *other)
+{
+	counts->chars += other->chars;
+	counts->words += other->words;
+	counts->white_chars += other->white_chars;
+	counts->bytes += other->bytes;
+}
+
+static void
+count_text_pango (const gchar        *text,
+		  gsize               length,
+		  GeditDocinfoCounts *counts)
+{
+	PangoLogAttr *attrs;
+	glong n_chars;
+
+	n_chars = g_utf8_strlen (text, length);
+
+	counts->chars += n_chars;
+	counts->bytes += length;
+
+	if (n_chars == 0)
+		return;
+
+	attrs = g_new0 (PangoLogAttr, n_chars + 1);
+
+	pango_get_log_attrs (text,
+			     length,
+			     0,
+			     pango_language_from_string ("C"),
+			     attrs,
+			     n_chars + 1);
+
+	for (glong i = 0; i < n_chars; i++)
+	{
+		if (attrs[i].is_white)
+			++counts->white_chars;
+
+		if (attrs[i].is_word_start)
+			++counts->words;
+	}
+
+	g_free (attrs);
+}
+
+/* The fast path below reproduces what pango does for text made of code
+ * points below U+0300, where no script needs complex shaping nor any
+ * combining mark can appear: a word starts at a letter or a number not
+ * following a character of the same kind, format characters are part of
+ * the word they are in, and white space is what g_unichar_isspace()
+ * says. Lead bytes from 0xCC up start the code points from U+0300 on.
+ */
+#define SIMPLE_LEAD_BYTE_MAX 0xCB
+
+typedef enum
+{
+	WORD_NONE,
+	WORD_LETTERS,
+	WORD_NUMBERS
+} WordType;
+
+typedef enum
+{
+	CLASS_OTHER,
+	CLASS_LETTER,
+	CLASS_NUMBER,
+	CLASS_EATEN
+} CharClass;
+
+static CharClass
+classify_char (gunichar ch)
+{
+	switch (g_unichar_type (ch))
+	{
+		case G_UNICODE_LOWERCASE_LETTER:
+		case G_UNICODE_MODIFIER_LETTER:
+		case G_UNICODE_OTHER_LETTER:
+		case G_UNICODE_TITLECASE_LETTER:
+		case G_UNICODE_UPPERCASE_LETTER:
+			return CLASS_LETTER;
+		case G_UNICODE_DECIMAL_NUMBER:
+		case G_UNICODE_LETTER_NUMBER:
+		case G_UNICODE_OTHER_NUMBER:
+			return CLASS_NUMBER;
+		case G_UNICODE_SPACING_MARK:
+		case G_UNICODE_ENCLOSING_MARK:
+		case G_UNICODE_NON_SPACING_MARK:
+		case G_UNICODE_FORMAT:
+			return CLASS_EATEN;
+		default:
+			return CLASS_OTHER;
+	}
+}
+
+static void
+count_simple_utf8 (const gchar        *text,
+		   gsize               length,
+		   GeditDocinfoCounts *counts)
+{
+	const gchar *end = text + length;
+	WordType word = WORD_NONE;
+
+	for (const gchar *p = text; p < end; p = g_utf8_next_char (p))
+	{
+		gunichar ch = g_utf8_get_char (p);
+		CharClass class = classify_char (ch);
+
+		++counts->chars;
+
+		if (g_unichar_isspace (ch))
+			++counts->white_chars;
+
+		if (word != WORD_NONE &&
+		    class != CLASS_EATEN &&
+		    !(class == CLASS_LETTER && word == WORD_LETTERS) &&
+		    !(class == CLASS_NUMBER && word == WORD_NUMBERS))
+		{
+			word = WORD_NONE;
+		}
+
+		if (word == WORD_NONE && class == CLASS_LETTER)
+		{
+			word = WORD_LETTERS;
+			++counts->words;
+		}
+		else if (word == WORD_NONE && class == CLASS_NUMBER)
+		{
+			word = WORD_NUMBERS;
+			++counts->words;
+		}
+	}
+
+	counts->bytes += length;
+}
+
+static inline guint
+popcount (guint x)
+{
+#ifdef __GNUC__
+	return __builtin_popcount (x);
+#else
+	guint n = 0;
+
+	for (; x != 0; x &= x - 1)
+		++n;
+
+	return n;
+#endif
+}
+
+static inline gboolean
+ascii_is_letter (guchar c)
+{
+	return (c | 0x20) >= 'a' && (c | 0x20) <= 'z';
+}
+
+static inline gboolean
+ascii_is_digit (guchar c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static inline gboolean
+ascii_is_white (guchar c)
+{
+	/* Same as g_unichar_isspace(), which excludes '\v' */
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+/* In ASCII the words are the runs of letters and the runs of digits */
+static void
+count_ascii (const guchar       *text,
+	     gsize               length,
+	     GeditDocinfoCounts *counts)
+{
+	gboolean prev_letter = FALSE;
+	gboolean prev_digit = FALSE;
+	gsize i = 0;
+
+#ifdef __SSE2__
+	const __m128i case_bit = _mm_set1_epi8 (0x20);
+	const __m128i before_a = _mm_set1_epi8 ('a' - 1);
+	const __m128i after_z = _mm_set1_epi8 ('z' + 1);
+	const __m128i before_0 = _mm_set1_epi8 ('0' - 1);
+	const __m128i after_9 = _mm_set1_epi8 ('9' + 1);
+	const __m128i space = _mm_set1_epi8 (' ');
+	const __m128i tab = _mm_set1_epi8 ('\t');
+	const __m128i newline = _mm_set1_epi8 ('\n');
+	const __m128i form_feed = _mm_set1_epi8 ('\f');
+	const __m128i carriage_return = _mm_set1_epi8 ('\r');
+
+	/* All the bytes are below 0x80, so signed comparisons are fine */
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i chunk = _mm_loadu_si128 ((const __m128i *)(text + i));
+		__m128i lower = _mm_or_si128 (chunk, case_bit);
+		guint letters;
+		guint digits;
+		guint white;
+
+		letters = _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpgt_epi8 (lower, before_a),
+							    _mm_cmplt_epi8 (lower, after_z)));
+		digits = _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpgt_epi8 (chunk, before_0),
+							   _mm_cmplt_epi8 (chunk, after_9)));
+		white = _mm_movemask_epi8 (_mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (chunk, space),
+								       _mm_cmpeq_epi8 (chunk, tab)),
+							 _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (chunk, newline),
+										     _mm_cmpeq_epi8 (chunk, form_feed)),
+								       _mm_cmpeq_epi8 (chunk, carriage_return))));
+
+		/* Bit n of the masks is byte n, a word starts where the
+		   previous byte is not of the same kind */
+		counts->words += popcount (letters & ~((letters << 1) | prev_letter));
+		counts->words += popcount (digits & ~((digits << 1) | prev_digit));
+		counts->white_chars += popcount (white);
+
+		prev_letter = (letters >> 15) & 1;
+		prev_digit = (digits >> 15) & 1;
+	}
+#endif
+
+	for (; i < length; ++i)
+	{
+		gboolean letter = ascii_is_letter (text[i]);
+		gboolean digit = ascii_is_digit (text[i]);
+
+		if ((letter && !prev_letter) || (digit && !prev_digit))
+			++counts->words;
+
+		if (ascii_is_white (text[i]))
+			++counts->white_chars;
+
+		prev_letter = letter;
+		prev_digit = digit;
+	}
+
+	counts->chars += length;
+	counts->bytes += length;
+}
+
+/* Returns 0 for ASCII, 1 for code points below U+0300 and 2 otherwise */
+static gint
+scan_text (const guchar *text,
+	   gsize         length)
+{
+	gboolean ascii = TRUE;
+	gsize i = 0;
+
+#ifdef __SSE2__
+	const __m128i max_lead = _mm_set1_epi8 ((gchar)SIMPLE_LEAD_BYTE_MAX);
+
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i chunk = _mm_loadu_si128 ((const __m128i *)(text + i));
+
+		/* Non zero where the byte is above the maximum lead byte */
+		__m128i above = _mm_subs_epu8 (chunk, max_lead);
+
+		if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (above, _mm_setzero_si128 ())) != 0xFFFF)
+			return 2;
+
+		if (_mm_movemask_epi8 (chunk) != 0)
+			ascii = FALSE;
+	}
+#endif
+
+	for (; i < length; ++i)
+	{
+		if (text[i] > SIMPLE_LEAD_BYTE_MAX)
+			return 2;
+
+		if (text[i] >= 0x80)
+			ascii = FALSE;
+	}
+
+	return ascii ? 0 : 1;
+}
+
+/* Whether the fast path matches what the pango in use does, checked once
+ * on a few samples in case pango changes its notion of words.
+ */
+static gboolean
+fast_path_is_exact (void)
+{
+	static gsize checked = 0;
+	static gboolean exact = TRUE;
+
+	if (g_once_init_enter (&checked))
+	{
+		static const gchar *samples[] = {
+			"Hello, world!\tfoo_bar  x:y\r\n\f\v12 abc123 3.14 don't",
+			"a.b-c/d (e) [f] {g} \"h\" #1 $2 %3 &4 *5 +6 =7 <8> ?9 @0 ^~`|\\",
+			"caf\xc3\xa9 na\xc3\xafve \xc3\x80\xc3\x89 \xc2\xa0 \xc2\xbd 12\xc2\xb2 so\xc2\xadft \xc2\xabquote\xc2\xbb",
+			"\xc5\x93uvre \xc8\x98tefan \xca\xbc \xc2\xaa\xc2\xba \xc3\x97\xc3\xb7 \xc2\xb5",
+		};
+
+		for (guint i = 0; i < G_N_ELEMENTS (samples) && exact; ++i)
+		{
+			gsize length = strlen (samples[i]);
+			GeditDocinfoCounts fast = { 0, };
+			GeditDocinfoCounts slow = { 0, };
+
+			if (scan_text ((const guchar *)samples[i], length) == 0)
+				count_ascii ((const guchar *)samples[i], length, &fast);
+			else
+				count_simple_utf8 (samples[i], length, &fast);
+
+			count_text_pango (samples[i], length, &slow);
+
+			exact = memcmp (&fast, &slow, sizeof (GeditDocinfoCounts)) == 0;
+		}
+
+		if (!exact)
+		{
+			gedit_debug_message (DEBUG_PLUGINS, "Counting everything with pango");
+		}
+
+		g_once_init_leave (&checked, 1);
+	}
+
+	return exact;
+}
+
+/**
+ * gedit_docinfo_stats_count_text:
+ * @text: valid UTF-8 text
+ * @length: length of @text in bytes, or -1 if nul-terminated
+ * @counts: the counts to add to
+ *
+ * Adds the counts of @text to @counts. Words cut at the end of @text are
+ * counted again if the rest is counted separately, so callers split long
+ * texts on white space.
+ */
+void
+gedit_docinfo_stats_count_text (const gchar        *text,
+				gssize              length,
+				GeditDocinfoCounts *counts)
+{
+	if (length < 0)
+		length = strlen (text);
+
+	if (fast_path_is_exact ())
+	{
+		switch (scan_text ((const guchar *)text, length))
+		{
+			case 0:
+				count_ascii ((const guchar *)text, length, counts);
+				return;
+			case 1:
+				count_simple_utf8 (text, length, counts);
+				return;
+			default:
+				break;
+		}
+	}
+
+	count_text_pango (text, length, counts);
+}
+
+static gboolean
+is_white_char (gunichar ch,
+	       gpointer user_data)
+{
+	return g_unichar_isspace (ch);
+}
+
+/* Counts the text between @start and @end in chunks cut on white space */
+static void
+count_range_direct (const GtkTextIter  *start,
+		    const GtkTextIter  *end,
+		    GeditDocinfoCounts *counts)
+{
+	GtkTextIter chunk_start = *start;
+
+	while (gtk_text_iter_compare (&chunk_start, end) < 0)
+	{
+		GtkTextIter chunk_end = chunk_start;
+		gchar *text;
+
+		gtk_text_iter_forward_chars (&chunk_end, CHUNK_CHARS);
+
+		if (gtk_text_iter_compare (&chunk_end, end) >= 0)
+		{
+			chunk_end = *end;
+		}
+		else
+		{
+			GtkTextIter limit = chunk_end;
+
+			/* Give up on keeping words whole in very long ones */
+			gtk_text_iter_forward_chars (&limit, CHUNK_CHARS);
+
+			if (gtk_text_iter_compare (&limit, end) > 0)
+				limit = *end;
+
+			gtk_text_iter_forward_find_char (&chunk_end, is_white_char, NULL, &limit);
+		}
+
+		text = gtk_text_iter_get_slice (&chunk_start, &chunk_end);
+		gedit_docinfo_stats_count_text (text, -1, counts);
+		g_free (text);
+
+		chunk_start = chunk_end;
+	}
+}
+
+static void
+get_block_bounds (GtkTextBuffer *buffer,
+		  gint           line,
+		  gint           lines,
+		  GtkTextIter   *start,
+		  GtkTextIter   *end)
+{
+	gtk_text_buffer_get_iter_at_line (buffer, start, line);
+
+	if (line + lines >= gtk_text_buffer_get_line_count (buffer))
+		gtk_text_buffer_get_end_iter (buffer, end);
+	else
+		gtk_text_buffer_get_iter_at_line (buffer, end, line + lines);
+}
+
+static void
+count_block (GeditDocinfoStats *stats,
+	     Block             *block,
+	     gint               line)
+{
+	GtkTextIter start;
+	GtkTextIter end;
+
+	get_block_bounds (stats->priv->buffer, line, block->lines, &start, &end);
+
+	memset (&block->counts, 0, sizeof (GeditDocinfoCounts));
+	count_range_direct (&start, &end, &block->counts);
+
+	block->valid = TRUE;
+}
+
+/* Returns the index of the block containing @line and its first line */
+static guint
+find_block (GeditDocinfoStats *stats,
+	    gint               line,
+	    gint              *block_line)
+{
+	GArray *blocks = stats->priv->blocks;
+	gint start = 0;
+	guint i;
+
+	for (i = 0; i + 1 < blocks->len; ++i)
+	{
+		Block *block = &g_array_index (blocks, Block, i);
+
+		if (line < start + block->lines)
+			break;
+
+		start += block->lines;
+	}
+
+	*block_line = start;
+	return i;
+}
+
+static void
+append_blocks (GArray *blocks,
+	       guint   index,
+	       gint    lines)
+{
+	while (lines > 0)
+	{
+		Block block = { MIN (lines, BLOCK_LINES), FALSE, { 0, } };
+
+		g_array_insert_val (blocks, index++, block);
+		lines -= block.lines;
+	}
+}
+
+static gboolean
+update_idle (GeditDocinfoStats *stats)
+{
+	GeditDocinfoStatsPrivate *priv = stats->priv;
+	gint64 deadline = g_get_monotonic_time () + UPDATE_BUDGET;
+	GeditDocinfoCounts counts = { 0, };
+	gint line = 0;
+
+	for (guint i = 0; i < priv->blocks->len; ++i)
+	{
+		Block *block = &g_array_index (priv->blocks, Block, i);
+
+		if (!block->valid)
+		{
+			if (g_get_monotonic_time () >= deadline)
+				return G_SOURCE_CONTINUE;
+
+			count_block (stats, block, line);
+		}
+
+		counts_add (&counts, &block->counts);
+		line += block->lines;
+	}
+
+	gedit_debug_message (DEBUG_PLUGINS,
+			     "Counted %" G_GINT64_FORMAT " chars in %u blocks",
+			     counts.chars, priv->blocks->len);
+
+	priv->counts = counts;
+	priv->up_to_date = TRUE;
+	priv->update_id = 0;
+
+	g_signal_emit (stats, signals[CHANGED], 0);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_update (GeditDocinfoStats *stats)
+{
+	GeditDocinfoStatsPrivate *priv = stats->priv;
+
+	priv->up_to_date = FALSE;
+
+	if (priv->update_id == 0)
+	{
+		priv->update_id = g_idle_add_full (G_PRIORITY_LOW,
+						   (GSourceFunc)update_idle,
+						   stats,
+						   NULL);
+	}
+}
+
+static void
+insert_text_cb (GtkTextBuffer     *buffer,
+		GtkTextIter       *location,
+		gchar             *text,
+		gint               len,
+		GeditDocinfoStats *stats)
+{
+	stats->priv->insert_line = gtk_text_iter_get_line (location);
+}
+
+/* Runs after the insertion, @location is then at the end of the text */
+static void
+insert_text_after_cb (GtkTextBuffer     *buffer,
+		      GtkTextIter       *location,
+		      gchar             *text,
+		      gint               len,
+		      GeditDocinfoStats *stats)
+{
+	GeditDocinfoStatsPrivate *priv = stats->priv;
+	gint added = gtk_text_iter_get_line (location) - priv->insert_line;
+	gint block_line;
+	guint index;
+	Block *block;
+
+	index = find_block (stats, priv->insert_line, &block_line);
+	block = &g_array_index (priv->blocks, Block, index);
+
+	block->valid = FALSE;
+
+	/* Split blocks which grew too large, e.g. when pasting */
+	if (block->lines + added > 2 * BLOCK_LINES)
+	{
+		gint lines = block->lines + added;
+
+		g_array_remove_index (priv->blocks, index);
+		append_blocks (priv->blocks, index, lines);
+	}
+	else
+	{
+		block->lines += added;
+	}
+
+	schedule_update (stats);
+}
+
+static void
+delete_range_cb (GtkTextBuffer     *buffer,
+		 GtkTextIter       *start,
+		 GtkTextIter       *end,
+		 GeditDocinfoStats *stats)
+{
+	GeditDocinfoStatsPrivate *priv = stats->priv;
+	gint line = gtk_text_iter_get_line (start);
+	gint removed = gtk_text_iter_get_line (end) - line;
+	gint block_line;
+	guint index;
+	Block *block;
+
+	index = find_block (stats, line, &block_line);
+	block = &g_array_index (priv->blocks, Block, index);
+
+	block->valid = FALSE;
+
+	/* The lines following the one of @start are removed, they may span
+	 * the following blocks, which are dropped once empty.
+	 */
+	if (removed > 0)
+	{
+		gint taken = MIN (removed, block_line + block->lines - 1 - line);
+
+		block->lines -= taken;
+		removed -= taken;
+		++index;
+	}
+
+	while (removed > 0 && index < priv->blocks->len)
+	{
+		gint taken;
+
+		block = &g_array_index (priv->blocks, Block, index);
+		taken = MIN (removed, block->lines);
+
+		block->lines -= taken;
+		block->valid = FALSE;
+		removed -= taken;
+
+		if (block->lines == 0)
+			g_array_remove_index (priv->blocks, index);
+		else
+			++index;
+	}
+
+	schedule_update (stats);
+}
+
+static void
+gedit_docinfo_stats_dispose (GObject *object)
+{
+	GeditDocinfoStatsPrivate *priv = GEDIT_DOCINFO_STATS (object)->priv;
+
+	if (priv->update_id != 0)
+	{
+		g_source_remove (priv->update_id);
+		priv->update_id = 0;
+	}
+
+	if (priv->buffer != NULL)
+	{
+		g_signal_handlers_disconnect_by_data (priv->buffer, object);
+		g_object_remove_weak_pointer (G_OBJECT (priv->buffer),
+					      (gpointer *)&priv->buffer);
+		priv->buffer = NULL;
+	}
+
+	G_OBJECT_CLASS (gedit_docinfo_stats_parent_class)->dispose (object);
+}
+
+static void
+gedit_docinfo_stats_finalize (GObject *object)
+{
+	GeditDocinfoStatsPrivate *priv = GEDIT_DOCINFO_STATS (object)->priv;
+
+	g_array_unref (priv->blocks);
+
+	G_OBJECT_CLASS (gedit_docinfo_stats_parent_class)->finalize (object);
+}
+
+static void
+gedit_docinfo_stats_class_init (GeditDocinfoStatsClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = gedit_docinfo_stats_dispose;
+	object_class->finalize = gedit_docinfo_stats_finalize;
+
+	signals[CHANGED] =
+		g_signal_new ("changed",
+			      G_TYPE_FROM_CLASS (klass),
+			      G_SIGNAL_RUN_LAST,
+			      G_STRUCT_OFFSET (GeditDocinfoStatsClass, changed),
+			      NULL, NULL, NULL,
+			      G_TYPE_NONE, 0);
+}
+
+static void
+gedit_docinfo_stats_class_finalize (GeditDocinfoStatsClass *klass)
+{
+}
+
+static void
+gedit_docinfo_stats_init (GeditDocinfoStats *stats)
+{
+	stats->priv = gedit_docinfo_stats_get_instance_private (stats);
+	stats->priv->blocks = g_array_new (FALSE, FALSE, sizeof (Block));
+}
+
+/**
+ * gedit_docinfo_stats_get_for_document:
+ * @doc: a #GeditDocument
+ *
+ * Returns: (transfer none): the statistics of @doc, created and attached
+ * to it on first use.
+ */
+GeditDocinfoStats *
+gedit_docinfo_stats_get_for_document (GeditDocument *doc)
+{
+	GeditDocinfoStats *stats;
+
+	g_return_val_if_fail (GEDIT_IS_DOCUMENT (doc), NULL);
+
+	stats = g_object_get_data (G_OBJECT (doc), STATS_KEY);
+
+	if (stats != NULL)
+		return stats;
+
+	stats = g_object_new (GEDIT_TYPE_DOCINFO_STATS, NULL);
+	stats->priv->buffer = GTK_TEXT_BUFFER (doc);
+	g_object_add_weak_pointer (G_OBJECT (doc), (gpointer *)&stats->priv->buffer);
+
+	append_blocks (stats->priv->blocks,
+		       0,
+		       gtk_text_buffer_get_line_count (GTK_TEXT_BUFFER (doc)));
+
+	g_signal_connect (doc,
+			  "insert-text",
+			  G_CALLBACK (insert_text_cb),
+			  stats);
+	g_signal_connect_after (doc,
+				"insert-text",
+				G_CALLBACK (insert_text_after_cb),
+				stats);
+	g_signal_connect (doc,
+			  "delete-range",
+			  G_CALLBACK (delete_range_cb),
+			  stats);
+
+	g_object_set_data_full (G_OBJECT (doc), STATS_KEY, stats, g_object_unref);
+
+	schedule_update (stats);
+
+	return stats;
+}
+
+/**
+ * gedit_docinfo_stats_remove_from_document:
+ * @doc: a #GeditDocument
+ *
+ * Detaches the statistics of @doc, if any, and stops keeping them up to
+ * date, even if they are still referenced elsewhere.
+ */
+void
+gedit_docinfo_stats_remove_from_document (GeditDocument *doc)
+{
+	GeditDocinfoStats *stats;
+
+	g_return_if_fail (GEDIT_IS_DOCUMENT (doc));
+
+	stats = g_object_get_data (G_OBJECT (doc), STATS_KEY);
+
+	if (stats == NULL)
+		return;
+
+	g_object_ref (stats);
+	g_object_set_data (G_OBJECT (doc), STATS_KEY, NULL);
+
+	/* Disconnects from the document and removes the pending update */
+	g_object_run_dispose (G_OBJECT (stats));
+	g_object_unref (stats);
+}
+
+/**
+ * gedit_docinfo_stats_get_counts:
+ * @stats: a #GeditDocinfoStats
+ * @counts: (out): return location for the counts of the whole document
+ *
+ * Returns: %FALSE if the counts are being updated, in which case
+ * #GeditDocinfoStats::changed is emitted once they are available.
+ */
+gboolean
+gedit_docinfo_stats_get_counts (GeditDocinfoStats  *stats,
+				GeditDocinfoCounts *counts)
+{
+	g_return_val_if_fail (GEDIT_IS_DOCINFO_STATS (stats), FALSE);
+
+	if (!stats->priv->up_to_date)
+		return FALSE;
+
+	*counts = stats->priv->counts;
+	return TRUE;
+}
+
+/**
+ * gedit_docinfo_stats_count_range:
+ * @stats: a #GeditDocinfoStats
+ * @start: start of the range
+ * @end: end of the range
+ * @counts: (out): return location for the counts of the range
+ *
+ * Counts the text between @start and @end, reusing the cached counts of
+ * the blocks entirely contained in the range.
+ */
+void
+gedit_docinfo_stats_count_range (GeditDocinfoStats  *stats,
+				 const GtkTextIter  *start,
+				 const GtkTextIter  *end,
+				 GeditDocinfoCounts *counts)
+{
+	GeditDocinfoStatsPrivate *priv;
+	GtkTextIter range_start = *start;
+	gint start_line;
+	gint end_line;
+	gint line = 0;
+
+	g_return_if_fail (GEDIT_IS_DOCINFO_STATS (stats));
+	g_return_if_fail (stats->priv->buffer != NULL);
+
+	priv = stats->priv;
+
+	start_line = gtk_text_iter_get_line (start);
+	end_line = gtk_text_iter_get_line (end);
+
+	memset (counts, 0, sizeof (GeditDocinfoCounts));
+
+	for (guint i = 0; i < priv->blocks->len && line <= end_line; ++i)
+	{
+		Block *block = &g_array_index (priv->blocks, Block, i);
+		gint next_line = line + block->lines;
+
+		if (line >= start_line && next_line <= end_line + 1)
+		{
+			GtkTextIter block_start;
+			GtkTextIter block_end;
+
+			get_block_bounds (priv->buffer, line, block->lines, &block_start, &block_end);
+
+			if (gtk_text_iter_compare (&block_start, start) >= 0 &&
+			    gtk_text_iter_compare (&block_end, end) <= 0)
+			{
+				if (!block->valid)
+					count_block (stats, block, line);
+
+				count_range_direct (&range_start, &block_start, counts);
+				counts_add (counts, &block->counts);
+
+				range_start = block_end;
+			}
+		}
+
+		line = next_line;
+	}
+
+	count_range_direct (&range_start, end, counts);
+}
+
+/* Counts the text of @pending up to its last white space, or all of it
+ * when @at_end, and removes it from @pending.
+ */
+static gboolean
+count_pending (GString            *pending,
+	       gboolean            at_end,
+	       GeditDocinfoCounts *counts,
+	       GError            **error)
+{
+	gsize length = pending->len;
+
+	if (!at_end)
+	{
+		/* ASCII bytes are never part of a multibyte character */
+		while (length > 0 && !g_ascii_isspace (pending->str[length - 1]))
+			--length;
+
+		if (length == 0)
+		{
+			if (pending->len < 4 * STREAM_READ_SIZE)
+				return TRUE;
+
+			/* Give up on keeping words whole in very long ones,
+			   the last character may be incomplete */
+			length = g_utf8_find_prev_char (pending->str, pending->str + pending->len) - pending->str;
+		}
+	}
+
+	if (!g_utf8_validate (pending->str, length, NULL))
+	{
+		g_set_error_literal (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_INVALID_DATA,
+				     _("The file contains invalid characters"));
+		return FALSE;
+	}
+
+	gedit_docinfo_stats_count_text (pending->str, length, counts);
+	g_string_erase (pending, 0, length);
+
+	return TRUE;
+}
+
+/**
+ * gedit_docinfo_stats_count_stream:
+ * @stream: a #GInputStream providing UTF-8 text
+ * @cancellable: (nullable): a #GCancellable
+ * @counts: (out): return location for the counts of the stream
+ * @error: return location for a #GError
+ *
+ * Counts the text read from @stream, for files which are not loaded in a
+ * document. Only a few reads worth of text are kept in memory at a time.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+gedit_docinfo_stats_count_stream (GInputStream       *stream,
+				  GCancellable       *cancellable,
+				  GeditDocinfoCounts *counts,
+				  GError            **error)
+{
+	GString *pending;
+	gboolean ret = TRUE;
+
+	g_return_val_if_fail (G_IS_INPUT_STREAM (stream), FALSE);
+
+	memset (counts, 0, sizeof (GeditDocinfoCounts));
+	pending = g_string_sized_new (2 * STREAM_READ_SIZE);
+
+	while (ret)
+	{
+		gsize old_len = pending->len;
+		gssize n_read;
+
+		g_string_set_size (pending, old_len + STREAM_READ_SIZE);
+
+		n_read = g_input_stream_read (stream,
+					      pending->str + old_len,
+					      STREAM_READ_SIZE,
+					      cancellable,
+					      error);
+
+		if (n_read < 0)
+		{
+			ret = FALSE;
+			break;
+		}
+
+		g_string_truncate (pending, old_len + n_read);
+
+		if (n_read == 0)
+		{
+			ret = count_pending (pending, TRUE, counts, error);
+			break;
+		}
+
+		ret = count_pending (pending, FALSE, counts, error);
+	}
+
+	g_string_free (pending, TRUE);
+	return ret;
+}
+
+void
+_gedit_docinfo_stats_register_type (GTypeModule *type_module)
+{
+	gedit_docinfo_stats_register_type (type_module);
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,94 @@
+/*
+ * gedit-docinfo-stats.h
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GEDIT_DOCINFO_STATS_H
+#define GEDIT_DOCINFO_STATS_H
+
+#include <gio/gio.h>
+#include <gedit/gedit-document.h>
+
+G_BEGIN_DECLS
+
+#define GEDIT_TYPE_DOCINFO_STATS		(gedit_docinfo_stats_get_type ())
+#define GEDIT_DOCINFO_STATS(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GEDIT_TYPE_DOCINFO_STATS, GeditDocinfoStats))
+#define GEDIT_DOCINFO_STATS_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GEDIT_TYPE_DOCINFO_STATS, GeditDocinfoStatsClass))
+#define GEDIT_IS_DOCINFO_STATS(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GEDIT_TYPE_DOCINFO_STATS))
+#define GEDIT_IS_DOCINFO_STATS_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GEDIT_TYPE_DOCINFO_STATS))
+#define GEDIT_DOCINFO_STATS_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GEDIT_TYPE_DOCINFO_STATS, GeditDocinfoStatsClass))
+
+typedef struct _GeditDocinfoStats		GeditDocinfoStats;
+typedef struct _GeditDocinfoStatsPrivate	GeditDocinfoStatsPrivate;
+typedef struct _GeditDocinfoStatsClass		GeditDocinfoStatsClass;
+typedef struct _GeditDocinfoCounts		GeditDocinfoCounts;
+
+struct _GeditDocinfoCounts
+{
+	gint64 chars;
+	gint64 words;
+	gint64 white_chars;
+	gint64 bytes;
+};
+
+struct _GeditDocinfoStats
+{
+	GObject parent;
+
+	/*< private >*/
+	GeditDocinfoStatsPrivate *priv;
+};
+
+struct _GeditDocinfoStatsClass
+{
+	GObjectClass parent_class;
+
+	/* Emitted when the counts of the whole document are up to date again */
+	void (* changed) (GeditDocinfoStats *stats);
+};
+
+GType			 gedit_docinfo_stats_get_type		(void) G_GNUC_CONST;
+
+GeditDocinfoStats	*gedit_docinfo_stats_get_for_document	(GeditDocument      *doc);
+
+void			 gedit_docinfo_stats_remove_from_document (GeditDocument    *doc);
+
+gboolean		 gedit_docinfo_stats_get_counts		(GeditDocinfoStats  *stats,
+								 GeditDocinfoCounts *counts);
+
+void			 gedit_docinfo_stats_count_range	(GeditDocinfoStats  *stats,
+								 const GtkTextIter  *start,
+								 const GtkTextIter  *end,
+								 GeditDocinfoCounts *counts);
+
+void			 gedit_docinfo_stats_count_text		(const gchar        *text,
+								 gssize              length,
+								 GeditDocinfoCounts *counts);
+
+gboolean		 gedit_docinfo_stats_count_stream	(GInputStream       *stream,
+								 GCancellable       *cancellable,
+								 GeditDocinfoCounts *counts,
+								 GError            **error);
+
+void			 _gedit_docinfo_stats_register_type	(GTypeModule        *type_module);
+
+G_END_DECLS
+
+#endif /* GEDIT_DOCINFO_STATS_H */
+
+/* ex:set ts=8 noet: */
@@ -24,6 +24,7 @@ import signal
 import locale
 import subprocess
 import fcntl
+import codecs
 from gi.repository import GLib, GObject
 
 try:
@@ -41,7 +42,17 @@ class Capture(GObject.Object):
     CAPTURE_NEEDS_SHELL = 0x04
 
     WRITE_BUFFER_SIZE = 0x4000
+    READ_BUFFER_SIZE = 0x10000
 
+    # Output read before going back to the main loop
+    MAX_READ_SIZE = 0x100000
+
+    # Below the redraws of GTK+ (HIGH_IDLE + 20), so that a tool printing a
+    # lot does not freeze the window, and above the idle which emits
+    # end-execute, so that it comes after all the output.
+    READ_PRIORITY = GLib.PRIORITY_HIGH_IDLE + 30
+
+    # The std*-line signals are emitted with one or more complete lines
     __gsignals__ = {
         'stdout-line': (GObject.SignalFlags.RUN_LAST, GObject.TYPE_NONE, (GObject.TYPE_STRING,)),
         'stderr-line': (GObject.SignalFlags.RUN_LAST, GObject.TYPE_NONE, (GObject.TYPE_STRING,)),
@@ -99,6 +110,13 @@ class Capture(GObject.Object):
         self.out_channel_id = 0
         self.err_channel_id = 0
 
+        self.decoders = {}
+        self.partial_lines = {}
+
+        for signalname in ('stdout-line', 'stderr-line'):
+            self.decoders[signalname] = codecs.getincrementaldecoder('utf-8')('replace')
+            self.partial_lines[signalname] = ''
+
         try:
             self.pipe = subprocess.Popen(self.command, **popen_args)
         except OSError as e:
@@ -138,8 +156,9 @@ class Capture(GObject.Object):
     def add_out_watch(self, fd, io_func):
         channel = GLib.IOChannel.unix_new(fd)
         channel.set_flags(channel.get_flags() | GLib.IOFlags.NONBLOCK)
+        channel.set_encoding(None)
         channel_id = GLib.io_add_watch(channel,
-                                       GLib.PRIORITY_DEFAULT,
+                                       self.READ_PRIORITY,
                                        GLib.IOCondition.IN | GLib.IOCondition.HUP | GLib.IOCondition.ERR,
                                        io_func)
         return (channel, channel_id)
@@ -180,23 +199,58 @@ class Capture(GObject.Object):
 
         return ret
 
+    def read_available(self, fd):
+        """
+        Reads what is available on the non-blocking fd, up to MAX_READ_SIZE.
+        Returns the data and whether the end of the output was reached.
+        """
+        chunks = []
+        size = 0
+
+        while size < self.MAX_READ_SIZE:
+            try:
+                data = os.read(fd, self.READ_BUFFER_SIZE)
+            except BlockingIOError:
+                return (b''.join(chunks), False)
+            except OSError:
+                return (b''.join(chunks), True)
+
+            if not data:
+                return (b''.join(chunks), True)
+
+            chunks.append(data)
+            size += len(data)
+
+        return (b''.join(chunks), False)
+
+    def emit_lines(self, signalname, text, eof):
+        # The end of an incomplete line waits for the rest of the output
+        text = self.partial_lines[signalname] + text
+
+        if eof:
+            end = len(text)
+        else:
+            end = text.rfind('\n') + 1
+
+        self.partial_lines[signalname] = text[end:]
+
+        if end > 0:
+            self.emit(signalname, text[:end])
+
     def handle_source(self, source, condition, signalname):
+        data = b''
+        eof = True
+
         if condition & (GObject.IO_IN | GObject.IO_PRI):
-            status = GLib.IOStatus.NORMAL
-            while status == GLib.IOStatus.NORMAL:
-                try:
-                    (status, buf, length, terminator_pos) = source.read_line()
-                except Exception as e:
-                    return False
-                if buf:
-                    self.emit(signalname, buf)
-            if status != GLib.IOStatus.AGAIN:
-                return False
+            (data, eof) = self.read_available(source.unix_get_fd())
 
-        if condition & ~(GObject.IO_IN | GObject.IO_PRI):
-            return False
+        if condition & GObject.IO_ERR:
+            eof = True
 
-        return True
+        text = self.decoders[signalname].decode(data, eof)
+        self.emit_lines(signalname, text, eof)
+
+        return not eof
 
     def on_output(self, source, condition):
         ret = self.handle_source(source, condition, 'stdout-line')
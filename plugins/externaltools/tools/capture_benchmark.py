@@ -0,0 +1,99 @@
+# -*- coding: utf-8 -*-
+#
+#    Copyright (C) 2026 - The gedit Team
+#
+#    This program is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 2 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program; if not, write to the Free Software
+#    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+"""
+Measures how fast Capture reads the output of a tool: a synthetic build log
+is written to a temporary file, and the time taken by Capture to read it
+through 'cat' and to emit its lines is reported.
+
+Run it from this directory, like linkparsing_test.py:
+
+    python3 capture_benchmark.py [size of the log in MiB]
+"""
+
+import os
+import sys
+import tempfile
+import time
+from gi.repository import GLib
+from capture import Capture
+from linkparsing_benchmark import make_log
+
+# The lines of the log written at once
+CHUNK_LINES = 100000
+
+
+def write_log(f, size):
+    written = 0
+
+    while written < size:
+        chunk = make_log(CHUNK_LINES).encode('utf-8')
+        f.write(chunk)
+        written += len(chunk)
+
+    return written
+
+
+def run_capture(path):
+    loop = GLib.MainLoop()
+    stats = {'lines': 0, 'signals': 0, 'status': None}
+
+    def on_line(capture, text):
+        stats['lines'] += text.count('\n')
+        stats['signals'] += 1
+
+    def on_end_execute(capture, status):
+        stats['status'] = status
+        loop.quit()
+
+    capture = Capture(['cat', path], env=os.environ.copy())
+    capture.set_flags(Capture.CAPTURE_STDOUT)
+    capture.connect('stdout-line', on_line)
+    capture.connect('end-execute', on_end_execute)
+
+    start = time.perf_counter()
+    capture.execute()
+    loop.run()
+
+    return time.perf_counter() - start, stats
+
+
+def main(argv):
+    size = int(argv[1]) if len(argv) > 1 else 100
+
+    with tempfile.NamedTemporaryFile(suffix='.log') as f:
+        written = write_log(f, size * 1024 * 1024)
+        f.flush()
+
+        elapsed, stats = run_capture(f.name)
+
+    if stats['status'] != 0:
+        print("The command failed with status %s" % (stats['status'], ))
+        return 1
+
+    mib = written / (1024 * 1024)
+
+    print("%.1f MiB, %d lines in %d signals" % (mib, stats['lines'], stats['signals']))
+    print("%.3f s, %.0f lines/s, %.1f MiB/s" % (elapsed, stats['lines'] / elapsed, mib / elapsed))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
+
+# ex:ts=4:et:
@@ -36,22 +36,37 @@ class FileLookup:
         self.providers.append(OpenDocumentRelPathFileLookupProvider())
         self.providers.append(OpenDocumentFileLookupProvider())
 
+        # the results of the lookups, a tool often repeats the same paths
+        self.cache = {}
+
     def lookup(self, path):
         """
         Tries to find a file specified by the path parameter. It delegates to
         different lookup providers and the first match is returned. If no file
-        was found then None is returned.
+        was found then None is returned. The result is cached until
+        clear_cache() is called.
 
         path -- the path to find
         """
+        if path in self.cache:
+            return self.cache[path]
+
         found_file = None
         for provider in self.providers:
             found_file = provider.lookup(path)
             if found_file is not None:
                 break
 
+        self.cache[path] = found_file
         return found_file
 
+    def clear_cache(self):
+        """
+        Forgets the results of the previous lookups, the files may have been
+        created or removed since.
+        """
+        self.cache = {}
+
 
 class FileLookupProvider:
     """
@@ -60,10 +60,16 @@ class LinkParser:
     register in this class cunstructor using the method add_parser. If you want
     to add a regular expression then just call add_regexp in this class
     constructor and provide your regexp string as argument.
+
+    The regular expressions are combined into two alternations, the ones
+    anchored at the start of a line and the others, so that the text is
+    scanned twice whatever their number.
     """
 
     def __init__(self):
         self._providers = []
+        self._regexps = []
+        self._regexp_parser = None
         self.add_regexp(REGEXP_STANDARD)
         self.add_regexp(REGEXP_PYTHON)
         self.add_regexp(REGEXP_VALAC)
@@ -84,7 +90,8 @@ class LinkParser:
         a group named ln. To read more about this look at the documentation
         for the RegexpLinkParser constructor.
         """
-        self.add_parser(RegexpLinkParser(regexp))
+        self._regexps.append(regexp)
+        self._regexp_parser = None
 
     def parse(self, text):
         """
@@ -98,7 +105,10 @@ class LinkParser:
         if text is None:
             raise ValueError("text can not be None")
 
-        links = []
+        if self._regexp_parser is None:
+            self._regexp_parser = CombinedRegexpLinkParser(self._regexps)
+
+        links = self._regexp_parser.parse(text)
 
         for provider in self._providers:
             links.extend(provider.parse(text))
@@ -161,6 +171,122 @@ class RegexpLinkParser(AbstractLinkParser):
 
         return links
 
+
+class CombinedRegexpLinkParser(AbstractLinkParser):
+    """
+    A parser matching several regular expressions, following the rules of
+    RegexpLinkParser, in few scans of the text. The regular expressions
+    anchored at the start of a line are joined in an alternation behind a
+    single '^', and the other ones in a second alternation, where the first
+    one matching at a position wins. The links are returned in the order of
+    the text.
+
+    A match hides the matches of the other regular expressions of its
+    alternation overlapping it, e.g. 'a.c:3: also test.sh: line 5: x' is
+    both a standard and a bash link. So the rest of the line of a match is
+    also searched with each regular expression of the alternation alone, and
+    the links are the same as the ones found by a RegexpLinkParser per
+    regular expression.
+    """
+
+    def __init__(self, regexps):
+        """
+        Creates a new CombinedRegexpLinkParser for the given list of regular
+        expression strings. Since the names of the groups must be unique, the
+        groups of each regular expression are suffixed with its index, and
+        the whole regular expression is captured by a group named 're' with
+        the same suffix.
+        """
+        anchored = []
+        alternatives = []
+
+        self._res = [re.compile(regexp, re.MULTILINE | re.VERBOSE)
+                     for regexp in regexps]
+
+        # the indexes of the regexps of each alternation
+        self._anchored = []
+        self._unanchored = []
+
+        for i, regexp in enumerate(regexps):
+            regexp = re.sub(r"\(\?P<(\w+)>", r"(?P<\g<1>%d>" % i, regexp)
+
+            m = re.match(r"\s*\^", regexp)
+            if m:
+                anchored.append("(?P<re%d>%s\n)" % (i, regexp[m.end():]))
+                self._anchored.append(i)
+            else:
+                alternatives.append("(?P<re%d>%s\n)" % (i, regexp))
+                self._unanchored.append(i)
+
+        # A single alternation would be slower than the two: the
+        # alternatives which are not anchored make the '^' be tried at
+        # each position in turn with them.
+        self._scans = []
+
+        if anchored:
+            self._scans.append((re.compile("^(?:%s)" % "|".join(anchored),
+                                           re.MULTILINE | re.VERBOSE),
+                                self._anchored))
+
+        if alternatives:
+            self._scans.append((re.compile("|".join(alternatives),
+                                           re.MULTILINE | re.VERBOSE),
+                                self._unanchored))
+
+    def _make_link(self, m, suffix=""):
+        path = m.group("pth" + suffix)
+        line_nr = m.group("ln" + suffix)
+        start = m.start("lnk" + suffix)
+        end = m.end("lnk" + suffix)
+
+        # some regexes may have a col group
+        col_nr = 0
+        if "col" + suffix in m.re.groupindex and m.group("col" + suffix) is not None:
+            col_nr = m.group("col" + suffix)
+
+        return Link(path, line_nr, col_nr, start, end)
+
+    def _parse_scan(self, text, scan, indexes, links):
+        # where each regexp alone would search from
+        ends = dict.fromkeys(indexes, 0)
+
+        for m in scan.finditer(text):
+            # the group around the whole regexp is the last one closed
+            i = int(m.lastgroup[len("re"):])
+
+            if m.start() >= ends[i]:
+                links.append(self._make_link(m, str(i)))
+                ends[i] = m.end()
+
+            # the other matches starting in this one are hidden from the
+            # scan, they can only be in the rest of the line
+            line_end = text.find("\n", m.start())
+            line_end = len(text) if line_end < 0 else line_end + 1
+
+            for j in indexes:
+                pos = max(m.start(), ends[j])
+
+                while pos < m.end():
+                    sm = self._res[j].search(text, pos, max(line_end, m.end()))
+
+                    if sm is None or sm.start() >= m.end():
+                        break
+
+                    links.append(self._make_link(sm))
+                    ends[j] = sm.end()
+
+                    pos = max(sm.end(), sm.start() + 1)
+
+    def parse(self, text):
+        links = []
+
+        for scan, indexes in self._scans:
+            self._parse_scan(text, scan, indexes, links)
+
+        links.sort(key=lambda link: link.start)
+
+        return links
+
 # gcc 'test.c:13: warning: ...'
 # grep 'test.c:5:int main(...'
 # javac 'Test.java:13: ...'
@@ -0,0 +1,120 @@
+# -*- coding: utf-8 -*-
+#
+#    Copyright (C) 2026 - The gedit Team
+#
+#    This program is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 2 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program; if not, write to the Free Software
+#    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+"""
+Compares the time taken by LinkParser, which scans the text with all its
+regular expressions combined in two alternations, with running a
+RegexpLinkParser per regular expression as it used to do, on a synthetic
+build log.
+
+Run it from this directory, like linkparsing_test.py:
+
+    python3 linkparsing_benchmark.py [number of lines]
+"""
+
+import sys
+import time
+from linkparsing import LinkParser, RegexpLinkParser
+
+# The lines of the output of the tests, one line out of ten of the log is
+# made of them, the others do not contain links.
+LINK_LINES = [
+    "test.c:5:6: warning: unused variable 'x'",
+    "  File \"test.py\", line 13, in <module>",
+    "Test.vala:14.13-14.21: error: Assignment: Cannot convert from `string' to `int'",
+    "test.sh: line 5: fake: command not found",
+    "test.rb:5: undefined method `fake_method' for main:Object (NoMethodError)",
+    "\tfrom test.rb:3:in `each'",
+    "syntax error at test.pl line 88, near \"$fake_var\"",
+    "Test.cs(12,7): error CS0103: The name `fakeMethod'",
+    "a.c:3: also test.sh: line 5: x",
+]
+
+OTHER_LINES = [
+    "make[2]: Entering directory '/home/user/project/build/src'",
+    "  CC       libproject_la-document.lo",
+    "  CCLD     libproject.la",
+    "[ 42%] Building C object src/CMakeFiles/project.dir/document.c.o",
+    "In file included from ../src/document.h:27,",
+    "      |         ^~~~~~~~~~~~~~~~~~~~~~~~~~~~~",
+    "ninja: no work to do.",
+    "Running the tests, this can take a while",
+    "make[2]: Leaving directory '/home/user/project/build/src'",
+]
+
+
+def make_log(n_lines):
+    lines = []
+
+    for i in range(n_lines):
+        if i % 10 == 0:
+            lines.append(LINK_LINES[(i // 10) % len(LINK_LINES)])
+        else:
+            lines.append(OTHER_LINES[i % len(OTHER_LINES)])
+
+    return "\n".join(lines) + "\n"
+
+
+def parse_separately(parser, text):
+    links = []
+
+    for regexp in parser._regexps:
+        links.extend(RegexpLinkParser(regexp).parse(text))
+
+    return links
+
+
+def best_time(func, text, runs=3):
+    best = None
+
+    for i in range(runs):
+        start = time.perf_counter()
+        result = func(text)
+        elapsed = time.perf_counter() - start
+
+        if best is None or elapsed < best:
+            best = elapsed
+
+    return best, result
+
+
+def main(argv):
+    n_lines = int(argv[1]) if len(argv) > 1 else 200000
+
+    text = make_log(n_lines)
+    parser = LinkParser()
+
+    separate_time, separate_links = best_time(lambda t: parse_separately(parser, t), text)
+    combined_time, combined_links = best_time(parser.parse, text)
+
+    if sorted(map(repr, separate_links)) != sorted(map(repr, combined_links)):
+        print("The links found are not the same")
+        return 1
+
+    size = len(text) / (1024 * 1024)
+
+    print("%d lines, %.1f MiB, %d links" % (n_lines, size, len(combined_links)))
+    print("separate regexps: %.3f s, %.1f MiB/s" % (separate_time, size / separate_time))
+    print("combined regexps: %.3f s, %.1f MiB/s" % (combined_time, size / combined_time))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
+
+# ex:ts=4:et:
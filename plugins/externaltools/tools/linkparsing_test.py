@@ -17,7 +17,7 @@
 #    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 import unittest
-from linkparsing import LinkParser
+from linkparsing import LinkParser, RegexpLinkParser
 
 
 class LinkParserTest(unittest.TestCase):
@@ -197,6 +197,54 @@ test.rb:5: undefined method `fake_method' for main:Object (NoMethodError)
         self.assert_link(lnk, "hello.pas", 11)
         self.assert_link_text(line, lnk, 'hello.pas(11,1)')
 
+    def test_parse_mixed_output_in_text_order(self):
+        output = """
+make[1]: Entering directory '/tmp/build'
+test.c:5:6: warning: unused variable 'x'
+  File "test.py", line 13, in <module>
+syntax error at test.pl line 88, near "$fake_var"
+Test.cs(12,7): error CS0103: The name `fakeMethod'
+test.sh: line 5: fake: command not found
+"""
+        links = self.p.parse(output)
+        self.assert_link_count(links, 5)
+        self.assert_link(links[0], "test.c", 5, 6)
+        self.assert_link(links[1], "test.py", 13)
+        self.assert_link(links[2], "test.pl", 88)
+        self.assert_link(links[3], "Test.cs", 12)
+        self.assert_link(links[4], "test.sh", 5)
+        self.assert_link_text(output, links[2], 'test.pl line 88')
+        self.assert_link_text(output, links[4], 'test.sh: line 5')
+
+    def test_parse_overlapping_links(self):
+        line = 'a.c:3: also test.sh: line 5: x'
+        links = self.p.parse(line)
+        self.assert_link_count(links, 2)
+        self.assert_link(links[0], "a.c", 3)
+        self.assert_link_text(line, links[0], 'a.c:3')
+        self.assert_link(links[1], "a.c:3: also test.sh", 5)
+        self.assert_link_text(line, links[1], 'a.c:3: also test.sh: line 5')
+
+    def test_parse_same_links_as_each_regexp(self):
+        output = """
+test.c:5:6: warning: unused variable 'x'
+  File "test.py", line 13, in <module>
+Test.vala:14.13-14.21: error: Assignment: Cannot convert from `string' to `int'
+test.sh: line 5: fake: command not found
+test.rb:5: undefined method `fake_method' for main:Object (NoMethodError)
+	from test.rb:3:in `each'
+syntax error at test.pl line 88, near "$fake_var"
+Test.cs(12,7): error CS0103: The name `fakeMethod'
+a.c:3: also test.sh: line 5: x
+test.c:7: error at test.h line 9
+""" * 100
+        expected = []
+        for regexp in self.p._regexps:
+            expected.extend(RegexpLinkParser(regexp).parse(output))
+
+        links = self.p.parse(output)
+        self.assertEqual(sorted(map(repr, links)), sorted(map(repr, expected)))
+
 if __name__ == '__main__':
     unittest.main()
 
@@ -20,6 +20,7 @@
 __all__ = ('OutputPanel', 'UniqueById')
 
 import os
+import tempfile
 from weakref import WeakKeyDictionary
 from .capture import *
 import re
@@ -57,12 +58,14 @@ class OutputPanel(UniqueById):
 
         callbacks = {
             'on_stop_clicked': self.on_stop_clicked,
+            'on_open_full_output_clicked': self.on_open_full_output_clicked,
             'on_view_visibility_notify_event': self.on_view_visibility_notify_event,
             'on_view_motion_notify_event': self.on_view_motion_notify_event
         }
 
         self.profile_settings = self.get_profile_settings()
         self.profile_settings.connect("changed", self.font_changed)
+        self.profile_settings.connect("changed::scrollback-lines", self.scrollback_lines_changed)
         self.system_settings = Gio.Settings.new("org.gnome.desktop.interface")
         self.system_settings.connect("changed::monospace-font-name", self.font_changed)
 
@@ -93,12 +96,29 @@ class OutputPanel(UniqueById):
         self.link_tag = buffer.create_tag('link')
         self.link_tag.set_property('underline', Pango.Underline.SINGLE)
 
+        # Stays at the end of the text, to scroll to it
+        self.end_mark = buffer.create_mark('end', buffer.get_end_iter(), False)
+
         self.link_cursor = Gdk.Cursor.new(Gdk.CursorType.HAND2)
         self.normal_cursor = Gdk.Cursor.new(Gdk.CursorType.XTERM)
 
         self.process = None
 
+        # The links are in the order of the text, their offsets count the
+        # characters already removed from the start of the buffer.
         self.links = []
+        self.evicted_chars = 0
+        self.scrollback_lines_changed()
+
+        # The whole output of the last tool, when save-full-output is set
+        self.log_file = None
+        self.log_path = None
+
+        # Text written since the last flush, as (text, tag) pairs
+        self.pending = []
+        self.flush_id = 0
+        self.flush_on_tick = False
+        self['view'].connect('unmap', self.on_view_unmap)
 
         self.link_parser = linkparsing.LinkParser()
         self.file_lookup = filelookup.FileLookup(window)
@@ -117,6 +137,9 @@ class OutputPanel(UniqueById):
 
         self["view"].override_font(font_desc)
 
+    def scrollback_lines_changed(self, settings=None, key=None):
+        self.scrollback_lines = self.profile_settings.get_int("scrollback-lines")
+
     def set_process(self, process):
         self.process = process
 
@@ -131,52 +154,178 @@ class OutputPanel(UniqueById):
             self.process.stop(-1)
 
     def scroll_to_end(self):
-        iter = self['view'].get_buffer().get_end_iter()
-        self['view'].scroll_to_iter(iter, 0.0, False, 0.5, 0.5)
-        return False  # don't requeue this handler
+        self['view'].scroll_to_mark(self.end_mark, 0.0, False, 0.5, 0.5)
+
+    def on_open_full_output_clicked(self, widget, *args):
+        if self.log_file is None:
+            return
+
+        self.log_file.flush()
+
+        gfile = Gio.File.new_for_path(self.log_path)
+        Gedit.commands_load_location(self.window, gfile, None, 0, 0)
+
+    def open_log_file(self):
+        # The same file is kept for all the tools run in this window, it
+        # is truncated when a new tool starts.
+        if self.log_file is None:
+            fd, self.log_path = tempfile.mkstemp(prefix='gedit-tool-output-', suffix='.log')
+            self.log_file = open(fd, 'w', encoding='utf-8', errors='replace')
+        else:
+            self.log_file.seek(0)
+            self.log_file.truncate()
+
+    def close_log_file(self):
+        if self.log_file is None:
+            return
+
+        self.log_file.close()
+
+        try:
+            os.unlink(self.log_path)
+        except OSError:
+            pass
+
+        self.log_file = None
+        self.log_path = None
 
     def clear(self):
+        self.cancel_flush()
+        self.pending = []
         self['view'].get_buffer().set_text("")
         self.links = []
+        self.evicted_chars = 0
+        self.file_lookup.clear_cache()
+        self['open-full-output'].hide()
+
+        if self.profile_settings.get_boolean("save-full-output"):
+            self.open_log_file()
+        else:
+            self.close_log_file()
+
+    def deactivate(self):
+        self.cancel_flush()
+        self.close_log_file()
 
     def visible(self):
         panel = self.window.get_bottom_panel()
         return panel.props.visible and panel.props.visible_child == self.panel
 
     def write(self, text, tag=None):
-        buffer = self['view'].get_buffer()
+        # The text is inserted at most once per frame, a tool can print a
+        # lot of lines between two frames.
+        self.pending.append((text, tag))
+
+        if self.flush_id == 0:
+            self.queue_flush()
+
+    def queue_flush(self):
+        view = self['view']
+
+        # Tick callbacks are only run while the view is mapped
+        if view.get_mapped():
+            self.flush_id = view.add_tick_callback(self.on_flush_tick)
+            self.flush_on_tick = True
+        else:
+            self.flush_id = GLib.idle_add(self.flush)
+            self.flush_on_tick = False
 
-        end_iter = buffer.get_end_iter()
-        insert = buffer.create_mark(None, end_iter, True)
+    def cancel_flush(self):
+        if self.flush_id == 0:
+            return
 
-        if tag is None:
-            buffer.insert(end_iter, text)
+        if self.flush_on_tick:
+            self['view'].remove_tick_callback(self.flush_id)
         else:
-            buffer.insert_with_tags(end_iter, text, tag)
+            GLib.source_remove(self.flush_id)
+
+        self.flush_id = 0
+
+    def on_view_unmap(self, view):
+        if self.flush_id != 0 and self.flush_on_tick:
+            self.cancel_flush()
+            self.queue_flush()
+
+    def on_flush_tick(self, view, frame_clock):
+        return self.flush()
+
+    def flush(self):
+        self.flush_id = 0
+
+        # Consecutive texts with the same tag are inserted at once
+        runs = []
+        for text, tag in self.pending:
+            if runs and runs[-1][1] is tag:
+                runs[-1][0].append(text)
+            else:
+                runs.append(([text], tag))
+
+        self.pending = []
 
-        # find all links and apply the appropriate tag for them
-        links = self.link_parser.parse(text)
-        for lnk in links:
-            insert_iter = buffer.get_iter_at_mark(insert)
-            lnk.start = insert_iter.get_offset() + lnk.start
-            lnk.end = insert_iter.get_offset() + lnk.end
+        buffer = self['view'].get_buffer()
 
-            start_iter = buffer.get_iter_at_offset(lnk.start)
-            end_iter = buffer.get_iter_at_offset(lnk.end)
+        for texts, tag in runs:
+            text = ''.join(texts)
+            offset = buffer.get_char_count()
 
-            tag = None
+            if self.log_file is not None:
+                self.log_file.write(text)
 
-            # if the link points to an existing file then it is a valid link
-            if self.file_lookup.lookup(lnk.path) is not None:
-                self.links.append(lnk)
-                tag = self.link_tag
+            if tag is None:
+                buffer.insert(buffer.get_end_iter(), text)
             else:
-                tag = self.invalid_link_tag
+                buffer.insert_with_tags(buffer.get_end_iter(), text, tag)
+
+            # find all links and apply the appropriate tag for them
+            links = self.link_parser.parse(text)
+            for lnk in links:
+                start_iter = buffer.get_iter_at_offset(offset + lnk.start)
+                end_iter = buffer.get_iter_at_offset(offset + lnk.end)
+
+                lnk.start = self.evicted_chars + offset + lnk.start
+                lnk.end = self.evicted_chars + offset + lnk.end
+
+                tag = None
+
+                # if the link points to an existing file then it is a valid link
+                if self.file_lookup.lookup(lnk.path) is not None:
+                    self.links.append(lnk)
+                    tag = self.link_tag
+                else:
+                    tag = self.invalid_link_tag
+
+                buffer.apply_tag(tag, start_iter, end_iter)
+
+        self.evict_lines(buffer)
+        self.scroll_to_end()
+
+        return False  # don't requeue this handler
+
+    def evict_lines(self, buffer):
+        if self.scrollback_lines <= 0:
+            return
+
+        # The lines are removed a tenth of the scrollback at a time, not
+        # on each flush.
+        excess = buffer.get_line_count() - self.scrollback_lines
+        if excess < max(self.scrollback_lines // 10, 1):
+            return
+
+        end_iter = buffer.get_iter_at_line(excess)
+        self.evicted_chars += end_iter.get_offset()
+        buffer.delete(buffer.get_start_iter(), end_iter)
+
+        # The links do not span several lines, so none of them is cut
+        count = 0
+        for lnk in self.links:
+            if lnk.end > self.evicted_chars:
+                break
+            count += 1
 
-            buffer.apply_tag(tag, start_iter, end_iter)
+        del self.links[:count]
 
-        buffer.delete_mark(insert)
-        GLib.idle_add(self.scroll_to_end)
+        if self.log_file is not None:
+            self['open-full-output'].show()
 
     def show(self):
         panel = self.window.get_bottom_panel()
@@ -219,7 +368,7 @@ class OutputPanel(UniqueById):
         (over_text, iter_at_xy) = view.get_iter_at_location(buff_x, buff_y)
         if not over_text:
             return None
-        offset = iter_at_xy.get_offset()
+        offset = self.evicted_chars + iter_at_xy.get_offset()
 
         # find the first link that contains the offset
         for lnk in self.links:
@@ -133,6 +133,7 @@ class WindowActivatable(GObject.Object, Gedit.WindowActivatable):
         self.actions.deactivate()
         bottom = self.window.get_bottom_panel()
         bottom.remove(self._output_buffer.panel)
+        self._output_buffer.deactivate()
         self.window.external_tools_window_activatable = None
 
     def update_actions(self):
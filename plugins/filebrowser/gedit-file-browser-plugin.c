@@ -38,6 +38,8 @@
 #include "gedit-file-browser-error.h"
 #include "gedit-file-browser-widget.h"
 #include "gedit-file-browser-messages.h"
+#include "gedit-file-browser-search.h"
+#include "gedit-file-browser-search-panel.h"
 
 #define FILEBROWSER_BASE_SETTINGS	"org.gnome.gedit.plugins.filebrowser"
 #define FILEBROWSER_TREE_VIEW		"tree-view"
@@ -66,6 +68,7 @@ struct _GeditFileBrowserPluginPrivate
 	GeditWindow            *window;
 
 	GeditFileBrowserWidget *tree_widget;
+	GtkWidget              *search_panel;
 	gboolean	        auto_root;
 	gulong                  end_loading_handle;
 	gboolean		confirm_trash;
@@ -123,6 +126,8 @@ G_DEFINE_DYNAMIC_TYPE_EXTENDED (GeditFileBrowserPlugin,
 				_gedit_file_browser_store_register_type		(type_module);		\
 				_gedit_file_browser_view_register_type		(type_module);		\
 				_gedit_file_browser_widget_register_type	(type_module);		\
+				_gedit_file_browser_search_register_type	(type_module);		\
+				_gedit_file_browser_search_panel_register_type	(type_module);		\
 )
 
 static GSettings *
@@ -459,6 +464,36 @@ open_in_terminal (GeditFileBrowserWidget *widget,
 	}
 }
 
+static void
+search_in_files (GeditFileBrowserWidget *widget,
+                 GFile                  *location,
+                 GeditFileBrowserPlugin *plugin)
+{
+	GeditFileBrowserPluginPrivate *priv = plugin->priv;
+	GtkWidget *panel;
+
+	panel = gedit_window_get_bottom_panel (priv->window);
+
+	if (priv->search_panel == NULL)
+	{
+		priv->search_panel = gedit_file_browser_search_panel_new (priv->window,
+		                                                          gedit_file_browser_widget_get_browser_store (widget));
+
+		gtk_stack_add_titled (GTK_STACK (panel),
+		                      priv->search_panel,
+		                      "GeditFileBrowserSearchPanel",
+		                      _("Search in Files"));
+
+		gtk_widget_show (priv->search_panel);
+	}
+
+	gtk_stack_set_visible_child (GTK_STACK (panel), priv->search_panel);
+	gtk_widget_show (panel);
+
+	gedit_file_browser_search_panel_set_location (GEDIT_FILE_BROWSER_SEARCH_PANEL (priv->search_panel),
+	                                              location);
+}
+
 static void
 gedit_file_browser_plugin_update_state (GeditWindowActivatable *activatable)
 {
@@ -504,6 +539,11 @@ gedit_file_browser_plugin_activate (GeditWindowActivatable *activatable)
 	                  G_CALLBACK (open_in_terminal),
 	                  plugin);
 
+	g_signal_connect (priv->tree_widget,
+	                  "search-in-files",
+	                  G_CALLBACK (search_in_files),
+	                  plugin);
+
 	g_signal_connect (priv->tree_widget,
 	                  "set-active-root",
 	                  G_CALLBACK (set_active_root),
@@ -596,6 +636,13 @@ gedit_file_browser_plugin_deactivate (GeditWindowActivatable *activatable)
 					     priv->confirm_trash_handle);
 	}
 
+	if (priv->search_panel != NULL)
+	{
+		panel = gedit_window_get_bottom_panel (priv->window);
+		gtk_container_remove (GTK_CONTAINER (panel), priv->search_panel);
+		priv->search_panel = NULL;
+	}
+
 	panel = gedit_window_get_side_panel (priv->window);
 	gtk_container_remove (GTK_CONTAINER (panel), GTK_WIDGET (priv->tree_widget));
 }
@@ -0,0 +1,474 @@
+/*
+ * gedit-file-browser-search-panel.c - Bottom panel showing the matches of
+ * a search in the files of the file browser
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gedit-file-browser-search-panel.h"
+
+#include <glib/gi18n-lib.h>
+#include <gedit/gedit-commands.h>
+
+#include "gedit-file-browser-search.h"
+
+enum
+{
+	COLUMN_MARKUP,
+	COLUMN_LOCATION,
+	COLUMN_LINE,
+	COLUMN_COLUMN,
+	N_COLUMNS
+};
+
+struct _GeditFileBrowserSearchPanelPrivate
+{
+	GeditWindow            *window;
+	GeditFileBrowserStore  *store;
+
+	/* The directory to search in */
+	GFile                  *location;
+
+	GtkWidget              *search_entry;
+	GtkWidget              *match_case_checkbutton;
+	GtkWidget              *regex_checkbutton;
+	GtkWidget              *status_label;
+	GtkWidget              *treeview;
+	GtkTreeStore           *results;
+
+	GeditFileBrowserSearch *search;
+	gint                    n_matches;
+	gint                    n_files;
+};
+
+G_DEFINE_DYNAMIC_TYPE_EXTENDED (GeditFileBrowserSearchPanel,
+				gedit_file_browser_search_panel,
+				GTK_TYPE_BOX,
+				0,
+				G_ADD_PRIVATE_DYNAMIC (GeditFileBrowserSearchPanel))
+
+static void
+cancel_search (GeditFileBrowserSearchPanel *panel)
+{
+	GeditFileBrowserSearchPanelPrivate *priv = panel->priv;
+
+	if (priv->search == NULL)
+		return;
+
+	g_signal_handlers_disconnect_by_data (priv->search, panel);
+	gedit_file_browser_search_cancel (priv->search);
+	g_clear_object (&priv->search);
+}
+
+static void
+set_status (GeditFileBrowserSearchPanel *panel,
+	    const gchar                 *status)
+{
+	gtk_label_set_text (GTK_LABEL (panel->priv->status_label), status);
+}
+
+static gchar *
+get_display_name (GeditFileBrowserSearchPanel *panel,
+		  GFile                       *file)
+{
+	gchar *name;
+
+	name = g_file_get_relative_path (panel->priv->location, file);
+
+	if (name == NULL)
+		name = g_file_get_parse_name (file);
+
+	return name;
+}
+
+static void
+matches_found_cb (GeditFileBrowserSearch      *search,
+		  GFile                       *file,
+		  GPtrArray                   *matches,
+		  GeditFileBrowserSearchPanel *panel)
+{
+	GeditFileBrowserSearchPanelPrivate *priv = panel->priv;
+	GtkTreeIter file_iter;
+	GtkTreePath *path;
+	gchar *name;
+	gchar *escaped;
+	gchar *markup;
+	guint i;
+
+	name = get_display_name (panel, file);
+	escaped = g_markup_escape_text (name, -1);
+	markup = g_strdup_printf ("<b>%s</b> (%u)", escaped, matches->len);
+
+	gtk_tree_store_insert_with_values (priv->results, &file_iter, NULL, -1,
+					   COLUMN_MARKUP, markup,
+					   COLUMN_LOCATION, file,
+					   COLUMN_LINE, -1,
+					   COLUMN_COLUMN, -1,
+					   -1);
+
+	g_free (name);
+	g_free (escaped);
+	g_free (markup);
+
+	for (i = 0; i < matches->len; i++)
+	{
+		GeditFileBrowserSearchMatch *match = g_ptr_array_index (matches, i);
+		GtkTreeIter iter;
+
+		escaped = g_markup_escape_text (match->text, -1);
+		markup = g_strdup_printf ("%d: %s", match->line + 1, escaped);
+
+		gtk_tree_store_insert_with_values (priv->results, &iter, &file_iter, -1,
+						   COLUMN_MARKUP, markup,
+						   COLUMN_LOCATION, file,
+						   COLUMN_LINE, match->line,
+						   COLUMN_COLUMN, match->column,
+						   -1);
+
+		g_free (escaped);
+		g_free (markup);
+	}
+
+	path = gtk_tree_model_get_path (GTK_TREE_MODEL (priv->results), &file_iter);
+	gtk_tree_view_expand_row (GTK_TREE_VIEW (priv->treeview), path, FALSE);
+	gtk_tree_path_free (path);
+
+	priv->n_matches += matches->len;
+	++priv->n_files;
+}
+
+static void
+finished_cb (GeditFileBrowserSearch      *search,
+	     gboolean                     truncated,
+	     GeditFileBrowserSearchPanel *panel)
+{
+	GeditFileBrowserSearchPanelPrivate *priv = panel->priv;
+	gchar *matches;
+	gchar *status;
+
+	if (priv->n_matches == 0)
+	{
+		set_status (panel, _("No matches found"));
+	}
+	else
+	{
+		matches = g_strdup_printf (ngettext ("%d match", "%d matches", priv->n_matches),
+					   priv->n_matches);
+
+		if (truncated)
+		{
+			/* Translators: the first %s is a number of matches, like "10000 matches" */
+			status = g_strdup_printf (ngettext ("Found %s in %d file, the search was stopped",
+							    "Found %s in %d files, the search was stopped",
+							    priv->n_files),
+						  matches,
+						  priv->n_files);
+		}
+		else
+		{
+			/* Translators: the first %s is a number of matches, like "3 matches" */
+			status = g_strdup_printf (ngettext ("Found %s in %d file",
+							    "Found %s in %d files",
+							    priv->n_files),
+						  matches,
+						  priv->n_files);
+		}
+
+		set_status (panel, status);
+
+		g_free (matches);
+		g_free (status);
+	}
+
+	g_clear_object (&priv->search);
+}
+
+static void
+start_search (GeditFileBrowserSearchPanel *panel)
+{
+	GeditFileBrowserSearchPanelPrivate *priv = panel->priv;
+	const gchar *text;
+	GError *error = NULL;
+
+	cancel_search (panel);
+	gtk_tree_store_clear (priv->results);
+	priv->n_matches = 0;
+	priv->n_files = 0;
+
+	text = gtk_entry_get_text (GTK_ENTRY (priv->search_entry));
+
+	if (priv->location == NULL || text[0] == '\0')
+	{
+		set_status (panel, "");
+		return;
+	}
+
+	priv->search = gedit_file_browser_search_new (priv->location,
+						      text,
+						      gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (priv->match_case_checkbutton)),
+						      gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (priv->regex_checkbutton)),
+						      gedit_file_browser_store_get_filter_mode (priv->store),
+						      gedit_file_browser_store_get_binary_patterns (priv->store),
+						      &error);
+
+	if (priv->search == NULL)
+	{
+		set_status (panel, error->message);
+		g_error_free (error);
+		return;
+	}
+
+	g_signal_connect (priv->search,
+			  "matches-found",
+			  G_CALLBACK (matches_found_cb),
+			  panel);
+
+	g_signal_connect (priv->search,
+			  "finished",
+			  G_CALLBACK (finished_cb),
+			  panel);
+
+	set_status (panel, _("Searching…"));
+	gedit_file_browser_search_start (priv->search);
+}
+
+static void
+stop_search_cb (GtkSearchEntry              *entry,
+		GeditFileBrowserSearchPanel *panel)
+{
+	if (panel->priv->search == NULL)
+		return;
+
+	cancel_search (panel);
+	set_status (panel, _("Search stopped"));
+}
+
+static void
+row_activated_cb (GtkTreeView                 *treeview,
+		  GtkTreePath                 *path,
+		  GtkTreeViewColumn           *column,
+		  GeditFileBrowserSearchPanel *panel)
+{
+	GtkTreeModel *model = GTK_TREE_MODEL (panel->priv->results);
+	GtkTreeIter iter;
+	GFile *location;
+	gint line;
+	gint line_column;
+
+	if (!gtk_tree_model_get_iter (model, &iter, path))
+		return;
+
+	gtk_tree_model_get (model, &iter,
+			    COLUMN_LOCATION, &location,
+			    COLUMN_LINE, &line,
+			    COLUMN_COLUMN, &line_column,
+			    -1);
+
+	/* Lines and columns start at 1 when loading a location, 0 means
+	 * the default position.
+	 */
+	gedit_commands_load_location (panel->priv->window,
+				      location,
+				      NULL,
+				      line + 1,
+				      line_column + 1);
+
+	g_object_unref (location);
+}
+
+static void
+gedit_file_browser_search_panel_dispose (GObject *object)
+{
+	GeditFileBrowserSearchPanel *panel = GEDIT_FILE_BROWSER_SEARCH_PANEL (object);
+	GeditFileBrowserSearchPanelPrivate *priv = panel->priv;
+
+	cancel_search (panel);
+
+	g_clear_object (&priv->results);
+	g_clear_object (&priv->store);
+	g_clear_object (&priv->location);
+
+	G_OBJECT_CLASS (gedit_file_browser_search_panel_parent_class)->dispose (object);
+}
+
+static void
+gedit_file_browser_search_panel_class_init (GeditFileBrowserSearchPanelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = gedit_file_browser_search_panel_dispose;
+}
+
+static void
+gedit_file_browser_search_panel_class_finalize (GeditFileBrowserSearchPanelClass *klass)
+{
+}
+
+static void
+gedit_file_browser_search_panel_init (GeditFileBrowserSearchPanel *panel)
+{
+	GeditFileBrowserSearchPanelPrivate *priv;
+	GtkWidget *hbox;
+	GtkWidget *sw;
+	GtkCellRenderer *renderer;
+	GtkTreeViewColumn *column;
+
+	panel->priv = gedit_file_browser_search_panel_get_instance_private (panel);
+	priv = panel->priv;
+
+	gtk_orientable_set_orientation (GTK_ORIENTABLE (panel),
+	                                GTK_ORIENTATION_VERTICAL);
+
+	hbox = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 6);
+	gtk_container_set_border_width (GTK_CONTAINER (hbox), 3);
+	gtk_widget_show (hbox);
+	gtk_box_pack_start (GTK_BOX (panel), hbox, FALSE, FALSE, 0);
+
+	priv->search_entry = gtk_search_entry_new ();
+	gtk_entry_set_placeholder_text (GTK_ENTRY (priv->search_entry), _("Search in files"));
+	gtk_widget_show (priv->search_entry);
+	gtk_box_pack_start (GTK_BOX (hbox), priv->search_entry, TRUE, TRUE, 0);
+
+	g_signal_connect_swapped (priv->search_entry,
+				  "activate",
+				  G_CALLBACK (start_search),
+				  panel);
+
+	g_signal_connect (priv->search_entry,
+			  "stop-search",
+			  G_CALLBACK (stop_search_cb),
+			  panel);
+
+	priv->match_case_checkbutton = gtk_check_button_new_with_mnemonic (_("_Match case"));
+	gtk_widget_show (priv->match_case_checkbutton);
+	gtk_box_pack_start (GTK_BOX (hbox), priv->match_case_checkbutton, FALSE, FALSE, 0);
+
+	priv->regex_checkbutton = gtk_check_button_new_with_mnemonic (_("Re_gular expression"));
+	gtk_widget_show (priv->regex_checkbutton);
+	gtk_box_pack_start (GTK_BOX (hbox), priv->regex_checkbutton, FALSE, FALSE, 0);
+
+	priv->status_label = gtk_label_new (NULL);
+	gtk_label_set_xalign (GTK_LABEL (priv->status_label), 0.0);
+	gtk_label_set_ellipsize (GTK_LABEL (priv->status_label), PANGO_ELLIPSIZE_END);
+	gtk_widget_set_margin_start (priv->status_label, 6);
+	gtk_widget_set_margin_end (priv->status_label, 6);
+	gtk_widget_set_margin_bottom (priv->status_label, 3);
+	gtk_widget_show (priv->status_label);
+	gtk_box_pack_start (GTK_BOX (panel), priv->status_label, FALSE, FALSE, 0);
+
+	sw = gtk_scrolled_window_new (NULL, NULL);
+	gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw),
+	                                GTK_POLICY_AUTOMATIC,
+	                                GTK_POLICY_AUTOMATIC);
+	gtk_widget_show (sw);
+	gtk_box_pack_start (GTK_BOX (panel), sw, TRUE, TRUE, 0);
+
+	priv->results = gtk_tree_store_new (N_COLUMNS,
+					    G_TYPE_STRING,
+					    G_TYPE_FILE,
+					    G_TYPE_INT,
+					    G_TYPE_INT);
+
+	priv->treeview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (priv->results));
+	gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (priv->treeview), FALSE);
+	gtk_tree_view_set_enable_search (GTK_TREE_VIEW (priv->treeview), FALSE);
+
+	renderer = gtk_cell_renderer_text_new ();
+	g_object_set (renderer, "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+	column = gtk_tree_view_column_new_with_attributes (NULL,
+							   renderer,
+							   "markup", COLUMN_MARKUP,
+							   NULL);
+	gtk_tree_view_append_column (GTK_TREE_VIEW (priv->treeview), column);
+
+	g_signal_connect (priv->treeview,
+			  "row-activated",
+			  G_CALLBACK (row_activated_cb),
+			  panel);
+
+	gtk_widget_show (priv->treeview);
+	gtk_container_add (GTK_CONTAINER (sw), priv->treeview);
+}
+
+GtkWidget *
+gedit_file_browser_search_panel_new (GeditWindow           *window,
+				     GeditFileBrowserStore *store)
+{
+	GeditFileBrowserSearchPanel *panel;
+
+	g_return_val_if_fail (GEDIT_IS_WINDOW (window), NULL);
+	g_return_val_if_fail (GEDIT_IS_FILE_BROWSER_STORE (store), NULL);
+
+	panel = g_object_new (GEDIT_TYPE_FILE_BROWSER_SEARCH_PANEL, NULL);
+
+	/* The panel is in the window, it does not outlive it */
+	panel->priv->window = window;
+	panel->priv->store = g_object_ref (store);
+
+	return GTK_WIDGET (panel);
+}
+
+/**
+ * gedit_file_browser_search_panel_set_location:
+ * @panel: a #GeditFileBrowserSearchPanel.
+ * @location: the directory to search in.
+ *
+ * Sets the directory of the next searches, and gives the focus to the
+ * search entry.
+ */
+void
+gedit_file_browser_search_panel_set_location (GeditFileBrowserSearchPanel *panel,
+					      GFile                       *location)
+{
+	GeditFileBrowserSearchPanelPrivate *priv;
+	gchar *name;
+	gchar *status;
+
+	g_return_if_fail (GEDIT_IS_FILE_BROWSER_SEARCH_PANEL (panel));
+	g_return_if_fail (G_IS_FILE (location));
+
+	priv = panel->priv;
+
+	if (priv->location == NULL || !g_file_equal (priv->location, location))
+	{
+		cancel_search (panel);
+		gtk_tree_store_clear (priv->results);
+
+		g_set_object (&priv->location, location);
+
+		name = g_file_get_parse_name (location);
+		/* Translators: %s is a directory */
+		status = g_strdup_printf (_("Search in %s"), name);
+		set_status (panel, status);
+
+		g_free (name);
+		g_free (status);
+	}
+
+	gtk_widget_grab_focus (priv->search_entry);
+}
+
+void
+_gedit_file_browser_search_panel_register_type (GTypeModule *type_module)
+{
+	gedit_file_browser_search_panel_register_type (type_module);
+}
+
+/* ex:set ts=8 noet: */
@@ -0,0 +1,880 @@
+/*
+ * gedit-file-browser-search.c - Search the files below a directory
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "gedit-file-browser-search.h"
+
+#include <string.h>
+#include <gedit/gedit-debug.h>
+#include <gedit/gedit-utils.h>
+
+#define ENUMERATE_ATTRIBUTES G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+			     G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+			     G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
+			     G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP "," \
+			     G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK "," \
+			     G_FILE_ATTRIBUTE_STANDARD_SIZE
+
+/* Bigger files are not searched */
+#define MAX_FILE_SIZE (64 * 1024 * 1024)
+
+/* Like grep, a file with a nul byte in its first bytes is binary */
+#define BINARY_CHECK_SIZE 8192
+
+/* The files are read by blocks, to stop quickly when cancelled */
+#define READ_BLOCK_SIZE (64 * 1024)
+
+/* Length in bytes of the text shown for a line, and of the text shown
+ * before the match when the line has to be cut.
+ */
+#define MAX_LINE_LENGTH 256
+#define MAX_CONTEXT_LENGTH 64
+
+#define MAX_MATCHES_PER_FILE 1000
+#define MAX_MATCHES 10000
+
+typedef struct
+{
+	GFile    *file;
+	gboolean  is_directory;
+} Job;
+
+typedef struct
+{
+	GeditFileBrowserSearch *search;
+
+	/* NULL for the notification of the end of the search */
+	GFile                  *file;
+	GPtrArray              *matches;
+} Result;
+
+struct _GeditFileBrowserSearchPrivate
+{
+	GFile        *root;
+
+	/* Set for a search of plain text which can be done without a
+	 * regex: either case sensitive or only made of ASCII characters.
+	 */
+	gchar        *literal;
+	gsize         literal_length;
+	gboolean      case_sensitive;
+
+	/* For the files in valid UTF-8 and for the other ones */
+	GRegex       *regex;
+	GRegex       *raw_regex;
+
+	gboolean      hide_hidden;
+
+	/* GPatternSpec of the binary patterns, NULL if binary files are
+	 * not filtered.
+	 */
+	GPtrArray    *binary_patterns;
+
+	GThreadPool  *pool;
+	GCancellable *cancellable;
+	GMainContext *context;
+	GTimer       *timer;
+
+	/* Modified by the worker threads */
+	gint          n_pending_jobs;
+	gint          n_matches;
+
+	guint         disposed : 1;
+};
+
+enum
+{
+	MATCHES_FOUND,
+	FINISHED,
+	LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL];
+
+G_DEFINE_DYNAMIC_TYPE_EXTENDED (GeditFileBrowserSearch,
+				gedit_file_browser_search,
+				G_TYPE_OBJECT,
+				0,
+				G_ADD_PRIVATE_DYNAMIC (GeditFileBrowserSearch))
+
+static void
+gedit_file_browser_search_dispose (GObject *object)
+{
+	GeditFileBrowserSearchPrivate *priv = GEDIT_FILE_BROWSER_SEARCH (object)->priv;
+
+	priv->disposed = TRUE;
+
+	/* The pool keeps a reference on the search while it has jobs,
+	 * so the workers are only returning, no need to wait for them.
+	 */
+	if (priv->pool != NULL)
+	{
+		g_cancellable_cancel (priv->cancellable);
+		g_thread_pool_free (priv->pool, FALSE, FALSE);
+		priv->pool = NULL;
+	}
+
+	g_clear_object (&priv->root);
+
+	G_OBJECT_CLASS (gedit_file_browser_search_parent_class)->dispose (object);
+}
+
+static void
+gedit_file_browser_search_finalize (GObject *object)
+{
+	GeditFileBrowserSearchPrivate *priv = GEDIT_FILE_BROWSER_SEARCH (object)->priv;
+
+	g_free (priv->literal);
+
+	if (priv->regex != NULL)
+		g_regex_unref (priv->regex);
+
+	if (priv->raw_regex != NULL)
+		g_regex_unref (priv->raw_regex);
+
+	if (priv->binary_patterns != NULL)
+		g_ptr_array_unref (priv->binary_patterns);
+
+	if (priv->context != NULL)
+		g_main_context_unref (priv->context);
+
+	if (priv->timer != NULL)
+		g_timer_destroy (priv->timer);
+
+	g_object_unref (priv->cancellable);
+
+	G_OBJECT_CLASS (gedit_file_browser_search_parent_class)->finalize (object);
+}
+
+static void
+gedit_file_browser_search_class_init (GeditFileBrowserSearchClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->dispose = gedit_file_browser_search_dispose;
+	object_class->finalize = gedit_file_browser_search_finalize;
+
+	/* The matches are a GPtrArray of GeditFileBrowserSearchMatch */
+	signals[MATCHES_FOUND] =
+	    g_signal_new ("matches-found",
+	                  G_OBJECT_CLASS_TYPE (object_class),
+	                  G_SIGNAL_RUN_LAST,
+	                  G_STRUCT_OFFSET (GeditFileBrowserSearchClass, matches_found),
+	                  NULL, NULL, NULL,
+	                  G_TYPE_NONE, 2, G_TYPE_FILE, G_TYPE_POINTER);
+
+	signals[FINISHED] =
+	    g_signal_new ("finished",
+	                  G_OBJECT_CLASS_TYPE (object_class),
+	                  G_SIGNAL_RUN_LAST,
+	                  G_STRUCT_OFFSET (GeditFileBrowserSearchClass, finished),
+	                  NULL, NULL, NULL,
+	                  G_TYPE_NONE, 1, G_TYPE_BOOLEAN);
+}
+
+static void
+gedit_file_browser_search_class_finalize (GeditFileBrowserSearchClass *klass)
+{
+}
+
+static void
+gedit_file_browser_search_init (GeditFileBrowserSearch *search)
+{
+	search->priv = gedit_file_browser_search_get_instance_private (search);
+
+	search->priv->cancellable = g_cancellable_new ();
+}
+
+static void
+match_free (gpointer data)
+{
+	GeditFileBrowserSearchMatch *match = data;
+
+	g_free (match->text);
+	g_slice_free (GeditFileBrowserSearchMatch, match);
+}
+
+static void
+result_free (gpointer data)
+{
+	Result *result = data;
+
+	g_object_unref (result->search);
+
+	if (result->file != NULL)
+		g_object_unref (result->file);
+
+	if (result->matches != NULL)
+		g_ptr_array_unref (result->matches);
+
+	g_slice_free (Result, result);
+}
+
+static gboolean
+result_cb (gpointer data)
+{
+	Result *result = data;
+	GeditFileBrowserSearchPrivate *priv = result->search->priv;
+
+	if (priv->disposed || g_cancellable_is_cancelled (priv->cancellable))
+		return G_SOURCE_REMOVE;
+
+	if (result->file != NULL)
+	{
+		g_signal_emit (result->search,
+			       signals[MATCHES_FOUND],
+			       0,
+			       result->file,
+			       result->matches);
+	}
+	else
+	{
+		gint n_matches = g_atomic_int_get (&priv->n_matches);
+
+		gedit_debug_message (DEBUG_PLUGINS,
+				     "%d matches found in %f s",
+				     n_matches,
+				     g_timer_elapsed (priv->timer, NULL));
+
+		g_signal_emit (result->search,
+			       signals[FINISHED],
+			       0,
+			       n_matches >= MAX_MATCHES);
+	}
+
+	return G_SOURCE_REMOVE;
+}
+
+/* Called from the worker threads, takes ownership of file and matches */
+static void
+send_result (GeditFileBrowserSearch *search,
+	     GFile                  *file,
+	     GPtrArray              *matches)
+{
+	Result *result;
+	GSource *source;
+
+	result = g_slice_new (Result);
+	result->search = g_object_ref (search);
+	result->file = file;
+	result->matches = matches;
+
+	/* Not g_main_context_invoke(): it could run the callback in the
+	 * worker thread when the main loop is idle.
+	 */
+	source = g_idle_source_new ();
+	g_source_set_priority (source, G_PRIORITY_DEFAULT_IDLE);
+	g_source_set_callback (source, result_cb, result, result_free);
+	g_source_attach (source, search->priv->context);
+	g_source_unref (source);
+}
+
+static gboolean
+should_stop (GeditFileBrowserSearch *search)
+{
+	return g_cancellable_is_cancelled (search->priv->cancellable) ||
+	       g_atomic_int_get (&search->priv->n_matches) >= MAX_MATCHES;
+}
+
+static void
+push_job (GeditFileBrowserSearch *search,
+	  GFile                  *file,
+	  gboolean                is_directory)
+{
+	Job *job;
+
+	job = g_slice_new (Job);
+	job->file = file;
+	job->is_directory = is_directory;
+
+	g_atomic_int_inc (&search->priv->n_pending_jobs);
+	g_thread_pool_push (search->priv->pool, job, NULL);
+}
+
+static gboolean
+name_matches_binary_patterns (GeditFileBrowserSearch *search,
+			      const gchar            *name)
+{
+	GPtrArray *patterns = search->priv->binary_patterns;
+	guint i;
+
+	if (patterns == NULL)
+		return FALSE;
+
+	for (i = 0; i < patterns->len; i++)
+	{
+		if (g_pattern_match_string (g_ptr_array_index (patterns, i), name))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Same filters as the store, so that the search sees the files shown in
+ * the file browser.
+ */
+static gboolean
+is_filtered (GeditFileBrowserSearch *search,
+	     GFileInfo              *info)
+{
+	GFileType type = g_file_info_get_file_type (info);
+
+	if (type != G_FILE_TYPE_REGULAR && type != G_FILE_TYPE_DIRECTORY)
+		return TRUE;
+
+	if (search->priv->hide_hidden &&
+	    (g_file_info_get_is_hidden (info) || g_file_info_get_is_backup (info)))
+	{
+		return TRUE;
+	}
+
+	/* Links to directories are not followed, they could make a loop */
+	if (type == G_FILE_TYPE_DIRECTORY)
+		return g_file_info_get_is_symlink (info);
+
+	if (g_file_info_get_size (info) > MAX_FILE_SIZE)
+		return TRUE;
+
+	return name_matches_binary_patterns (search, g_file_info_get_name (info));
+}
+
+static void
+search_directory (GeditFileBrowserSearch *search,
+		  GFile                  *directory)
+{
+	GFileEnumerator *enumerator;
+
+	enumerator = g_file_enumerate_children (directory,
+						ENUMERATE_ATTRIBUTES,
+						G_FILE_QUERY_INFO_NONE,
+						search->priv->cancellable,
+						NULL);
+
+	if (enumerator == NULL)
+		return;
+
+	while (!should_stop (search))
+	{
+		GFileInfo *info;
+
+		info = g_file_enumerator_next_file (enumerator,
+						    search->priv->cancellable,
+						    NULL);
+
+		if (info == NULL)
+			break;
+
+		if (!is_filtered (search, info))
+		{
+			push_job (search,
+				  g_file_enumerator_get_child (enumerator, info),
+				  g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY);
+		}
+
+		g_object_unref (info);
+	}
+
+	g_object_unref (enumerator);
+}
+
+/* Moves line_start to the start of the line of position, returns the
+ * number of lines skipped.
+ */
+static gint
+skip_lines (const gchar **line_start,
+	    const gchar  *position)
+{
+	const gchar *p = *line_start;
+	gint n_lines = 0;
+
+	while ((p = memchr (p, '\n', position - p)) != NULL)
+	{
+		++n_lines;
+		*line_start = ++p;
+	}
+
+	return n_lines;
+}
+
+static void
+add_match (GPtrArray   *matches,
+	   const gchar *line_start,
+	   const gchar *match_start,
+	   const gchar *end,
+	   gint         line)
+{
+	GeditFileBrowserSearchMatch *match;
+	const gchar *line_end;
+	const gchar *text_start;
+	gchar *text;
+
+	line_end = memchr (match_start, '\n', end - match_start);
+
+	if (line_end == NULL)
+		line_end = end;
+
+	if (line_end > line_start && line_end[-1] == '\r')
+		--line_end;
+
+	/* Keep the match visible in a long line */
+	text_start = line_start;
+
+	if (match_start - line_start > MAX_LINE_LENGTH - MAX_CONTEXT_LENGTH)
+	{
+		text_start = match_start - MAX_CONTEXT_LENGTH;
+
+		while (text_start < match_start && (*text_start & 0xc0) == 0x80)
+			++text_start;
+	}
+
+	text = g_strndup (text_start, MIN (line_end - text_start, MAX_LINE_LENGTH));
+
+	match = g_slice_new (GeditFileBrowserSearchMatch);
+	match->line = line;
+	match->column = g_utf8_strlen (line_start, match_start - line_start);
+	match->text = gedit_utils_make_valid_utf8 (text);
+
+	g_free (text);
+
+	g_ptr_array_add (matches, match);
+}
+
+static const gchar *
+find_first_byte (const gchar *p,
+		 gsize        length,
+		 gchar        lower,
+		 gchar        upper)
+{
+	const gchar *found;
+
+	found = memchr (p, lower, length);
+
+	if (upper != lower)
+	{
+		const gchar *other;
+
+		other = memchr (p, upper, found != NULL ? (gsize) (found - p) : length);
+
+		if (other != NULL)
+			found = other;
+	}
+
+	return found;
+}
+
+/* memchr() is vectorized by the C library, so looking for the first byte
+ * of the text with it skips quickly the parts of the file which cannot
+ * match.
+ */
+static const gchar *
+find_literal (GeditFileBrowserSearchPrivate *priv,
+	      const gchar                   *p,
+	      const gchar                   *end)
+{
+	const gchar *literal = priv->literal;
+	gsize length = priv->literal_length;
+	gchar lower = literal[0];
+	gchar upper = literal[0];
+
+	if (!priv->case_sensitive)
+	{
+		lower = g_ascii_tolower (literal[0]);
+		upper = g_ascii_toupper (literal[0]);
+	}
+
+	while ((gsize) (end - p) >= length)
+	{
+		const gchar *found;
+		gboolean equal;
+
+		found = find_first_byte (p, end - p - length + 1, lower, upper);
+
+		if (found == NULL)
+			return NULL;
+
+		if (priv->case_sensitive)
+			equal = memcmp (found + 1, literal + 1, length - 1) == 0;
+		else
+			equal = g_ascii_strncasecmp (found + 1, literal + 1, length - 1) == 0;
+
+		if (equal)
+			return found;
+
+		p = found + 1;
+	}
+
+	return NULL;
+}
+
+static void
+search_literal (GeditFileBrowserSearch *search,
+		const gchar            *text,
+		gsize                   length,
+		GPtrArray              *matches)
+{
+	const gchar *end = text + length;
+	const gchar *line_start = text;
+	const gchar *p = text;
+	gint line = 0;
+
+	while (matches->len < MAX_MATCHES_PER_FILE &&
+	       !g_cancellable_is_cancelled (search->priv->cancellable))
+	{
+		const gchar *found;
+
+		found = find_literal (search->priv, p, end);
+
+		if (found == NULL)
+			break;
+
+		line += skip_lines (&line_start, found);
+		add_match (matches, line_start, found, end, line);
+
+		/* One match per line is enough, go on with the next one */
+		p = memchr (found, '\n', end - found);
+
+		if (p == NULL)
+			break;
+
+		++p;
+	}
+}
+
+static void
+search_regex (GeditFileBrowserSearch *search,
+	      const gchar            *text,
+	      gsize                   length,
+	      GPtrArray              *matches)
+{
+	GeditFileBrowserSearchPrivate *priv = search->priv;
+	GRegex *regex;
+	GMatchInfo *match_info;
+	const gchar *line_start = text;
+	gint line = 0;
+	gint last_line = -1;
+
+	/* A GRegex without G_REGEX_RAW must not be given invalid UTF-8 */
+	regex = g_utf8_validate (text, length, NULL) ? priv->regex : priv->raw_regex;
+
+	g_regex_match_full (regex, text, length, 0, 0, &match_info, NULL);
+
+	while (g_match_info_matches (match_info) &&
+	       matches->len < MAX_MATCHES_PER_FILE &&
+	       !g_cancellable_is_cancelled (priv->cancellable))
+	{
+		gint start_pos;
+		gint end_pos;
+
+		if (g_match_info_fetch_pos (match_info, 0, &start_pos, &end_pos) &&
+		    end_pos > start_pos)
+		{
+			line += skip_lines (&line_start, text + start_pos);
+
+			if (line != last_line)
+			{
+				add_match (matches, line_start, text + start_pos, text + length, line);
+				last_line = line;
+			}
+		}
+
+		g_match_info_next (match_info, NULL);
+	}
+
+	g_match_info_free (match_info);
+}
+
+/* Returns NULL if the file cannot be read, is binary or too big, or if
+ * the search was stopped while reading it.
+ */
+static GByteArray *
+read_file (GeditFileBrowserSearch *search,
+	   GFile                  *file)
+{
+	GFileInputStream *stream;
+	GByteArray *contents;
+	gboolean complete = FALSE;
+
+	stream = g_file_read (file, search->priv->cancellable, NULL);
+
+	if (stream == NULL)
+		return NULL;
+
+	contents = g_byte_array_new ();
+
+	/* The file can have grown since its size was checked */
+	while (!should_stop (search) && contents->len <= MAX_FILE_SIZE)
+	{
+		guint length = contents->len;
+		gssize n_read;
+
+		g_byte_array_set_size (contents, length + READ_BLOCK_SIZE);
+
+		n_read = g_input_stream_read (G_INPUT_STREAM (stream),
+					      contents->data + length,
+					      READ_BLOCK_SIZE,
+					      search->priv->cancellable,
+					      NULL);
+
+		if (n_read < 0)
+			break;
+
+		g_byte_array_set_size (contents, length + n_read);
+
+		if (n_read == 0)
+		{
+			complete = TRUE;
+			break;
+		}
+
+		if (length < BINARY_CHECK_SIZE &&
+		    memchr (contents->data + length, '\0', MIN ((gsize) n_read, BINARY_CHECK_SIZE - length)) != NULL)
+		{
+			break;
+		}
+	}
+
+	g_object_unref (stream);
+
+	if (!complete)
+	{
+		g_byte_array_unref (contents);
+		return NULL;
+	}
+
+	return contents;
+}
+
+static void
+search_file (GeditFileBrowserSearch *search,
+	     GFile                  *file)
+{
+	GeditFileBrowserSearchPrivate *priv = search->priv;
+	GByteArray *contents;
+
+	contents = read_file (search, file);
+
+	if (contents == NULL)
+		return;
+
+	if (contents->len > 0)
+	{
+		const gchar *text = (const gchar *) contents->data;
+		GPtrArray *matches;
+
+		matches = g_ptr_array_new_with_free_func (match_free);
+
+		if (priv->literal != NULL)
+			search_literal (search, text, contents->len, matches);
+		else
+			search_regex (search, text, contents->len, matches);
+
+		if (matches->len > 0)
+		{
+			g_atomic_int_add (&priv->n_matches, matches->len);
+			send_result (search, g_object_ref (file), matches);
+		}
+		else
+		{
+			g_ptr_array_unref (matches);
+		}
+	}
+
+	g_byte_array_unref (contents);
+}
+
+static void
+run_job (gpointer data,
+	 gpointer user_data)
+{
+	GeditFileBrowserSearch *search = user_data;
+	Job *job = data;
+
+	if (!should_stop (search))
+	{
+		if (job->is_directory)
+			search_directory (search, job->file);
+		else
+			search_file (search, job->file);
+	}
+
+	g_object_unref (job->file);
+	g_slice_free (Job, job);
+
+	/* The jobs of the subdirectories and files were pushed before,
+	 * so the last job to end is the end of the search. The result
+	 * holds a reference, the search is not finalized in the worker.
+	 */
+	if (g_atomic_int_dec_and_test (&search->priv->n_pending_jobs))
+	{
+		send_result (search, NULL, NULL);
+		g_object_unref (search);
+	}
+}
+
+static gboolean
+is_ascii (const gchar *text)
+{
+	for (; *text != '\0'; text++)
+	{
+		if ((guchar) *text >= 0x80)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gedit_file_browser_search_new:
+ * @root: the directory to search in.
+ * @text: the text to search.
+ * @case_sensitive: whether the search is case sensitive.
+ * @regex_enabled: whether @text is a regular expression.
+ * @filter_mode: the filter mode of the file browser.
+ * @binary_patterns: (nullable): the binary patterns of the file browser.
+ * @error: location of a #GError, or %NULL.
+ *
+ * Creates a search of the text files below @root, skipping the files
+ * which the file browser hides with @filter_mode. Call
+ * gedit_file_browser_search_start() to start it.
+ *
+ * Returns: the new search, or %NULL if @text is not a valid regular
+ * expression.
+ */
+GeditFileBrowserSearch *
+gedit_file_browser_search_new (GFile                            *root,
+			       const gchar                      *text,
+			       gboolean                          case_sensitive,
+			       gboolean                          regex_enabled,
+			       GeditFileBrowserStoreFilterMode   filter_mode,
+			       const gchar * const              *binary_patterns,
+			       GError                          **error)
+{
+	GeditFileBrowserSearch *search;
+	GeditFileBrowserSearchPrivate *priv;
+
+	g_return_val_if_fail (G_IS_FILE (root), NULL);
+	g_return_val_if_fail (text != NULL && text[0] != '\0', NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	search = g_object_new (GEDIT_TYPE_FILE_BROWSER_SEARCH, NULL);
+	priv = search->priv;
+
+	priv->root = g_object_ref (root);
+	priv->case_sensitive = case_sensitive;
+	priv->hide_hidden = (filter_mode & GEDIT_FILE_BROWSER_STORE_FILTER_MODE_HIDE_HIDDEN) != 0;
+
+	if (!regex_enabled && (case_sensitive || is_ascii (text)))
+	{
+		priv->literal = g_strdup (text);
+		priv->literal_length = strlen (text);
+	}
+	else
+	{
+		GRegexCompileFlags flags = G_REGEX_MULTILINE | G_REGEX_OPTIMIZE;
+		gchar *pattern;
+
+		if (!case_sensitive)
+			flags |= G_REGEX_CASELESS;
+
+		pattern = regex_enabled ? g_strdup (text) : g_regex_escape_string (text, -1);
+
+		priv->regex = g_regex_new (pattern, flags, 0, error);
+
+		if (priv->regex != NULL)
+			priv->raw_regex = g_regex_new (pattern, flags | G_REGEX_RAW, 0, NULL);
+
+		g_free (pattern);
+
+		if (priv->regex == NULL || priv->raw_regex == NULL)
+		{
+			g_object_unref (search);
+			return NULL;
+		}
+	}
+
+	if ((filter_mode & GEDIT_FILE_BROWSER_STORE_FILTER_MODE_HIDE_BINARY) != 0 &&
+	    binary_patterns != NULL)
+	{
+		priv->binary_patterns = g_ptr_array_new_with_free_func ((GDestroyNotify) g_pattern_spec_free);
+
+		for (; *binary_patterns != NULL; binary_patterns++)
+			g_ptr_array_add (priv->binary_patterns, g_pattern_spec_new (*binary_patterns));
+	}
+
+	return search;
+}
+
+/**
+ * gedit_file_browser_search_start:
+ * @search: a #GeditFileBrowserSearch.
+ *
+ * Starts the search on a pool of worker threads. The matches of each file
+ * are sent with the #GeditFileBrowserSearch::matches-found signal in the
+ * thread default main context of the caller, then
+ * #GeditFileBrowserSearch::finished is emitted.
+ */
+void
+gedit_file_browser_search_start (GeditFileBrowserSearch *search)
+{
+	GeditFileBrowserSearchPrivate *priv;
+
+	g_return_if_fail (GEDIT_IS_FILE_BROWSER_SEARCH (search));
+	g_return_if_fail (search->priv->pool == NULL);
+
+	priv = search->priv;
+
+	priv->context = g_main_context_ref_thread_default ();
+	priv->timer = g_timer_new ();
+
+	/* Released by the last job */
+	priv->pool = g_thread_pool_new (run_job,
+					g_object_ref (search),
+					g_get_num_processors (),
+					FALSE,
+					NULL);
+
+	push_job (search, g_object_ref (priv->root), TRUE);
+}
+
+/**
+ * gedit_file_browser_search_cancel:
+ * @search: a #GeditFileBrowserSearch.
+ *
+ * Stops the search, no signal is emitted anymore. A started search is
+ * kept alive until its workers stop, so it must be cancelled before it
+ * is released.
+ */
+void
+gedit_file_browser_search_cancel (GeditFileBrowserSearch *search)
+{
+	g_return_if_fail (GEDIT_IS_FILE_BROWSER_SEARCH (search));
+
+	g_cancellable_cancel (search->priv->cancellable);
+}
+
+void
+_gedit_file_browser_search_register_type (GTypeModule *type_module)
+{
+	gedit_file_browser_search_register_type (type_module);
+}
+
+/* ex:set ts=8 noet: */
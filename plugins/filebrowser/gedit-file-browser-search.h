@@ -0,0 +1,90 @@
+/*
+ * gedit-file-browser-search.h - Search the files below a directory
+ *
+ * Copyright (C) 2026 - The gedit Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GEDIT_FILE_BROWSER_SEARCH_H
+#define GEDIT_FILE_BROWSER_SEARCH_H
+
+#include <gio/gio.h>
+#include "gedit-file-browser-store.h"
+
+G_BEGIN_DECLS
+
+#define GEDIT_TYPE_FILE_BROWSER_SEARCH			(gedit_file_browser_search_get_type ())
+#define GEDIT_FILE_BROWSER_SEARCH(obj)			(G_TYPE_CHECK_INSTANCE_CAST ((obj), GEDIT_TYPE_FILE_BROWSER_SEARCH, GeditFileBrowserSearch))
+#define GEDIT_FILE_BROWSER_SEARCH_CLASS(klass)		(G_TYPE_CHECK_CLASS_CAST ((klass), GEDIT_TYPE_FILE_BROWSER_SEARCH, GeditFileBrowserSearchClass))
+#define GEDIT_IS_FILE_BROWSER_SEARCH(obj)		(G_TYPE_CHECK_INSTANCE_TYPE ((obj), GEDIT_TYPE_FILE_BROWSER_SEARCH))
+#define GEDIT_IS_FILE_BROWSER_SEARCH_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE ((klass), GEDIT_TYPE_FILE_BROWSER_SEARCH))
+#define GEDIT_FILE_BROWSER_SEARCH_GET_CLASS(obj)	(G_TYPE_INSTANCE_GET_CLASS ((obj), GEDIT_TYPE_FILE_BROWSER_SEARCH, GeditFileBrowserSearchClass))
+
+typedef struct _GeditFileBrowserSearch		GeditFileBrowserSearch;
+typedef struct _GeditFileBrowserSearchClass	GeditFileBrowserSearchClass;
+typedef struct _GeditFileBrowserSearchPrivate	GeditFileBrowserSearchPrivate;
+typedef struct _GeditFileBrowserSearchMatch	GeditFileBrowserSearchMatch;
+
+struct _GeditFileBrowserSearchMatch
+{
+	/* Both starting at 0, the column in characters */
+	gint   line;
+	gint   column;
+
+	/* The text of the line, valid UTF-8 */
+	gchar *text;
+};
+
+struct _GeditFileBrowserSearch
+{
+	GObject parent;
+
+	/*< private >*/
+	GeditFileBrowserSearchPrivate *priv;
+};
+
+struct _GeditFileBrowserSearchClass
+{
+	GObjectClass parent_class;
+
+	/* Signals */
+	void (* matches_found)	(GeditFileBrowserSearch *search,
+				 GFile                  *file,
+				 GPtrArray              *matches);
+	void (* finished)	(GeditFileBrowserSearch *search,
+				 gboolean                truncated);
+};
+
+GType			 gedit_file_browser_search_get_type		(void) G_GNUC_CONST;
+
+GeditFileBrowserSearch	*gedit_file_browser_search_new			(GFile                            *root,
+									 const gchar                      *text,
+									 gboolean                          case_sensitive,
+									 gboolean                          regex_enabled,
+									 GeditFileBrowserStoreFilterMode   filter_mode,
+									 const gchar * const              *binary_patterns,
+									 GError                          **error);
+
+void			 gedit_file_browser_search_start		(GeditFileBrowserSearch           *search);
+
+void			 gedit_file_browser_search_cancel		(GeditFileBrowserSearch           *search);
+
+void			 _gedit_file_browser_search_register_type	(GTypeModule                      *type_module);
+
+G_END_DECLS
+
+#endif /* GEDIT_FILE_BROWSER_SEARCH_H */
+
+/* ex:set ts=8 noet: */
@@ -41,18 +41,32 @@
 
 #define FILE_BROWSER_NODE_DIR(node)	((FileBrowserNodeDir *)(node))
 
+/* Directories are loaded in a thread, handing over batches of entries
+   starting with this size and doubling up to the maximum, so that the
+   first entries show up quickly while merging stays cheap */
 #define DIRECTORY_LOAD_ITEMS_PER_CALLBACK 100
+#define DIRECTORY_LOAD_MAX_ITEMS_PER_CALLBACK 6400
+
+/* Monitor events are collected for this many milliseconds before being
+   applied, and then applied in chunks taking at most this many
+   microseconds each so that the UI keeps being redrawn */
+#define MONITOR_EVENTS_DELAY 100
+#define MONITOR_EVENTS_BUDGET 8000
 #define STANDARD_ATTRIBUTE_TYPES G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
 				 G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
 			 	 G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP "," \
 				 G_FILE_ATTRIBUTE_STANDARD_NAME "," \
 				 G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE "," \
 				 G_FILE_ATTRIBUTE_STANDARD_ICON
+#define LOAD_ATTRIBUTE_TYPES STANDARD_ATTRIBUTE_TYPES "," \
+			     G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME
 
 typedef struct _FileBrowserNode    FileBrowserNode;
 typedef struct _FileBrowserNodeDir FileBrowserNodeDir;
 typedef struct _AsyncData	   AsyncData;
-typedef struct _AsyncNode	   AsyncNode;
+typedef struct _LoadJob	   LoadJob;
+typedef struct _LoadEntry	   LoadEntry;
+typedef struct _LoadBatch	   LoadBatch;
 
 typedef gint (*SortFunc) (FileBrowserNode *node1,
 			  FileBrowserNode *node2);
@@ -67,11 +81,32 @@ struct _AsyncData
 	gboolean               removed;
 };
 
-struct _AsyncNode
+/* The fields of a job are not modified once the loading thread runs,
+   except for dir which is only accessed from the main thread */
+struct _LoadJob
 {
 	FileBrowserNodeDir *dir;
-	GCancellable       *cancellable;
-	GSList             *original_children;
+	GFile              *file;
+	GPtrArray          *binary_pattern_specs;
+	guint               binary_patterns_generation;
+	GMainContext       *context;
+};
+
+/* A file found while loading a directory, classified by the thread */
+struct _LoadEntry
+{
+	GFile              *file;
+	GFileInfo          *info;
+	gchar              *name;
+	gchar              *collate_key;
+	guint               flags;
+	gboolean            matches_binary_pattern;
+};
+
+struct _LoadBatch
+{
+	GTask              *task;
+	GPtrArray          *entries;
 };
 
 typedef struct {
@@ -95,16 +130,42 @@ struct _FileBrowserNode
 	FileBrowserNode *parent;
 	gint             pos;
 	gboolean         inserted;
+
+	/* Position in the children of the parent */
+	guint            index;
+
+	/* Whether the node is counted in the visible tree of the parent */
+	gboolean         counted;
+
+	/* Collation key of the name, computed when first sorting */
+	gchar           *collate_key;
+
+	/* Whether the name matches a binary pattern, valid as long as
+	   binary_patterns_generation matches the one of the model */
+	gboolean         matches_binary_pattern;
+	guint            binary_patterns_generation;
 };
 
 struct _FileBrowserNodeDir
 {
 	FileBrowserNode        node;
-	GSList                *children;
+	GPtrArray             *children;
+
+	/* Fenwick tree counting the children inserted in the model, to map
+	   between child positions and tree path indices in O(log n). It is
+	   rebuilt lazily when NULL or older than the model generation. */
+	guint                 *visible_tree;
+	guint                  visible_tree_size;
+	guint                  visible_generation;
 
 	GCancellable          *cancellable;
 	GFileMonitor          *monitor;
 	GeditFileBrowserStore *model;
+
+	/* Monitor events waiting to be applied, mapping a location to the
+	   last event received for it */
+	GHashTable            *pending_events;
+	guint                  pending_events_id;
 };
 
 struct _GeditFileBrowserStorePrivate
@@ -119,9 +180,20 @@ struct _GeditFileBrowserStorePrivate
 
 	gchar                           **binary_patterns;
 	GPtrArray                        *binary_pattern_specs;
+	guint                             binary_patterns_generation;
 
 	SortFunc                          sort_func;
 
+	/* Bumped to invalidate the visible trees of all the directories */
+	guint                             visible_generation;
+
+	/* Maps the location of every node to the node itself */
+	GHashTable                       *file_index;
+
+	/* Monitor events received, and those merged with a pending one */
+	guint                             monitor_events_received;
+	guint                             monitor_events_merged;
+
 	GSList                           *async_handles;
 	MountInfo                        *mount_info;
 };
@@ -136,6 +208,7 @@ static void model_remove_node                               (GeditFileBrowserSto
 
 static void set_virtual_root_from_node                      (GeditFileBrowserStore  *model,
 				                             FileBrowserNode        *node);
+static void dir_clear_pending_events                        (FileBrowserNodeDir     *dir);
 
 static void gedit_file_browser_store_iface_init             (GtkTreeModelIface      *iface);
 static GtkTreeModelFlags gedit_file_browser_store_get_flags (GtkTreeModel           *tree_model);
@@ -191,8 +264,6 @@ static gint model_sort_default                              (FileBrowserNode
 							     FileBrowserNode        *node2);
 static void model_check_dummy                               (GeditFileBrowserStore  *model,
 							     FileBrowserNode        *node);
-static void next_files_async 				    (GFileEnumerator        *enumerator,
-							     AsyncNode              *async);
 
 static void delete_files                                    (AsyncData              *data);
 
@@ -250,6 +321,7 @@ gedit_file_browser_store_finalize (GObject *object)
 
 	/* Free all the nodes */
 	file_browser_node_free (obj, obj->priv->root);
+	g_hash_table_destroy (obj->priv->file_index);
 
 	if (obj->priv->binary_patterns != NULL)
 	{
@@ -484,6 +556,10 @@ gedit_file_browser_store_init (GeditFileBrowserStore *obj)
 	/* Default filter mode is hiding the hidden files */
 	obj->priv->filter_mode = gedit_file_browser_store_filter_mode_get_default ();
 	obj->priv->sort_func = model_sort_default;
+	obj->priv->binary_patterns_generation = 1;
+
+	obj->priv->file_index = g_hash_table_new ((GHashFunc)g_file_hash,
+						  (GEqualFunc)g_file_equal);
 }
 
 static gboolean
@@ -533,6 +609,181 @@ model_node_inserted (GeditFileBrowserStore *model,
 	       (model_node_visibility (model, node) && node->inserted);
 }
 
+static void
+model_invalidate_visible_trees (GeditFileBrowserStore *model)
+{
+	++model->priv->visible_generation;
+}
+
+static void
+dir_invalidate_visible_tree (FileBrowserNodeDir *dir)
+{
+	g_free (dir->visible_tree);
+	dir->visible_tree = NULL;
+}
+
+static gboolean
+dir_visible_tree_is_valid (GeditFileBrowserStore *model,
+			   FileBrowserNodeDir    *dir)
+{
+	return dir->visible_tree != NULL &&
+	       dir->visible_generation == model->priv->visible_generation;
+}
+
+static void
+dir_ensure_visible_tree (GeditFileBrowserStore *model,
+			 FileBrowserNodeDir    *dir)
+{
+	guint size;
+
+	if (dir_visible_tree_is_valid (model, dir))
+		return;
+
+	size = dir->children->len;
+
+	g_free (dir->visible_tree);
+	dir->visible_tree = g_new0 (guint, size + 1);
+	dir->visible_tree_size = size;
+	dir->visible_generation = model->priv->visible_generation;
+
+	for (guint i = 1; i <= size; ++i)
+	{
+		FileBrowserNode *child = g_ptr_array_index (dir->children, i - 1);
+		guint parent = i + (i & -i);
+
+		child->counted = model_node_inserted (model, child);
+		dir->visible_tree[i] += child->counted ? 1 : 0;
+
+		if (parent <= size)
+			dir->visible_tree[parent] += dir->visible_tree[i];
+	}
+}
+
+/* Returns the number of inserted children before the position @index */
+static guint
+dir_count_inserted_before (GeditFileBrowserStore *model,
+			   FileBrowserNodeDir    *dir,
+			   guint                  index)
+{
+	guint count = 0;
+
+	dir_ensure_visible_tree (model, dir);
+
+	for (guint i = MIN (index, dir->visible_tree_size); i > 0; i -= i & -i)
+		count += dir->visible_tree[i];
+
+	return count;
+}
+
+/* Returns the inserted child with @n inserted children before it */
+static FileBrowserNode *
+dir_get_nth_inserted (GeditFileBrowserStore *model,
+		      FileBrowserNodeDir    *dir,
+		      gint                   n)
+{
+	guint pos = 0;
+	guint remaining;
+	guint step = 1;
+
+	if (n < 0)
+		return NULL;
+
+	dir_ensure_visible_tree (model, dir);
+
+	while (step * 2 <= dir->visible_tree_size)
+		step *= 2;
+
+	/* Find the largest position with at most n inserted children up to it */
+	remaining = n;
+
+	for (; step > 0; step /= 2)
+	{
+		if (pos + step <= dir->visible_tree_size &&
+		    dir->visible_tree[pos + step] <= remaining)
+		{
+			pos += step;
+			remaining -= dir->visible_tree[pos];
+		}
+	}
+
+	if (pos >= dir->visible_tree_size)
+		return NULL;
+
+	return g_ptr_array_index (dir->children, pos);
+}
+
+static gboolean
+dir_has_child_at (FileBrowserNodeDir *dir,
+		  FileBrowserNode    *node)
+{
+	return node->index < dir->children->len &&
+	       g_ptr_array_index (dir->children, node->index) == node;
+}
+
+/* Must be called whenever the inserted state or the visibility of a node
+ * changes, to keep the visible tree of its parent up to date. */
+static void
+model_node_update_count (GeditFileBrowserStore *model,
+			 FileBrowserNode       *node)
+{
+	FileBrowserNodeDir *dir;
+	gboolean counted;
+
+	if (node->parent == NULL)
+		return;
+
+	dir = FILE_BROWSER_NODE_DIR (node->parent);
+
+	if (!dir_visible_tree_is_valid (model, dir) || !dir_has_child_at (dir, node))
+		return;
+
+	counted = model_node_inserted (model, node);
+
+	if (counted == node->counted)
+		return;
+
+	node->counted = counted;
+
+	for (guint i = node->index + 1; i <= dir->visible_tree_size; i += i & -i)
+	{
+		if (counted)
+			++dir->visible_tree[i];
+		else
+			--dir->visible_tree[i];
+	}
+}
+
+static void
+dir_reindex_children (FileBrowserNodeDir *dir,
+		      guint               from)
+{
+	for (guint i = from; i < dir->children->len; ++i)
+		((FileBrowserNode *)g_ptr_array_index (dir->children, i))->index = i;
+
+	dir_invalidate_visible_tree (dir);
+}
+
+static void
+dir_insert_child (FileBrowserNodeDir *dir,
+		  FileBrowserNode    *child,
+		  guint               index)
+{
+	g_ptr_array_insert (dir->children, index, child);
+	dir_reindex_children (dir, index);
+}
+
+static void
+dir_remove_child (FileBrowserNodeDir *dir,
+		  FileBrowserNode    *child)
+{
+	guint index = child->index;
+
+	g_return_if_fail (dir_has_child_at (dir, child));
+
+	g_ptr_array_remove_index (dir->children, index);
+	dir_reindex_children (dir, index);
+}
+
 /* Interface implementation */
 
 static GtkTreeModelFlags
@@ -580,32 +831,16 @@ gedit_file_browser_store_get_iter (GtkTreeModel *tree_model,
 
 	for (guint i = 0; i < depth; ++i)
 	{
-		GSList *item;
-		gint num = 0;
-
 		if (node == NULL)
 			return FALSE;
 
 		if (!NODE_IS_DIR (node))
 			return FALSE;
 
-		for (item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
-		{
-			FileBrowserNode *child = (FileBrowserNode *)(item->data);
-
-			if (model_node_inserted (model, child))
-			{
-				if (num == indices[i])
-					break;
-
-				num++;
-			}
-		}
+		node = dir_get_nth_inserted (model, FILE_BROWSER_NODE_DIR (node), indices[i]);
 
-		if (item == NULL)
+		if (node == NULL)
 			return FALSE;
-
-		node = (FileBrowserNode *)(item->data);
 	}
 
 	iter->user_data = node;
@@ -620,42 +855,36 @@ gedit_file_browser_store_get_path_real (GeditFileBrowserStore *model,
 					FileBrowserNode       *node)
 {
 	GtkTreePath *path = gtk_tree_path_new ();
-	gint num = 0;
 
 	while (node != model->priv->virtual_root)
 	{
+		FileBrowserNodeDir *dir;
+
 		if (node->parent == NULL)
 		{
 			gtk_tree_path_free (path);
 			return NULL;
 		}
 
-		num = 0;
+		dir = FILE_BROWSER_NODE_DIR (node->parent);
 
-		for (GSList *item = FILE_BROWSER_NODE_DIR (node->parent)->children; item; item = item->next)
+		if (!dir_has_child_at (dir, node))
 		{
-			FileBrowserNode *check = (FileBrowserNode *)(item->data);
-
-			if (model_node_visibility (model, check) && (check == node || check->inserted))
-			{
-				if (check == node)
-				{
-					gtk_tree_path_prepend_index (path, num);
-					break;
-				}
+			gtk_tree_path_free (path);
+			return NULL;
+		}
 
-				++num;
-			}
-			else if (check == node)
-			{
-				if (NODE_IS_DUMMY (node))
-					g_warning ("Dummy not visible???");
+		if (!model_node_visibility (model, node))
+		{
+			if (NODE_IS_DUMMY (node))
+				g_warning ("Dummy not visible???");
 
-				gtk_tree_path_free (path);
-				return NULL;
-			}
+			gtk_tree_path_free (path);
+			return NULL;
 		}
 
+		gtk_tree_path_prepend_index (path, dir_count_inserted_before (model, dir, node->index));
+
 		node = node->parent;
 	}
 
@@ -724,7 +953,8 @@ gedit_file_browser_store_iter_next (GtkTreeModel *tree_model,
 {
 	GeditFileBrowserStore *model;
 	FileBrowserNode *node;
-	GSList *first;
+	FileBrowserNodeDir *dir;
+	FileBrowserNode *next;
 
 	g_return_val_if_fail (GEDIT_IS_FILE_BROWSER_STORE (tree_model), FALSE);
 	g_return_val_if_fail (iter != NULL, FALSE);
@@ -736,18 +966,18 @@ gedit_file_browser_store_iter_next (GtkTreeModel *tree_model,
 	if (node->parent == NULL)
 		return FALSE;
 
-	first = g_slist_next (g_slist_find (FILE_BROWSER_NODE_DIR (node->parent)->children, node));
+	dir = FILE_BROWSER_NODE_DIR (node->parent);
 
-	for (GSList *item = first; item; item = item->next)
-	{
-		if (model_node_inserted (model, (FileBrowserNode *)(item->data)))
-		{
-			iter->user_data = item->data;
-			return TRUE;
-		}
-	}
+	if (!dir_has_child_at (dir, node))
+		return FALSE;
 
-	return FALSE;
+	next = dir_get_nth_inserted (model, dir, dir_count_inserted_before (model, dir, node->index + 1));
+
+	if (next == NULL)
+		return FALSE;
+
+	iter->user_data = next;
+	return TRUE;
 }
 
 static gboolean
@@ -774,28 +1004,32 @@ gedit_file_browser_store_iter_children (GtkTreeModel *tree_model,
 	if (!NODE_IS_DIR (node))
 		return FALSE;
 
-	for (GSList *item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
-	{
-		if (model_node_inserted (model, (FileBrowserNode *)(item->data)))
-		{
-			iter->user_data = item->data;
-			return TRUE;
-		}
-	}
+	node = dir_get_nth_inserted (model, FILE_BROWSER_NODE_DIR (node), 0);
 
-	return FALSE;
+	if (node == NULL)
+		return FALSE;
+
+	iter->user_data = node;
+	return TRUE;
 }
 
 static gboolean
 filter_tree_model_iter_has_child_real (GeditFileBrowserStore *model,
 				       FileBrowserNode       *node)
 {
+	FileBrowserNodeDir *dir;
+
 	if (!NODE_IS_DIR (node))
 		return FALSE;
 
-	for (GSList *item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
+	dir = FILE_BROWSER_NODE_DIR (node);
+
+	/* Not using the visible tree since model_check_dummy() temporarily
+	   hides the dummy without updating it. Inserted children are usually
+	   found right after the dummy anyway. */
+	for (guint i = 0; i < dir->children->len; ++i)
 	{
-		if (model_node_inserted (model, (FileBrowserNode *)(item->data)))
+		if (model_node_inserted (model, g_ptr_array_index (dir->children, i)))
 			return TRUE;
 	}
 
@@ -827,8 +1061,8 @@ gedit_file_browser_store_iter_n_children (GtkTreeModel *tree_model,
 					  GtkTreeIter  *iter)
 {
 	FileBrowserNode *node;
+	FileBrowserNodeDir *dir;
 	GeditFileBrowserStore *model;
-	gint num = 0;
 
 	g_return_val_if_fail (GEDIT_IS_FILE_BROWSER_STORE (tree_model), FALSE);
 	g_return_val_if_fail (iter == NULL || iter->user_data != NULL, FALSE);
@@ -843,13 +1077,9 @@ gedit_file_browser_store_iter_n_children (GtkTreeModel *tree_model,
 	if (!NODE_IS_DIR (node))
 		return 0;
 
-	for (GSList *item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
-	{
-		if (model_node_inserted (model, (FileBrowserNode *)(item->data)))
-			++num;
-	}
+	dir = FILE_BROWSER_NODE_DIR (node);
 
-	return num;
+	return dir_count_inserted_before (model, dir, dir->children->len);
 }
 
 static gboolean
@@ -860,7 +1090,6 @@ gedit_file_browser_store_iter_nth_child (GtkTreeModel *tree_model,
 {
 	FileBrowserNode *node;
 	GeditFileBrowserStore *model;
-	gint num = 0;
 
 	g_return_val_if_fail (GEDIT_IS_FILE_BROWSER_STORE (tree_model), FALSE);
 	g_return_val_if_fail (parent == NULL || parent->user_data != NULL, FALSE);
@@ -875,21 +1104,13 @@ gedit_file_browser_store_iter_nth_child (GtkTreeModel *tree_model,
 	if (!NODE_IS_DIR (node))
 		return FALSE;
 
-	for (GSList *item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
-	{
-		if (model_node_inserted (model, (FileBrowserNode *)(item->data)))
-		{
-			if (num == n)
-			{
-				iter->user_data = item->data;
-				return TRUE;
-			}
+	node = dir_get_nth_inserted (model, FILE_BROWSER_NODE_DIR (node), n);
 
-			++num;
-		}
-	}
+	if (node == NULL)
+		return FALSE;
 
-	return FALSE;
+	iter->user_data = node;
+	return TRUE;
 }
 
 static gboolean
@@ -925,6 +1146,7 @@ gedit_file_browser_store_row_inserted (GtkTreeModel *tree_model,
 	FileBrowserNode *node = (FileBrowserNode *)(iter->user_data);
 
 	node->inserted = TRUE;
+	model_node_update_count (GEDIT_FILE_BROWSER_STORE (tree_model), node);
 }
 
 static gboolean
@@ -1003,9 +1225,49 @@ model_end_loading (GeditFileBrowserStore *model,
 	g_signal_emit (model, model_signals[END_LOADING], 0, &iter);
 }
 
+/* Can be called from the directory loading threads */
+static gboolean
+name_matches_binary_patterns (GPtrArray   *specs,
+			      const gchar *name)
+{
+	gssize name_length;
+	gchar *name_reversed;
+	gboolean matches = FALSE;
+
+	if (specs == NULL || name == NULL)
+		return FALSE;
+
+	name_length = strlen (name);
+	name_reversed = g_utf8_strreverse (name, name_length);
+
+	for (guint i = 0; i < specs->len && !matches; ++i)
+	{
+		GPatternSpec *spec = g_ptr_array_index (specs, i);
+
+		matches = g_pattern_match (spec, name_length, name, name_reversed);
+	}
+
+	g_free (name_reversed);
+	return matches;
+}
+
+static gboolean
+node_matches_binary_pattern (GeditFileBrowserStore *model,
+			     FileBrowserNode       *node)
+{
+	if (node->binary_patterns_generation != model->priv->binary_patterns_generation)
+	{
+		node->matches_binary_pattern = name_matches_binary_patterns (model->priv->binary_pattern_specs,
+									     node->name);
+		node->binary_patterns_generation = model->priv->binary_patterns_generation;
+	}
+
+	return node->matches_binary_pattern;
+}
+
 static void
-model_node_update_visibility (GeditFileBrowserStore *model,
-			      FileBrowserNode       *node)
+model_node_update_filtered (GeditFileBrowserStore *model,
+			    FileBrowserNode       *node)
 {
 	GtkTreeIter iter;
 
@@ -1025,24 +1287,11 @@ model_node_update_visibility (GeditFileBrowserStore *model,
 			node->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_FILTERED;
 			return;
 		}
-		else if (model->priv->binary_patterns != NULL)
+		else if (model->priv->binary_patterns != NULL &&
+			 node_matches_binary_pattern (model, node))
 		{
-			gssize name_length = strlen (node->name);
-			gchar *name_reversed = g_utf8_strreverse (node->name, name_length);
-
-			for (guint i = 0; i < model->priv->binary_pattern_specs->len; ++i)
-			{
-				GPatternSpec *spec = g_ptr_array_index (model->priv->binary_pattern_specs, i);
-
-				if (g_pattern_match (spec, name_length, node->name, name_reversed))
-				{
-					node->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_FILTERED;
-					g_free (name_reversed);
-					return;
-				}
-			}
-
-			g_free (name_reversed);
+			node->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_FILTERED;
+			return;
 		}
 	}
 
@@ -1055,6 +1304,14 @@ model_node_update_visibility (GeditFileBrowserStore *model,
 	}
 }
 
+static void
+model_node_update_visibility (GeditFileBrowserStore *model,
+			      FileBrowserNode       *node)
+{
+	model_node_update_filtered (model, node);
+	model_node_update_count (model, node);
+}
+
 static gint
 collate_nodes (FileBrowserNode *node1,
 	       FileBrowserNode *node2)
@@ -1069,14 +1326,13 @@ collate_nodes (FileBrowserNode *node1,
 	}
 	else
 	{
-		gchar *k1 = g_utf8_collate_key_for_filename (node1->name, -1);
-		gchar *k2 = g_utf8_collate_key_for_filename (node2->name, -1);
-		gint result = strcmp (k1, k2);
+		if (node1->collate_key == NULL)
+			node1->collate_key = g_utf8_collate_key_for_filename (node1->name, -1);
 
-		g_free (k1);
-		g_free (k2);
+		if (node2->collate_key == NULL)
+			node2->collate_key = g_utf8_collate_key_for_filename (node2->name, -1);
 
-		return result;
+		return strcmp (node1->collate_key, node2->collate_key);
 	}
 }
 
@@ -1101,6 +1357,24 @@ model_sort_default (FileBrowserNode *node1,
 	return collate_nodes (node1, node2);
 }
 
+static gint
+compare_nodes (gconstpointer a,
+	       gconstpointer b,
+	       gpointer      user_data)
+{
+	GeditFileBrowserStore *model = user_data;
+
+	return model->priv->sort_func (*(FileBrowserNode **)a, *(FileBrowserNode **)b);
+}
+
+static void
+dir_sort_children (GeditFileBrowserStore *model,
+		   FileBrowserNodeDir    *dir)
+{
+	g_ptr_array_sort_with_data (dir->children, compare_nodes, model);
+	dir_reindex_children (dir, 0);
+}
+
 static void
 model_resort_node (GeditFileBrowserStore *model,
 		   FileBrowserNode       *node)
@@ -1110,7 +1384,7 @@ model_resort_node (GeditFileBrowserStore *model,
 	if (!model_node_visibility (model, node->parent))
 	{
 		/* Just sort the children of the parent */
-		dir->children = g_slist_sort (dir->children, (GCompareFunc)(model->priv->sort_func));
+		dir_sort_children (model, dir);
 	}
 	else
 	{
@@ -1120,22 +1394,22 @@ model_resort_node (GeditFileBrowserStore *model,
 		gint pos = 0;
 
 		/* Store current positions */
-		for (GSList *item = dir->children; item; item = item->next)
+		for (guint i = 0; i < dir->children->len; ++i)
 		{
-			FileBrowserNode *child = (FileBrowserNode *)(item->data);
+			FileBrowserNode *child = g_ptr_array_index (dir->children, i);
 
 			if (model_node_visibility (model, child))
 				child->pos = pos++;
 		}
 
-		dir->children = g_slist_sort (dir->children, (GCompareFunc)(model->priv->sort_func));
+		dir_sort_children (model, dir);
 		neworder = g_new (gint, pos);
 		pos = 0;
 
 		/* Store the new positions */
-		for (GSList *item = dir->children; item; item = item->next)
+		for (guint i = 0; i < dir->children->len; ++i)
 		{
-			FileBrowserNode *child = (FileBrowserNode *)(item->data);
+			FileBrowserNode *child = g_ptr_array_index (dir->children, i);
 
 			if (model_node_visibility (model, child))
 				neworder[pos++] = child->pos;
@@ -1223,6 +1497,8 @@ row_deleted (GeditFileBrowserStore *model,
 	if (hidden)
 		node->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_HIDDEN;
 
+	model_node_update_count (model, node);
+
 	copy = gtk_tree_path_copy (path);
 	gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), copy);
 	gtk_tree_path_free (copy);
@@ -1236,7 +1512,6 @@ model_refilter_node (GeditFileBrowserStore  *model,
 	gboolean old_visible;
 	gboolean new_visible;
 	FileBrowserNodeDir *dir;
-	GSList *item;
 	GtkTreeIter iter;
 	GtkTreePath *tmppath = NULL;
 	gboolean in_tree;
@@ -1266,8 +1541,8 @@ model_refilter_node (GeditFileBrowserStore  *model,
 
 		dir = FILE_BROWSER_NODE_DIR (node);
 
-		for (item = dir->children; item; item = item->next)
-			model_refilter_node (model, (FileBrowserNode *)(item->data), path);
+		for (guint i = 0; i < dir->children->len; ++i)
+			model_refilter_node (model, g_ptr_array_index (dir->children, i), path);
 
 		if (in_tree)
 			gtk_tree_path_up (*path);
@@ -1305,19 +1580,21 @@ model_refilter_node (GeditFileBrowserStore  *model,
 static void
 model_refilter (GeditFileBrowserStore *model)
 {
+	model_invalidate_visible_trees (model);
 	model_refilter_node (model, model->priv->root, NULL);
 }
 
 static void
-file_browser_node_set_name (FileBrowserNode *node)
+file_browser_node_take_name (FileBrowserNode *node,
+			     gchar           *name)
 {
 	g_free (node->name);
 	g_free (node->markup);
+	g_free (node->collate_key);
 
-	if (node->file)
-		node->name = gedit_file_browser_utils_file_basename (node->file);
-	else
-		node->name = NULL;
+	node->name = name;
+	node->collate_key = NULL;
+	node->binary_patterns_generation = 0;
 
 	if (node->name)
 		node->markup = g_markup_escape_text (node->name, -1);
@@ -1326,57 +1603,110 @@ file_browser_node_set_name (FileBrowserNode *node)
 }
 
 static void
-file_browser_node_init (FileBrowserNode *node,
-			GFile           *file,
-			FileBrowserNode *parent)
+file_browser_node_set_name (FileBrowserNode *node)
 {
-	if (file != NULL)
-	{
-		node->file = g_object_ref (file);
-		file_browser_node_set_name (node);
-	}
-
-	node->parent = parent;
+	if (node->file)
+		file_browser_node_take_name (node, gedit_file_browser_utils_file_basename (node->file));
+	else
+		file_browser_node_take_name (node, NULL);
 }
 
-static FileBrowserNode *
-file_browser_node_new (GFile           *file,
-		       FileBrowserNode *parent)
+static void
+model_index_node (GeditFileBrowserStore *model,
+		  FileBrowserNode       *node)
 {
-	FileBrowserNode *node = g_slice_new0 (FileBrowserNode);
+	if (node->file != NULL)
+		g_hash_table_replace (model->priv->file_index, node->file, node);
+}
 
-	file_browser_node_init (node, file, parent);
-	return node;
+static void
+model_unindex_node (GeditFileBrowserStore *model,
+		    FileBrowserNode       *node)
+{
+	/* Only remove the entry if it still refers to this node */
+	if (node->file != NULL &&
+	    g_hash_table_lookup (model->priv->file_index, node->file) == node)
+	{
+		g_hash_table_remove (model->priv->file_index, node->file);
+	}
 }
 
+/* Takes ownership of @name, the name is computed from @file when NULL */
 static FileBrowserNode *
-file_browser_node_dir_new (GeditFileBrowserStore *model,
-			   GFile                 *file,
-			   FileBrowserNode       *parent)
+file_browser_node_new_full (GeditFileBrowserStore *model,
+			    GFile                 *file,
+			    gchar                 *name,
+			    gboolean               is_dir,
+			    FileBrowserNode       *parent)
 {
-	FileBrowserNode *node = (FileBrowserNode *)g_slice_new0 (FileBrowserNodeDir);
+	FileBrowserNode *node;
 
-	file_browser_node_init (node, file, parent);
+	if (is_dir)
+	{
+		node = (FileBrowserNode *)g_slice_new0 (FileBrowserNodeDir);
+		node->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_DIRECTORY;
 
-	node->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_DIRECTORY;
+		FILE_BROWSER_NODE_DIR (node)->children = g_ptr_array_new ();
+		FILE_BROWSER_NODE_DIR (node)->model = model;
+	}
+	else
+	{
+		node = g_slice_new0 (FileBrowserNode);
+	}
 
-	FILE_BROWSER_NODE_DIR (node)->model = model;
+	if (file != NULL)
+	{
+		node->file = g_object_ref (file);
 
-	return node;
-}
+		if (name != NULL)
+			file_browser_node_take_name (node, name);
+		else
+			file_browser_node_set_name (node);
+
+		model_index_node (model, node);
+	}
+	else
+	{
+		g_free (name);
+	}
+
+	node->parent = parent;
+
+	return node;
+}
+
+static FileBrowserNode *
+file_browser_node_new (GeditFileBrowserStore *model,
+		       GFile                 *file,
+		       FileBrowserNode       *parent)
+{
+	return file_browser_node_new_full (model, file, NULL, FALSE, parent);
+}
+
+static FileBrowserNode *
+file_browser_node_dir_new (GeditFileBrowserStore *model,
+			   GFile                 *file,
+			   FileBrowserNode       *parent)
+{
+	return file_browser_node_new_full (model, file, NULL, TRUE, parent);
+}
 
 static void
 file_browser_node_free_children (GeditFileBrowserStore *model,
 				 FileBrowserNode       *node)
 {
+	FileBrowserNodeDir *dir;
+
 	if (node == NULL || !NODE_IS_DIR (node))
 		return;
 
-	for (GSList *item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
-		file_browser_node_free (model, (FileBrowserNode *)(item->data));
+	dir = FILE_BROWSER_NODE_DIR (node);
+
+	for (guint i = 0; i < dir->children->len; ++i)
+		file_browser_node_free (model, g_ptr_array_index (dir->children, i));
 
-	g_slist_free (FILE_BROWSER_NODE_DIR (node)->children);
-	FILE_BROWSER_NODE_DIR (node)->children = NULL;
+	g_ptr_array_set_size (dir->children, 0);
+	dir_invalidate_visible_tree (dir);
 
 	/* This node is no longer loaded */
 	node->flags &= ~GEDIT_FILE_BROWSER_STORE_FLAG_LOADED;
@@ -1401,7 +1731,10 @@ file_browser_node_free (GeditFileBrowserStore *model,
 			model_end_loading (model, node);
 		}
 
+		dir_clear_pending_events (dir);
 		file_browser_node_free_children (model, node);
+		g_ptr_array_unref (dir->children);
+		g_free (dir->visible_tree);
 
 		if (dir->monitor)
 		{
@@ -1412,6 +1745,8 @@ file_browser_node_free (GeditFileBrowserStore *model,
 
 	if (node->file)
 	{
+		model_unindex_node (model, node);
+
 		g_signal_emit (model, model_signals[UNLOAD], 0, node->file);
 		g_object_unref (node->file);
 	}
@@ -1425,6 +1760,7 @@ file_browser_node_free (GeditFileBrowserStore *model,
 	g_free (node->icon_name);
 	g_free (node->name);
 	g_free (node->markup);
+	g_free (node->collate_key);
 
 	if (NODE_IS_DIR (node))
 		g_slice_free (FileBrowserNodeDir, (FileBrowserNodeDir *)node);
@@ -1451,14 +1787,15 @@ model_remove_node_children (GeditFileBrowserStore *model,
 {
 	FileBrowserNodeDir *dir;
 	GtkTreePath *path_child;
-	GSList *list;
+	FileBrowserNode **children;
+	guint n_children;
 
 	if (node == NULL || !NODE_IS_DIR (node))
 		return;
 
 	dir = FILE_BROWSER_NODE_DIR (node);
 
-	if (dir->children == NULL)
+	if (dir->children->len == 0)
 		return;
 
 	if (!model_node_visibility (model, node))
@@ -1477,13 +1814,38 @@ model_remove_node_children (GeditFileBrowserStore *model,
 
 	gtk_tree_path_down (path_child);
 
-	list = g_slist_copy (dir->children);
+	/* The nodes are only detached from the directory once they are all
+	   removed from the model: removing them one at a time from the front
+	   of the children array would be quadratic */
+	n_children = dir->children->len;
+	children = g_memdup (dir->children->pdata, n_children * sizeof (FileBrowserNode *));
 
-	for (GSList *item = list; item; item = item->next)
-		model_remove_node (model, (FileBrowserNode *)(item->data), path_child, free_nodes);
+	for (guint i = 0; i < n_children; ++i)
+		model_remove_node (model, children[i], path_child, FALSE);
 
-	g_slist_free (list);
+	g_free (children);
 	gtk_tree_path_free (path_child);
+
+	if (free_nodes)
+	{
+		GPtrArray *removed = dir->children;
+
+		dir->children = g_ptr_array_new ();
+
+		for (guint i = 0; i < removed->len; ++i)
+		{
+			FileBrowserNode *child = g_ptr_array_index (removed, i);
+
+			/* Keep the dummy, shown when the last child was removed */
+			if (i == 0 && NODE_IS_DUMMY (child))
+				g_ptr_array_add (dir->children, child);
+			else
+				file_browser_node_free (model, child);
+		}
+
+		g_ptr_array_unref (removed);
+		dir_reindex_children (dir, 0);
+	}
 }
 
 /**
@@ -1526,8 +1888,7 @@ model_remove_node (GeditFileBrowserStore *model,
 
 	/* Remove the node from the parents children list */
 	if (free_nodes && parent)
-		FILE_BROWSER_NODE_DIR (node->parent)->children =
-			g_slist_remove (FILE_BROWSER_NODE_DIR (node->parent)->children, node);
+		dir_remove_child (FILE_BROWSER_NODE_DIR (parent), node);
 
 	/* If this is the virtual root, than set the parent as the virtual root */
 	if (node == model->priv->virtual_root)
@@ -1563,9 +1924,9 @@ model_clear (GeditFileBrowserStore *model,
 	{
 		FileBrowserNodeDir *dir = FILE_BROWSER_NODE_DIR (model->priv->virtual_root);
 
-		if (dir->children != NULL)
+		if (dir->children->len > 0)
 		{
-			FileBrowserNode *dummy = (FileBrowserNode *)(dir->children->data);
+			FileBrowserNode *dummy = g_ptr_array_index (dir->children, 0);
 
 			if (NODE_IS_DUMMY (dummy) && model_node_visibility (model, dummy))
 			{
@@ -1612,6 +1973,8 @@ file_browser_node_unload (GeditFileBrowserStore *model,
 		dir->monitor = NULL;
 	}
 
+	dir_clear_pending_events (dir);
+
 	node->flags &= ~GEDIT_FILE_BROWSER_STORE_FLAG_LOADED;
 }
 
@@ -1699,7 +2062,7 @@ model_create_dummy_node (GeditFileBrowserStore *model,
 {
 	FileBrowserNode *dummy;
 
-	dummy = file_browser_node_new (NULL, parent);
+	dummy = file_browser_node_new (model, NULL, parent);
 	dummy->name = g_strdup (_("(Empty)"));
 	dummy->markup = g_markup_escape_text (dummy->name, -1);
 
@@ -1738,23 +2101,24 @@ model_check_dummy (GeditFileBrowserStore *model,
 		GtkTreePath *path;
 		guint flags;
 
-		if (dir->children == NULL)
+		if (dir->children->len == 0)
 		{
 			model_add_dummy_node (model, node);
 			return;
 		}
 
-		dummy = (FileBrowserNode *)(dir->children->data);
+		dummy = g_ptr_array_index (dir->children, 0);
 
 		if (!NODE_IS_DUMMY (dummy))
 		{
 			dummy = model_create_dummy_node (model, node);
-			dir->children = g_slist_prepend (dir->children, dummy);
+			dir_insert_child (dir, dummy, 0);
 		}
 
 		if (!model_node_visibility (model, node))
 		{
 			dummy->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_HIDDEN;
+			model_node_update_count (model, dummy);
 			return;
 		}
 
@@ -1798,11 +2162,25 @@ insert_node_sorted (GeditFileBrowserStore *model,
 		    FileBrowserNode       *parent)
 {
 	FileBrowserNodeDir *dir = FILE_BROWSER_NODE_DIR (parent);
+	guint low = 0;
+	guint high = dir->children->len;
 
 	if (model->priv->sort_func == NULL)
-		dir->children = g_slist_append (dir->children, child);
-	else
-		dir->children = g_slist_insert_sorted (dir->children, child, (GCompareFunc)(model->priv->sort_func));
+		low = high;
+
+	/* Insert before the first node not sorting before the child, like
+	   g_slist_insert_sorted() */
+	while (low < high)
+	{
+		guint middle = low + (high - low) / 2;
+
+		if (model->priv->sort_func (child, g_ptr_array_index (dir->children, middle)) > 0)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	dir_insert_child (dir, child, low);
 }
 
 static void
@@ -1831,89 +2209,72 @@ model_add_node (GeditFileBrowserStore *model,
 }
 
 static void
-model_add_nodes_batch (GeditFileBrowserStore *model,
-		       GSList                *children,
-		       FileBrowserNode       *parent)
+model_add_sorted_nodes_batch (GeditFileBrowserStore *model,
+			      GSList                *sorted_children,
+			      FileBrowserNode       *parent)
 {
 	FileBrowserNodeDir *dir = FILE_BROWSER_NODE_DIR (parent);
-	GSList *sorted_children = g_slist_sort (children, (GCompareFunc)model->priv->sort_func);
-	GSList *child = sorted_children;
-	GSList *prev = NULL;
-	GSList *l = dir->children;
+	GPtrArray *merged;
+	guint i = 0;
 
 	model_check_dummy (model, parent);
 
-	while (child)
-	{
-		FileBrowserNode *node = child->data;
-		GtkTreeIter iter;
-		GtkTreePath *path;
+	/* Merge the sorted children with the existing ones in a single pass,
+	   new nodes go after the existing nodes comparing equal */
+	merged = g_ptr_array_sized_new (dir->children->len + g_slist_length (sorted_children));
 
-		/* Reached the end of the first list, just append the second */
-		if (l == NULL)
+	for (GSList *child = sorted_children; child; child = child->next)
+	{
+		while (i < dir->children->len &&
+		       model->priv->sort_func (g_ptr_array_index (dir->children, i), child->data) <= 0)
 		{
-			dir->children = g_slist_concat (dir->children, child);
+			g_ptr_array_add (merged, g_ptr_array_index (dir->children, i++));
+		}
 
-			for (l = child; l; l = l->next)
-			{
-				if (model_node_visibility (model, parent) &&
-				    model_node_visibility (model, l->data))
-				{
-					iter.user_data = l->data;
-					path = gedit_file_browser_store_get_path_real (model, l->data);
+		g_ptr_array_add (merged, child->data);
+	}
 
-					/* Emit row inserted */
-					row_inserted (model, &path, &iter);
-					gtk_tree_path_free (path);
-				}
+	for (; i < dir->children->len; ++i)
+		g_ptr_array_add (merged, g_ptr_array_index (dir->children, i));
 
-				model_check_dummy (model, l->data);
-			}
+	g_ptr_array_unref (dir->children);
+	dir->children = merged;
+	dir_reindex_children (dir, 0);
 
-			break;
-		}
+	/* The new nodes are not inserted yet, so they are not counted in the
+	   paths of the nodes emitted before them */
+	for (GSList *child = sorted_children; child; child = child->next)
+	{
+		FileBrowserNode *node = child->data;
 
-		if (model->priv->sort_func (l->data, node) > 0)
+		if (model_node_visibility (model, parent) &&
+		    model_node_visibility (model, node))
 		{
-			GSList *next_child;
+			GtkTreeIter iter;
+			GtkTreePath *path;
 
-			if (prev == NULL)
-			{
-				/* Prepend to the list */
-				dir->children = g_slist_prepend (dir->children, child);
-			}
-			else
-			{
-				prev->next = child;
-			}
+			iter.user_data = node;
+			path = gedit_file_browser_store_get_path_real (model, node);
 
-			next_child = child->next;
-			prev = child;
-			child->next = l;
-			child = next_child;
+			/* Emit row inserted */
+			row_inserted (model, &path, &iter);
+			gtk_tree_path_free (path);
+		}
 
-			if (model_node_visibility (model, parent) &&
-			    model_node_visibility (model, node))
-			{
-				iter.user_data = node;
-				path = gedit_file_browser_store_get_path_real (model, node);
+		model_check_dummy (model, node);
+	}
 
-				/* Emit row inserted */
-				row_inserted (model, &path, &iter);
-				gtk_tree_path_free (path);
-			}
+	g_slist_free (sorted_children);
+}
 
-			model_check_dummy (model, node);
+static void
+model_add_nodes_batch (GeditFileBrowserStore *model,
+		       GSList                *children,
+		       FileBrowserNode       *parent)
+{
+	GSList *sorted_children = g_slist_sort (children, (GCompareFunc)model->priv->sort_func);
 
-			/* Try again at the same l position with the next child */
-		}
-		else
-		{
-			/* Move to the next item in the list */
-			prev = l;
-			l = l->next;
-		}
-	}
+	model_add_sorted_nodes_batch (model, sorted_children, parent);
 }
 
 static gchar const *
@@ -2032,16 +2393,14 @@ file_browser_node_set_from_info (GeditFileBrowserStore *model,
 }
 
 static FileBrowserNode *
-node_list_contains_file (GSList *children,
-			 GFile  *file)
+model_find_child (GeditFileBrowserStore *model,
+		  FileBrowserNode       *parent,
+		  GFile                 *file)
 {
-	for (GSList *item = children; item; item = item->next)
-	{
-		FileBrowserNode *node = (FileBrowserNode *)(item->data);
+	FileBrowserNode *node = g_hash_table_lookup (model->priv->file_index, file);
 
-		if (node->file != NULL && g_file_equal (node->file, file))
-			return node;
-	}
+	if (node != NULL && node->parent == parent)
+		return node;
 
 	return NULL;
 }
@@ -2056,7 +2415,7 @@ model_add_node_from_file (GeditFileBrowserStore *model,
 	gboolean free_info = FALSE;
 	GError *error = NULL;
 
-	if ((node = node_list_contains_file (FILE_BROWSER_NODE_DIR (parent)->children, file)) == NULL)
+	if ((node = model_find_child (model, parent, file)) == NULL)
 	{
 		if (info == NULL)
 		{
@@ -2074,7 +2433,7 @@ model_add_node_from_file (GeditFileBrowserStore *model,
 			g_error_free (error);
 
 			/* FIXME: What to do now then... */
-			node = file_browser_node_new (file, parent);
+			node = file_browser_node_new (model, file, parent);
 		}
 		else if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
 		{
@@ -2082,7 +2441,7 @@ model_add_node_from_file (GeditFileBrowserStore *model,
 		}
 		else
 		{
-			node = file_browser_node_new (file, parent);
+			node = file_browser_node_new (model, file, parent);
 		}
 
 		file_browser_node_set_from_info (model, node, info, FALSE);
@@ -2095,64 +2454,42 @@ model_add_node_from_file (GeditFileBrowserStore *model,
 	return node;
 }
 
-/* We pass in a copy of the list of parent->children so that we do
- * not have to check if a file already exists among the ones we just
- * added */
+/* Adds the entries loaded by a thread, which are already sorted */
 static void
-model_add_nodes_from_files (GeditFileBrowserStore *model,
-			    FileBrowserNode       *parent,
-			    GSList                *original_children,
-			    GList                 *files)
+model_add_entries (GeditFileBrowserStore *model,
+		   FileBrowserNode       *parent,
+		   GPtrArray             *entries,
+		   guint                  binary_patterns_generation)
 {
 	GSList *nodes = NULL;
 
-	for (GList *item = files; item; item = item->next)
+	for (guint i = entries->len; i > 0; --i)
 	{
-		GFileInfo *info = G_FILE_INFO (item->data);
-		GFileType type = g_file_info_get_file_type (info);
-		gchar const *name;
-		GFile *file;
+		LoadEntry *entry = g_ptr_array_index (entries, i - 1);
 		FileBrowserNode *node;
 
-		/* Skip all non regular, non directory files */
-		if (type != G_FILE_TYPE_REGULAR &&
-		    type != G_FILE_TYPE_DIRECTORY &&
-		    type != G_FILE_TYPE_SYMBOLIC_LINK)
-		{
-			g_object_unref (info);
-			continue;
-		}
-
-		name = g_file_info_get_name (info);
-
-		/* Skip '.' and '..' directories */
-		if (type == G_FILE_TYPE_DIRECTORY &&
-		    (strcmp (name, ".") == 0 ||
-		     strcmp (name, "..") == 0))
-		{
-			g_object_unref (info);
+		if (model_find_child (model, parent, entry->file) != NULL)
 			continue;
-		}
 
-		file = g_file_get_child (parent->file, name);
-		if (!(node = node_list_contains_file (original_children, file)))
-		{
-			if (type == G_FILE_TYPE_DIRECTORY)
-				node = file_browser_node_dir_new (model, file, parent);
-			else
-				node = file_browser_node_new (file, parent);
+		node = file_browser_node_new_full (model,
+						   entry->file,
+						   g_steal_pointer (&entry->name),
+						   FILE_IS_DIR (entry->flags),
+						   parent);
 
-			file_browser_node_set_from_info (model, node, info, FALSE);
+		node->flags |= entry->flags;
+		node->collate_key = g_steal_pointer (&entry->collate_key);
+		node->matches_binary_pattern = entry->matches_binary_pattern;
+		node->binary_patterns_generation = binary_patterns_generation;
 
-			nodes = g_slist_prepend (nodes, node);
-		}
+		model_recomposite_icon_real (model, node, entry->info);
+		model_node_update_visibility (model, node);
 
-		g_object_unref (file);
-		g_object_unref (info);
+		nodes = g_slist_prepend (nodes, node);
 	}
 
 	if (nodes)
-		model_add_nodes_batch (model, nodes, parent);
+		model_add_sorted_nodes_batch (model, nodes, parent);
 }
 
 static FileBrowserNode *
@@ -2163,7 +2500,7 @@ model_add_node_from_dir (GeditFileBrowserStore *model,
 	FileBrowserNode *node;
 
 	/* Check if it already exists */
-	if ((node = node_list_contains_file (FILE_BROWSER_NODE_DIR (parent)->children, file)) == NULL)
+	if ((node = model_find_child (model, parent, file)) == NULL)
 	{
 		node = file_browser_node_dir_new (model, file, parent);
 		file_browser_node_set_from_info (model, node, NULL, FALSE);
@@ -2179,6 +2516,143 @@ model_add_node_from_dir (GeditFileBrowserStore *model,
 	return node;
 }
 
+static GHashTable *
+pending_events_new (void)
+{
+	return g_hash_table_new_full ((GHashFunc)g_file_hash,
+				      (GEqualFunc)g_file_equal,
+				      g_object_unref,
+				      NULL);
+}
+
+static void
+dir_clear_pending_events (FileBrowserNodeDir *dir)
+{
+	if (dir->pending_events_id != 0)
+	{
+		g_source_remove (dir->pending_events_id);
+		dir->pending_events_id = 0;
+	}
+
+	if (dir->pending_events != NULL)
+	{
+		g_hash_table_destroy (dir->pending_events);
+		dir->pending_events = NULL;
+	}
+}
+
+/* Applies the pending events of the directory until the time budget is
+ * exhausted, returns TRUE when no events are left. Files created are
+ * added in a single batch, deleting a file which was never added is a
+ * no-op so that create/delete pairs collapse into nothing.
+ *
+ * The events are taken out of the directory first: removing a node
+ * emits signals whose handlers could clear or add pending events. */
+static gboolean
+dir_apply_pending_events (FileBrowserNodeDir *dir)
+{
+	GeditFileBrowserStore *model = dir->model;
+	FileBrowserNode *parent = (FileBrowserNode *)dir;
+	gint64 deadline = g_get_monotonic_time () + MONITOR_EVENTS_BUDGET;
+	GSList *nodes = NULL;
+	GHashTable *events;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+
+	events = dir->pending_events;
+	dir->pending_events = pending_events_new ();
+
+	g_hash_table_iter_init (&iter, events);
+
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		GFile *file = G_FILE (key);
+		FileBrowserNode *node = model_find_child (model, parent, file);
+
+		if (GPOINTER_TO_INT (value) == G_FILE_MONITOR_EVENT_DELETED)
+		{
+			if (node != NULL)
+				model_remove_node (model, node, NULL, TRUE);
+		}
+		else if (node == NULL)
+		{
+			GFileInfo *info = g_file_query_info (file,
+							     STANDARD_ATTRIBUTE_TYPES,
+							     G_FILE_QUERY_INFO_NONE,
+							     NULL,
+							     NULL);
+
+			/* The file may already be gone again */
+			if (info != NULL)
+			{
+				if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+					node = file_browser_node_dir_new (model, file, parent);
+				else
+					node = file_browser_node_new (model, file, parent);
+
+				file_browser_node_set_from_info (model, node, info, FALSE);
+				nodes = g_slist_prepend (nodes, node);
+
+				g_object_unref (info);
+			}
+		}
+
+		g_hash_table_iter_remove (&iter);
+
+		if (g_get_monotonic_time () >= deadline)
+			break;
+	}
+
+	if (nodes != NULL)
+		model_add_nodes_batch (model, nodes, parent);
+
+	/* Give back the events left for later, unless they were cleared
+	 * meanwhile or a newer event was received for the same file.
+	 */
+	if (dir->pending_events != NULL)
+	{
+		while (g_hash_table_iter_next (&iter, &key, &value))
+		{
+			if (!g_hash_table_contains (dir->pending_events, key))
+			{
+				g_hash_table_iter_steal (&iter);
+				g_hash_table_insert (dir->pending_events, key, value);
+			}
+			else
+			{
+				++model->priv->monitor_events_merged;
+			}
+		}
+	}
+
+	g_hash_table_destroy (events);
+
+	return dir->pending_events == NULL ||
+	       g_hash_table_size (dir->pending_events) == 0;
+}
+
+static gboolean
+on_pending_events_idle (FileBrowserNodeDir *dir)
+{
+	if (!dir_apply_pending_events (dir))
+		return G_SOURCE_CONTINUE;
+
+	dir->pending_events_id = 0;
+	return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_pending_events_timeout (FileBrowserNodeDir *dir)
+{
+	if (dir_apply_pending_events (dir))
+		dir->pending_events_id = 0;
+	else
+		dir->pending_events_id = g_idle_add ((GSourceFunc)on_pending_events_idle, dir);
+
+	return G_SOURCE_REMOVE;
+}
+
 static void
 on_directory_monitor_event (GFileMonitor      *monitor,
 			    GFile             *file,
@@ -2187,144 +2661,263 @@ on_directory_monitor_event (GFileMonitor      *monitor,
 			    FileBrowserNode   *parent)
 {
 	FileBrowserNodeDir *dir = FILE_BROWSER_NODE_DIR (parent);
-	FileBrowserNode *node;
+	GeditFileBrowserStorePrivate *priv = dir->model->priv;
 
-	switch (event_type)
+	if (event_type != G_FILE_MONITOR_EVENT_DELETED &&
+	    event_type != G_FILE_MONITOR_EVENT_CREATED)
 	{
-		case G_FILE_MONITOR_EVENT_DELETED:
-			node = node_list_contains_file (dir->children, file);
+		return;
+	}
 
-			if (node != NULL)
-				model_remove_node (dir->model, node, NULL, TRUE);
-			break;
-		case G_FILE_MONITOR_EVENT_CREATED:
-			if (g_file_query_exists (file, NULL))
-				model_add_node_from_file (dir->model, parent, file, NULL);
+	++priv->monitor_events_received;
 
-			break;
-		default:
-			break;
+	if (dir->pending_events == NULL)
+		dir->pending_events = pending_events_new ();
+
+	/* Only the last event received for a file matters */
+	if (g_hash_table_contains (dir->pending_events, file))
+		++priv->monitor_events_merged;
+
+	g_hash_table_insert (dir->pending_events,
+			     g_object_ref (file),
+			     GINT_TO_POINTER (event_type));
+
+	if (dir->pending_events_id == 0)
+	{
+		dir->pending_events_id = g_timeout_add (MONITOR_EVENTS_DELAY,
+							(GSourceFunc)on_pending_events_timeout,
+							dir);
 	}
 }
 
 static void
-async_node_free (AsyncNode *async)
+load_job_free (LoadJob *job)
 {
-	g_object_unref (async->cancellable);
-	g_slist_free (async->original_children);
-	g_slice_free (AsyncNode, async);
+	g_object_unref (job->file);
+
+	if (job->binary_pattern_specs != NULL)
+		g_ptr_array_unref (job->binary_pattern_specs);
+
+	g_main_context_unref (job->context);
+	g_slice_free (LoadJob, job);
 }
 
 static void
-model_iterate_next_files_cb (GFileEnumerator *enumerator,
-			     GAsyncResult    *result,
-			     AsyncNode       *async)
+load_entry_free (LoadEntry *entry)
 {
-	GError *error = NULL;
-	GList *files = g_file_enumerator_next_files_finish (enumerator, result, &error);
-	FileBrowserNodeDir *dir = async->dir;
-	FileBrowserNode *parent = (FileBrowserNode *)dir;
+	g_object_unref (entry->file);
+	g_object_unref (entry->info);
+	g_free (entry->name);
+	g_free (entry->collate_key);
+	g_slice_free (LoadEntry, entry);
+}
 
-	if (files == NULL)
-	{
-		g_file_enumerator_close (enumerator, NULL, NULL);
-		g_object_unref (enumerator);
-		async_node_free (async);
+static void
+load_batch_free (LoadBatch *batch)
+{
+	g_object_unref (batch->task);
+	g_ptr_array_unref (batch->entries);
+	g_slice_free (LoadBatch, batch);
+}
 
-		if (!error)
-		{
-			/* We're done loading */
-			g_object_unref (dir->cancellable);
-			dir->cancellable = NULL;
+/* Sorts like model_sort_default */
+static gint
+compare_entries (gconstpointer a,
+		 gconstpointer b)
+{
+	LoadEntry *entry1 = *(LoadEntry **)a;
+	LoadEntry *entry2 = *(LoadEntry **)b;
+	gint f1 = FILE_IS_DIR (entry1->flags);
+	gint f2 = FILE_IS_DIR (entry2->flags);
 
-/*
- * FIXME: This is temporarly, it is a bug in gio:
- * http://bugzilla.gnome.org/show_bug.cgi?id=565924
- */
-#ifndef G_OS_WIN32
-			if (g_file_is_native (parent->file) && dir->monitor == NULL)
-			{
-				dir->monitor = g_file_monitor_directory (parent->file,
-									 G_FILE_MONITOR_NONE,
-									 NULL,
-									 NULL);
-				if (dir->monitor != NULL)
-				{
-					g_signal_connect (dir->monitor,
-							  "changed",
-							  G_CALLBACK (on_directory_monitor_event),
-							  parent);
-				}
-			}
-#endif
+	if (f1 != f2)
+		return f1 ? -1 : 1;
 
-			model_check_dummy (dir->model, parent);
-			model_end_loading (dir->model, parent);
-		}
-		else
-		{
-			/* Simply return if we were cancelled */
-			if (error->domain == G_IO_ERROR && error->code == G_IO_ERROR_CANCELLED)
-				return;
+	if (entry1->collate_key == NULL)
+		return entry2->collate_key == NULL ? 0 : -1;
+	else if (entry2->collate_key == NULL)
+		return 1;
 
-			/* Otherwise handle the error appropriately */
-			g_signal_emit (dir->model,
-				       model_signals[ERROR],
-				       0,
-				       GEDIT_FILE_BROWSER_ERROR_LOAD_DIRECTORY,
-				       error->message);
+	return strcmp (entry1->collate_key, entry2->collate_key);
+}
 
-			file_browser_node_unload (dir->model, (FileBrowserNode *)parent, TRUE);
-			g_error_free (error);
-		}
+/* Runs in the loading thread, does everything file_browser_node_set_from_info()
+ * does except the icon lookup. Returns NULL for files which are not shown. */
+static LoadEntry *
+load_entry_new (LoadJob   *job,
+		GFileInfo *info)
+{
+	GFileType type = g_file_info_get_file_type (info);
+	gchar const *name;
+	gchar const *content;
+	LoadEntry *entry;
+
+	/* Skip all non regular, non directory files */
+	if (type != G_FILE_TYPE_REGULAR &&
+	    type != G_FILE_TYPE_DIRECTORY &&
+	    type != G_FILE_TYPE_SYMBOLIC_LINK)
+	{
+		return NULL;
+	}
+
+	name = g_file_info_get_name (info);
+
+	/* Skip '.' and '..' directories */
+	if (type == G_FILE_TYPE_DIRECTORY &&
+	    (strcmp (name, ".") == 0 ||
+	     strcmp (name, "..") == 0))
+	{
+		return NULL;
 	}
-	else if (g_cancellable_is_cancelled (async->cancellable))
+
+	entry = g_slice_new0 (LoadEntry);
+	entry->file = g_file_get_child (job->file, name);
+	entry->info = g_object_ref (info);
+
+	/* The enumerator already queried the display name of local files */
+	if (g_file_has_uri_scheme (entry->file, "file") &&
+	    g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME))
 	{
-		/* Check cancel state manually */
-		g_file_enumerator_close (enumerator, NULL, NULL);
-		g_object_unref (enumerator);
-		async_node_free (async);
+		entry->name = g_strdup (g_file_info_get_display_name (info));
 	}
 	else
 	{
-		model_add_nodes_from_files (dir->model, parent, async->original_children, files);
+		entry->name = gedit_file_browser_utils_file_basename (entry->file);
+	}
+
+	if (entry->name != NULL)
+		entry->collate_key = g_utf8_collate_key_for_filename (entry->name, -1);
+
+	if (g_file_info_get_is_hidden (info) || g_file_info_get_is_backup (info))
+		entry->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_HIDDEN;
 
-		g_list_free (files);
-		next_files_async (enumerator, async);
+	if (type == G_FILE_TYPE_DIRECTORY)
+	{
+		entry->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_DIRECTORY;
 	}
+	else
+	{
+		if (!(content = backup_content_type (info)))
+			content = g_file_info_get_content_type (info);
+
+		if (content_type_is_text (content))
+			entry->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_IS_TEXT;
+
+		entry->matches_binary_pattern = name_matches_binary_patterns (job->binary_pattern_specs,
+									      entry->name);
+	}
+
+	return entry;
 }
 
-static void
-next_files_async (GFileEnumerator *enumerator,
-		  AsyncNode       *async)
+static gboolean
+on_load_batch (LoadBatch *batch)
 {
-	g_file_enumerator_next_files_async (enumerator,
-					    DIRECTORY_LOAD_ITEMS_PER_CALLBACK,
-					    G_PRIORITY_DEFAULT,
-					    async->cancellable,
-					    (GAsyncReadyCallback)model_iterate_next_files_cb,
-					    async);
+	LoadJob *job = g_task_get_task_data (batch->task);
+
+	/* The directory is only valid as long as the load was not cancelled */
+	if (!g_cancellable_is_cancelled (g_task_get_cancellable (batch->task)))
+	{
+		model_add_entries (job->dir->model,
+				   (FileBrowserNode *)job->dir,
+				   batch->entries,
+				   job->binary_patterns_generation);
+	}
+
+	return G_SOURCE_REMOVE;
 }
 
 static void
-model_iterate_children_cb (GFile        *file,
-			   GAsyncResult *result,
-			   AsyncNode    *async)
+load_directory_thread (GTask        *task,
+		       gpointer      source_object,
+		       LoadJob      *job,
+		       GCancellable *cancellable)
 {
-	GError *error = NULL;
 	GFileEnumerator *enumerator;
+	GPtrArray *entries;
+	guint batch_size = DIRECTORY_LOAD_ITEMS_PER_CALLBACK;
+	GFileInfo *info;
+	GError *error = NULL;
 
-	if (g_cancellable_is_cancelled (async->cancellable))
+	enumerator = g_file_enumerate_children (job->file,
+						LOAD_ATTRIBUTE_TYPES,
+						G_FILE_QUERY_INFO_NONE,
+						cancellable,
+						&error);
+
+	if (enumerator == NULL)
 	{
-		async_node_free (async);
+		g_task_return_error (task, error);
 		return;
 	}
 
-	if (!(enumerator = g_file_enumerate_children_finish (file, result, &error)))
+	entries = g_ptr_array_new_with_free_func ((GDestroyNotify)load_entry_free);
+
+	while ((info = g_file_enumerator_next_file (enumerator, cancellable, &error)) != NULL)
+	{
+		LoadEntry *entry = load_entry_new (job, info);
+
+		g_object_unref (info);
+
+		if (entry != NULL)
+			g_ptr_array_add (entries, entry);
+
+		if (entries->len >= batch_size)
+		{
+			LoadBatch *batch = g_slice_new (LoadBatch);
+
+			g_ptr_array_sort (entries, compare_entries);
+
+			batch->task = g_object_ref (task);
+			batch->entries = entries;
+
+			g_main_context_invoke_full (job->context,
+						    G_PRIORITY_DEFAULT,
+						    (GSourceFunc)on_load_batch,
+						    batch,
+						    (GDestroyNotify)load_batch_free);
+
+			entries = g_ptr_array_new_with_free_func ((GDestroyNotify)load_entry_free);
+			batch_size = MIN (batch_size * 2, DIRECTORY_LOAD_MAX_ITEMS_PER_CALLBACK);
+		}
+	}
+
+	g_file_enumerator_close (enumerator, NULL, NULL);
+	g_object_unref (enumerator);
+
+	if (error != NULL)
 	{
-		/* Simply return if we were cancelled or if the dir is not there */
-		FileBrowserNodeDir *dir = async->dir;
+		g_ptr_array_unref (entries);
+		g_task_return_error (task, error);
+		return;
+	}
 
+	/* The last batch is handed over with the result, which is dispatched
+	   after the batches queued before it */
+	g_ptr_array_sort (entries, compare_entries);
+	g_task_return_pointer (task, entries, (GDestroyNotify)g_ptr_array_unref);
+}
+
+static void
+load_directory_ready (GObject      *source_object,
+		      GAsyncResult *result,
+		      gpointer      user_data)
+{
+	GTask *task = G_TASK (result);
+	LoadJob *job = g_task_get_task_data (task);
+	FileBrowserNodeDir *dir = job->dir;
+	FileBrowserNode *parent = (FileBrowserNode *)dir;
+	GPtrArray *entries;
+	GError *error = NULL;
+
+	/* Simply return if we were cancelled, the directory may be gone */
+	if (g_cancellable_is_cancelled (g_task_get_cancellable (task)))
+		return;
+
+	entries = g_task_propagate_pointer (task, &error);
+
+	if (entries == NULL)
+	{
 		/* Otherwise handle the error appropriately */
 		g_signal_emit (dir->model,
 			       model_signals[ERROR],
@@ -2332,14 +2925,41 @@ model_iterate_children_cb (GFile        *file,
 			       GEDIT_FILE_BROWSER_ERROR_LOAD_DIRECTORY,
 			       error->message);
 
-		file_browser_node_unload (dir->model, (FileBrowserNode *)dir, TRUE);
+		file_browser_node_unload (dir->model, parent, TRUE);
 		g_error_free (error);
-		async_node_free (async);
+		return;
 	}
-	else
+
+	model_add_entries (dir->model, parent, entries, job->binary_patterns_generation);
+	g_ptr_array_unref (entries);
+
+	/* We're done loading */
+	g_object_unref (dir->cancellable);
+	dir->cancellable = NULL;
+
+/*
+ * FIXME: This is temporarly, it is a bug in gio:
+ * http://bugzilla.gnome.org/show_bug.cgi?id=565924
+ */
+#ifndef G_OS_WIN32
+	if (g_file_is_native (parent->file) && dir->monitor == NULL)
 	{
-		next_files_async (enumerator, async);
+		dir->monitor = g_file_monitor_directory (parent->file,
+							 G_FILE_MONITOR_NONE,
+							 NULL,
+							 NULL);
+		if (dir->monitor != NULL)
+		{
+			g_signal_connect (dir->monitor,
+					  "changed",
+					  G_CALLBACK (on_directory_monitor_event),
+					  parent);
+		}
 	}
+#endif
+
+	model_check_dummy (dir->model, parent);
+	model_end_loading (dir->model, parent);
 }
 
 static void
@@ -2347,7 +2967,8 @@ model_load_directory (GeditFileBrowserStore *model,
 		      FileBrowserNode       *node)
 {
 	FileBrowserNodeDir *dir;
-	AsyncNode *async;
+	LoadJob *job;
+	GTask *task;
 
 	g_return_if_fail (NODE_IS_DIR (node));
 
@@ -2362,19 +2983,21 @@ model_load_directory (GeditFileBrowserStore *model,
 
 	dir->cancellable = g_cancellable_new ();
 
-	async = g_slice_new (AsyncNode);
-	async->dir = dir;
-	async->cancellable = g_object_ref (dir->cancellable);
-	async->original_children = g_slist_copy (dir->children);
-
-	/* Start loading async */
-	g_file_enumerate_children_async (node->file,
-					 STANDARD_ATTRIBUTE_TYPES,
-					 G_FILE_QUERY_INFO_NONE,
-					 G_PRIORITY_DEFAULT,
-					 async->cancellable,
-					 (GAsyncReadyCallback)model_iterate_children_cb,
-					 async);
+	job = g_slice_new0 (LoadJob);
+	job->dir = dir;
+	job->file = g_object_ref (node->file);
+	job->binary_patterns_generation = model->priv->binary_patterns_generation;
+	job->context = g_main_context_ref_thread_default ();
+
+	if (model->priv->binary_pattern_specs != NULL)
+		job->binary_pattern_specs = g_ptr_array_ref (model->priv->binary_pattern_specs);
+
+	/* Enumerate, classify and sort in a thread, only the nodes are
+	   created and inserted in the main thread */
+	task = g_task_new (NULL, dir->cancellable, load_directory_ready, NULL);
+	g_task_set_task_data (task, job, (GDestroyNotify)load_job_free);
+	g_task_run_in_thread (task, (GTaskThreadFunc)load_directory_thread);
+	g_object_unref (task);
 }
 
 static GList *
@@ -2406,7 +3029,6 @@ model_fill (GeditFileBrowserStore  *model,
 {
 	gboolean free_path = FALSE;
 	GtkTreeIter iter = {0,};
-	GSList *item;
 	FileBrowserNode *child;
 
 	if (node == NULL)
@@ -2439,12 +3061,14 @@ model_fill (GeditFileBrowserStore  *model,
 
 	if (NODE_IS_DIR (node))
 	{
+		GPtrArray *children = FILE_BROWSER_NODE_DIR (node)->children;
+
 		/* Go to the first child */
 		gtk_tree_path_down (*path);
 
-		for (item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
+		for (guint i = 0; i < children->len; ++i)
 		{
-			child = (FileBrowserNode *) (item->data);
+			child = g_ptr_array_index (children, i);
 
 			if (model_node_visibility (model, child))
 			{
@@ -2473,55 +3097,70 @@ set_virtual_root_from_node (GeditFileBrowserStore *model,
 	FileBrowserNode *next = prev->parent;
 	FileBrowserNode *check;
 	FileBrowserNodeDir *dir;
-	GSList *copy;
 	GtkTreePath *empty = NULL;
 
 	/* Free all the nodes below that we don't need in cache */
 	while (prev != model->priv->root)
 	{
 		dir = FILE_BROWSER_NODE_DIR (next);
-		copy = g_slist_copy (dir->children);
 
-		for (GSList *item = copy; item; item = item->next)
+		if (prev == node)
 		{
-			check = (FileBrowserNode *)(item->data);
-
-			if (prev == node)
+			/* Only free the children, keeping this depth in cache */
+			for (guint i = 0; i < dir->children->len; ++i)
 			{
-				/* Only free the children, keeping this depth in cache */
+				check = g_ptr_array_index (dir->children, i);
+
 				if (check != node)
 				{
 					file_browser_node_free_children (model, check);
 					file_browser_node_unload (model, check, FALSE);
 				}
 			}
-			else if (check != prev)
+		}
+		else
+		{
+			/* Only keep the node that is in the chain, detaching
+			   the others in one go before freeing them */
+			GPtrArray *old = dir->children;
+
+			dir->children = g_ptr_array_new ();
+			g_ptr_array_add (dir->children, prev);
+			dir_reindex_children (dir, 0);
+
+			for (guint i = 0; i < old->len; ++i)
 			{
-				/* Only free when the node is not in the chain */
-				dir->children = g_slist_remove (dir->children, check);
-				file_browser_node_free (model, check);
+				check = g_ptr_array_index (old, i);
+
+				if (check != prev)
+					file_browser_node_free (model, check);
 			}
-		}
 
-		if (prev != node)
+			g_ptr_array_unref (old);
 			file_browser_node_unload (model, next, FALSE);
+		}
 
-		g_slist_free (copy);
 		prev = next;
 		next = prev->parent;
 	}
 
 	/* Free all the nodes up that we don't need in cache */
-	for (GSList *item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
+	dir = FILE_BROWSER_NODE_DIR (node);
+
+	for (guint i = 0; i < dir->children->len; ++i)
 	{
-		check = (FileBrowserNode *)(item->data);
+		check = g_ptr_array_index (dir->children, i);
 
 		if (NODE_IS_DIR (check))
 		{
-			for (copy = FILE_BROWSER_NODE_DIR (check)->children; copy; copy = copy->next)
+			GPtrArray *children = FILE_BROWSER_NODE_DIR (check)->children;
+
+			for (guint j = 0; j < children->len; ++j)
 			{
-				file_browser_node_free_children (model, (FileBrowserNode*) (copy->data));
-				file_browser_node_unload (model, (FileBrowserNode*) (copy->data), FALSE);
+				FileBrowserNode *child = g_ptr_array_index (children, j);
+
+				file_browser_node_free_children (model, child);
+				file_browser_node_unload (model, child, FALSE);
 			}
 		}
 		else if (NODE_IS_DUMMY (check))
@@ -2532,6 +3171,7 @@ set_virtual_root_from_node (GeditFileBrowserStore *model,
 
 	/* Now finally, set the virtual root, and load it up! */
 	model->priv->virtual_root = node;
+	model_invalidate_visible_trees (model);
 
 	/* Notify that the virtual-root has changed before loading up new nodes so that the
 	   "root_changed" signal can be emitted before any "inserted" signals */
@@ -2570,48 +3210,22 @@ set_virtual_root_from_file (GeditFileBrowserStore *model,
 	set_virtual_root_from_node (model, parent);
 }
 
-static FileBrowserNode *
-model_find_node_children (GeditFileBrowserStore *model,
-			  FileBrowserNode       *parent,
-			  GFile                 *file)
-{
-	FileBrowserNodeDir *dir;
-	FileBrowserNode *child;
-	FileBrowserNode *result;
-
-	if (!NODE_IS_DIR (parent))
-		return NULL;
-
-	dir = FILE_BROWSER_NODE_DIR (parent);
-
-	for (GSList *children = dir->children; children; children = children->next)
-	{
-		child = (FileBrowserNode *)(children->data);
-
-		result = model_find_node (model, child, file);
-
-		if (result)
-			return result;
-	}
-
-	return NULL;
-}
-
 static FileBrowserNode *
 model_find_node (GeditFileBrowserStore *model,
 		 FileBrowserNode       *node,
 		 GFile                 *file)
 {
+	FileBrowserNode *result;
+
 	if (node == NULL)
 		node = model->priv->root;
 
-	if (node->file && g_file_equal (node->file, file))
-		return node;
+	result = g_hash_table_lookup (model->priv->file_index, file);
 
-	if (NODE_IS_DIR (node) && g_file_has_prefix (file, node->file))
-		return model_find_node_children (model, node, file);
+	if (result == NULL || (result != node && !node_has_parent (result, node)))
+		return NULL;
 
-	return NULL;
+	return result;
 }
 
 static GQuark
@@ -2687,6 +3301,7 @@ handle_root_error (GeditFileBrowserStore *model,
 	/* Set the virtual root to the root */
 	root = model->priv->root;
 	model->priv->virtual_root = root;
+	model_invalidate_visible_trees (model);
 
 	/* Set the root to be loaded */
 	root->flags |= GEDIT_FILE_BROWSER_STORE_FLAG_LOADED;
@@ -3041,6 +3656,7 @@ gedit_file_browser_store_set_root_and_virtual_root (GeditFileBrowserStore *model
 
 	model->priv->root = NULL;
 	model->priv->virtual_root = NULL;
+	model_invalidate_visible_trees (model);
 
 	if (root != NULL)
 	{
@@ -3123,11 +3739,13 @@ _gedit_file_browser_store_iter_collapsed (GeditFileBrowserStore *model,
 
 	if (NODE_IS_DIR (node) && NODE_LOADED (node))
 	{
+		GPtrArray *children = FILE_BROWSER_NODE_DIR (node)->children;
+
 		/* Unload children of the children, keeping 1 depth in cache */
 
-		for (GSList *item = FILE_BROWSER_NODE_DIR (node)->children; item; item = item->next)
+		for (guint i = 0; i < children->len; ++i)
 		{
-			node = (FileBrowserNode *)(item->data);
+			node = g_ptr_array_index (children, i);
 
 			if (NODE_IS_DIR (node) && NODE_LOADED (node))
 			{
@@ -3138,6 +3756,23 @@ _gedit_file_browser_store_iter_collapsed (GeditFileBrowserStore *model,
 	}
 }
 
+/* The number of monitor events received, and of those which replaced
+ * an event still pending for the same file.
+ */
+void
+_gedit_file_browser_store_get_monitor_stats (GeditFileBrowserStore *model,
+					     guint                 *received,
+					     guint                 *merged)
+{
+	g_return_if_fail (GEDIT_IS_FILE_BROWSER_STORE (model));
+
+	if (received != NULL)
+		*received = model->priv->monitor_events_received;
+
+	if (merged != NULL)
+		*merged = model->priv->monitor_events_merged;
+}
+
 GeditFileBrowserStoreFilterMode
 gedit_file_browser_store_get_filter_mode (GeditFileBrowserStore *model)
 {
@@ -3190,6 +3825,7 @@ gedit_file_browser_store_set_binary_patterns (GeditFileBrowserStore  *model,
 	}
 
 	model->priv->binary_patterns = g_strdupv ((gchar **)binary_patterns);
+	++model->priv->binary_patterns_generation;
 
 	if (binary_patterns == NULL)
 	{
@@ -3239,8 +3875,9 @@ gedit_file_browser_store_refresh (GeditFileBrowserStore *model)
 }
 
 static void
-reparent_node (FileBrowserNode *node,
-	       gboolean         reparent)
+reparent_node (GeditFileBrowserStore *model,
+	       FileBrowserNode       *node,
+	       gboolean               reparent)
 {
 	if (!node->file)
 		return;
@@ -3250,9 +3887,11 @@ reparent_node (FileBrowserNode *node,
 		GFile *parent = node->parent->file;
 		gchar *base = g_file_get_basename (node->file);
 
+		model_unindex_node (model, node);
 		g_object_unref (node->file);
 
 		node->file = g_file_get_child (parent, base);
+		model_index_node (model, node);
 		g_free (base);
 	}
 
@@ -3260,8 +3899,8 @@ reparent_node (FileBrowserNode *node,
 	{
 		FileBrowserNodeDir *dir = FILE_BROWSER_NODE_DIR (node);
 
-		for (GSList *child = dir->children; child; child = child->next)
-			reparent_node ((FileBrowserNode *)child->data, TRUE);
+		for (guint i = 0; i < dir->children->len; ++i)
+			reparent_node (model, g_ptr_array_index (dir->children, i), TRUE);
 	}
 }
 
@@ -3298,14 +3937,18 @@ gedit_file_browser_store_rename (GeditFileBrowserStore  *model,
 
 	if (g_file_move (node->file, file, G_FILE_COPY_NONE, NULL, NULL, NULL, &err))
 	{
+		model_unindex_node (model, node);
+
 		previous = node->file;
 		node->file = file;
 
+		model_index_node (model, node);
+
 		/* This makes sure the actual info for the node is requeried */
 		file_browser_node_set_name (node);
 		file_browser_node_set_from_info (model, node, NULL, TRUE);
 
-		reparent_node (node, FALSE);
+		reparent_node (model, node, FALSE);
 
 		if (model_node_visibility (model, node))
 		{
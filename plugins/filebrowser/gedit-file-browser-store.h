@@ -150,6 +150,9 @@ void                             _gedit_file_browser_store_iter_expanded
                                                                                           GtkTreeIter                      *iter);
 void                             _gedit_file_browser_store_iter_collapsed                (GeditFileBrowserStore            *model,
                                                                                           GtkTreeIter                      *iter);
+void                             _gedit_file_browser_store_get_monitor_stats             (GeditFileBrowserStore            *model,
+                                                                                          guint                            *received,
+                                                                                          guint                            *merged);
 GeditFileBrowserStoreFilterMode  gedit_file_browser_store_get_filter_mode                (GeditFileBrowserStore            *model);
 void                             gedit_file_browser_store_set_filter_mode                (GeditFileBrowserStore            *model,
                                                                                           GeditFileBrowserStoreFilterMode   mode);
@@ -75,6 +75,7 @@ enum
 	CONFIRM_DELETE,
 	CONFIRM_NO_TRASH,
 	OPEN_IN_TERMINAL,
+	SEARCH_IN_FILES,
 	SET_ACTIVE_ROOT,
 	NUM_SIGNALS
 };
@@ -262,6 +263,9 @@ static void change_show_match_filename         (GSimpleAction          *action,
 static void open_in_terminal_activated         (GSimpleAction          *action,
                                                 GVariant               *parameter,
                                                 gpointer                user_data);
+static void search_in_files_activated          (GSimpleAction          *action,
+                                                GVariant               *parameter,
+                                                gpointer                user_data);
 static void set_active_root_activated          (GSimpleAction          *action,
                                                 GVariant               *parameter,
                                                 gpointer                user_data);
@@ -517,6 +521,14 @@ gedit_file_browser_widget_class_init (GeditFileBrowserWidgetClass *klass)
 	                  NULL, NULL, NULL,
 	                  G_TYPE_NONE, 1, G_TYPE_FILE);
 
+	signals[SEARCH_IN_FILES] =
+	    g_signal_new ("search-in-files",
+	                  G_OBJECT_CLASS_TYPE (object_class),
+	                  G_SIGNAL_RUN_LAST,
+	                  G_STRUCT_OFFSET (GeditFileBrowserWidgetClass, search_in_files),
+	                  NULL, NULL, NULL,
+	                  G_TYPE_NONE, 1, G_TYPE_FILE);
+
 	signals[SET_ACTIVE_ROOT] =
 	    g_signal_new ("set-active-root",
 	                  G_OBJECT_CLASS_TYPE (object_class),
@@ -913,6 +925,7 @@ static GActionEntry browser_entries[] = {
 	{ "refresh_view", refresh_view_activated },
 	{ "view_folder", view_folder_activated },
 	{ "open_in_terminal", open_in_terminal_activated },
+	{ "search_in_files", search_in_files_activated },
 	{ "show_hidden", NULL, NULL, "false", change_show_hidden_state },
 	{ "show_binary", NULL, NULL, "false", change_show_binary_state },
 	{ "show_match_filename", NULL, NULL, "false", change_show_match_filename },
@@ -3133,6 +3146,29 @@ open_in_terminal_activated (GSimpleAction *action,
 	g_object_unref (file);
 }
 
+static void
+search_in_files_activated (GSimpleAction *action,
+                           GVariant      *parameter,
+                           gpointer       user_data)
+{
+	GeditFileBrowserWidget *widget = GEDIT_FILE_BROWSER_WIDGET (user_data);
+	GtkTreeIter iter;
+	GFile *file;
+
+	/* The selected directory, or the virtual root */
+	if (!gedit_file_browser_widget_get_selected_directory (widget, &iter))
+		return;
+
+	gtk_tree_model_get (GTK_TREE_MODEL (widget->priv->file_store),
+	                    &iter,
+	                    GEDIT_FILE_BROWSER_STORE_COLUMN_LOCATION, &file,
+	                    -1);
+
+	g_signal_emit (widget, signals[SEARCH_IN_FILES], 0, file);
+
+	g_object_unref (file);
+}
+
 static void
 set_active_root_activated (GSimpleAction *action,
                            GVariant      *parameter,
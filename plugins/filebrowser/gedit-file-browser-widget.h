@@ -70,6 +70,8 @@ struct _GeditFileBrowserWidgetClass
 					 GList                  *list);
 	void (* open_in_terminal)       (GeditFileBrowserWidget *widget,
 	                                 GFile                  *location);
+	void (* search_in_files)        (GeditFileBrowserWidget *widget,
+	                                 GFile                  *location);
 	void (* set_active_root)        (GeditFileBrowserWidget *widget);
 };
 
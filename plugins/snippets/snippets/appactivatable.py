@@ -46,7 +46,9 @@ class AppActivatable(GObject.Object, Gedit.AppActivatable):
         else:
             snippetsdir = os.path.join(GLib.get_user_config_dir(), 'gedit/snippets')
 
-        library.set_dirs(snippetsdir, self.system_dirs())
+        cachedir = os.path.join(GLib.get_user_cache_dir(), 'gedit/snippets')
+
+        library.set_dirs(snippetsdir, self.system_dirs(), cachedir)
 
         self.css = Gtk.CssProvider()
         self.css.load_from_data("""
@@ -947,14 +947,19 @@ class Document(GObject.Object, Gedit.ViewActivatable, Signals):
         if not self.view.get_editable():
             return False
 
+        snippet = proposal.snippet()
+
+        if snippet is None:
+            return False
+
         buf = self.view.get_buffer()
         bounds = buf.get_selection_bounds()
 
         if bounds:
-            self.apply_snippet(proposal.snippet(), None, None)
+            self.apply_snippet(snippet, None, None)
         else:
             (word, start, end) = self.get_tab_tag(buf, piter)
-            self.apply_snippet(proposal.snippet(), start, end)
+            self.apply_snippet(snippet, start, end)
 
         return True
 
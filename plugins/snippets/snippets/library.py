@@ -19,6 +19,9 @@ import os
 import weakref
 import sys
 import re
+import bisect
+import hashlib
+import pickle
 
 from gi.repository import Gdk, Gtk
 
@@ -270,6 +273,10 @@ class LanguageContainer:
         self.language = language
         self.snippets = []
         self.snippets_by_prop = {'tag': {}, 'accelerator': {}, 'drop-targets': {}}
+
+        # The keys of snippets_by_prop['tag'], sorted to find the tags
+        # starting with a prefix
+        self.sorted_tags = []
         self.accel_group = Gtk.AccelGroup()
         self._refs = 0
 
@@ -298,6 +305,9 @@ class LanguageContainer:
             else:
                 snippets[val] = [snippet]
 
+                if prop == 'tag':
+                    bisect.insort(self.sorted_tags, val)
+
     def _remove_prop(self, snippet, prop, value=0):
         if value == 0:
             value = snippet[prop]
@@ -322,6 +332,12 @@ class LanguageContainer:
             except:
                 True
 
+            if prop == 'tag' and val in snippets and not snippets[val]:
+                del snippets[val]
+
+                i = bisect.bisect_left(self.sorted_tags, val)
+                del self.sorted_tags[i]
+
     def append(self, snippet):
         self.snippets.append(snippet)
 
@@ -371,6 +387,18 @@ class LanguageContainer:
             else:
                 return []
 
+    def from_tag_prefix(self, prefix):
+        snippets = self.snippets_by_prop['tag']
+        result = []
+
+        i = bisect.bisect_left(self.sorted_tags, prefix)
+
+        while i < len(self.sorted_tags) and self.sorted_tags[i].startswith(prefix):
+            result += snippets[self.sorted_tags[i]]
+            i += 1
+
+        return result
+
     def ref(self):
         self._refs += 1
 
@@ -399,14 +427,14 @@ class SnippetsSystemFile:
         if not self.need_id or element.attrib.get('id'):
             self.loading_elements.append(element)
 
-    def set_language(self, element):
-        self.language = element.attrib.get('language')
+    def set_language(self, language):
+        self.language = language
 
         if self.language:
             self.language = self.language.lower()
 
     def _set_root(self, element):
-        self.set_language(element)
+        self.set_language(element.attrib.get('language'))
 
     def _preprocess_element(self, element):
         if not self.loaded:
@@ -416,6 +444,7 @@ class SnippetsSystemFile:
                 return False
             else:
                 self._set_root(element)
+                self.loading_root = element
                 self.loaded = True
         elif element.tag != 'snippet' and not self.insnippet:
             self.load_error("Element should be `snippet' instead of `%s'" \
@@ -430,6 +459,8 @@ class SnippetsSystemFile:
         if element.tag == 'snippet':
             self._add_snippet(element)
             self.insnippet = False
+        elif element is self.loading_root:
+            self.loading_complete = True
 
         return True
 
@@ -481,6 +512,15 @@ class SnippetsSystemFile:
 
         f.close()
 
+    def _load_root(self, root):
+        # The tree comes from the cache, it was checked when it was parsed
+        self._set_root(root)
+        self.loaded = True
+
+        for element in root:
+            if element.tag == 'snippet':
+                self._add_snippet(element)
+
     def load(self):
         if not self.ok:
             return
@@ -492,15 +532,32 @@ class SnippetsSystemFile:
         self.ok = False
         self.loading_elements = []
 
-        for element in self.parse_xml():
-            if element[1]:
-                if not self._preprocess_element(element[0]):
-                    del self.loading_elements[:]
-                    return
-            else:
-                if not self._process_element(element[0]):
-                    del self.loading_elements[:]
-                    return
+        cache = Library().cache
+        root = cache.get_root(self.path)
+
+        if root is not None:
+            self._load_root(root)
+        else:
+            stat = cache.stat(self.path)
+            self.loading_root = None
+            self.loading_complete = False
+
+            for element in self.parse_xml():
+                if element[1]:
+                    if not self._preprocess_element(element[0]):
+                        del self.loading_elements[:]
+                        return
+                else:
+                    if not self._process_element(element[0]):
+                        del self.loading_elements[:]
+                        return
+
+            # Stored before the snippets are added, which completes the
+            # nodes of the user files
+            if self.loading_complete:
+                cache.set_root(self.path, stat, self.language, self.loading_root)
+
+            self.loading_root = None
 
         for element in self.loading_elements:
             Library().add_snippet(self, element)
@@ -514,16 +571,28 @@ class SnippetsSystemFile:
     # It returns the name of the language
     def ensure_language(self):
         if not self.loaded:
+            cache = Library().cache
+            entry = cache.lookup(self.path)
+
+            if entry is not None:
+                self.set_language(entry.language)
+                self.ok = True
+                return
+
+            stat = cache.stat(self.path)
             self.ok = False
 
             for element in self.parse_xml(256):
                 if element[1]:
                     if element[0].tag == 'snippets':
-                        self.set_language(element[0])
+                        self.set_language(element[0].attrib.get('language'))
                         self.ok = True
 
                     break
 
+            if self.ok:
+                cache.set_language(self.path, stat, self.language)
+
     def unload(self):
         helper.snippets_debug("Unloading library (" + str(self.language) + "): " + \
                 self.path)
@@ -565,8 +634,8 @@ class SnippetsUserFile(SnippetsSystemFile):
 
         return Library().add_snippet(self, element)
 
-    def set_language(self, element):
-        SnippetsSystemFile.set_language(self, element)
+    def set_language(self, language):
+        SnippetsSystemFile.set_language(self, language)
 
         filename = os.path.basename(self.path).lower()
 
@@ -624,6 +693,9 @@ class SnippetsUserFile(SnippetsSystemFile):
         try:
             helper.write_xml(self.root, self.path, ('text', 'accelerator'))
             self.tainted = False
+
+            cache = Library().cache
+            cache.set_root(self.path, cache.stat(self.path), self.language, self.root)
         except IOError:
             # Couldn't save, what to do
             sys.stderr.write("Could not save user snippets file to " + \
@@ -633,6 +705,153 @@ class SnippetsUserFile(SnippetsSystemFile):
         SnippetsSystemFile.unload(self)
         self.root = None
 
+class SnippetsCacheEntry:
+    def __init__(self, stat, language, has_root):
+        self.stat = stat
+        self.language = language
+        self.has_root = has_root
+
+# Keeps the language and the parsed tree of the snippets files, so that they
+# do not need to be parsed again while they are not modified. The index of
+# the languages is read on activation, the tree of a file only when its
+# language is first used.
+class SnippetsCache:
+    VERSION = 1
+
+    def __init__(self, path=None):
+        self.path = path
+        self.entries = {}
+        self.seen = set()
+        self.tainted = False
+
+        self._load_index()
+
+    def _index_path(self):
+        return os.path.join(self.path, 'index')
+
+    def _root_path(self, path):
+        name = hashlib.sha1(os.fsencode(path)).hexdigest()
+        return os.path.join(self.path, name)
+
+    def _load_index(self):
+        if not self.path:
+            return
+
+        try:
+            with open(self._index_path(), 'rb') as f:
+                version, entries = pickle.load(f)
+        except Exception:
+            return
+
+        if version != SnippetsCache.VERSION:
+            return
+
+        # Stored as tuples, so the index does not depend on this module
+        for path, entry in entries.items():
+            self.entries[path] = SnippetsCacheEntry(*entry)
+
+    def _write(self, path, data):
+        if not os.path.isdir(self.path):
+            os.makedirs(self.path, 0o755)
+
+        # Written aside first, an interrupted write must not leave a
+        # truncated file
+        tmp = path + '.tmp'
+
+        with open(tmp, 'wb') as f:
+            f.write(data)
+
+        os.replace(tmp, path)
+
+    def stat(self, path):
+        try:
+            st = os.stat(path)
+        except OSError:
+            return None
+
+        return (st.st_mtime_ns, st.st_size)
+
+    # Get the entry of a file if it was not modified since it was cached
+    def lookup(self, path):
+        self.seen.add(path)
+
+        if not path in self.entries:
+            return None
+
+        entry = self.entries[path]
+
+        if entry.stat is None or entry.stat != self.stat(path):
+            return None
+
+        return entry
+
+    def set_language(self, path, stat, language):
+        if not self.path or stat is None:
+            return
+
+        self.seen.add(path)
+        self.entries[path] = SnippetsCacheEntry(stat, language, False)
+        self.tainted = True
+
+    def get_root(self, path):
+        entry = self.lookup(path)
+
+        if entry is None or not entry.has_root:
+            return None
+
+        try:
+            with open(self._root_path(path), 'rb') as f:
+                return pickle.load(f)
+        except Exception:
+            del self.entries[path]
+            self.tainted = True
+
+            return None
+
+    def set_root(self, path, stat, language, root):
+        if not self.path or stat is None:
+            return
+
+        try:
+            self._write(self._root_path(path), pickle.dumps(root))
+        except OSError:
+            helper.snippets_debug('Could not cache ' + path)
+            return
+
+        self.seen.add(path)
+        self.entries[path] = SnippetsCacheEntry(stat, language, True)
+        self.tainted = True
+
+    def save(self):
+        if not self.path or not self.tainted:
+            return
+
+        # Forget the files which are gone
+        for path in list(self.entries):
+            if path in self.seen:
+                continue
+
+            if self.entries[path].has_root:
+                try:
+                    os.unlink(self._root_path(path))
+                except OSError:
+                    pass
+
+            del self.entries[path]
+
+        entries = {}
+
+        for path, entry in self.entries.items():
+            entries[path] = (entry.stat, entry.language, entry.has_root)
+
+        try:
+            self._write(self._index_path(), \
+                    pickle.dumps((SnippetsCache.VERSION, entries)))
+            self.tainted = False
+        except OSError:
+            sys.stderr.write("Could not save the snippets cache to " + \
+                    self.path + "\n")
+
 class Singleton(object):
     _instance = None
 
@@ -649,10 +868,12 @@ class Library(Singleton):
         self._accelerator_activated_cb = []
         self.loaded = False
         self.check_buffer = Gtk.TextBuffer()
+        self.cache = SnippetsCache()
 
-    def set_dirs(self, userdir, systemdirs):
+    def set_dirs(self, userdir, systemdirs, cachedir=None):
         self.userdir = userdir
         self.systemdirs = systemdirs
+        self.cache = SnippetsCache(cachedir)
 
         self.libraries = {}
         self.containers = {}
@@ -917,6 +1138,8 @@ class Library(Singleton):
                 for library in self.libraries[lang]:
                     library.ensure()
 
+        self.cache.save()
+
     def ensure_files(self):
         if self.loaded:
             return
@@ -930,6 +1153,7 @@ class Library(Singleton):
                     self.add_system_library)
 
         self.loaded = True
+        self.cache.save()
 
     def valid_accelerator(self, keyval, mod):
         mod &= Gtk.accelerator_get_default_mod_mask()
@@ -974,6 +1198,18 @@ class Library(Singleton):
 
         return list(self.containers[language].snippets)
 
+    # Get snippets for which the tag starts with a given prefix
+    def from_tag_prefix(self, prefix, language=None):
+        self.ensure_files()
+        language = self.normalize_language(language)
+
+        if not language in self.libraries:
+            return []
+
+        self.ensure(language)
+
+        return self.containers[language].from_tag_prefix(prefix)
+
     # Get snippets for a given accelerator
     def from_accelerator(self, accelerator, language=None):
         return self._from_prop('accelerator', accelerator, language)